@@ -1,8 +1,8 @@
 #version 430
 
-in vec3 v2fColor;
-in vec3 v2fNormal;
-in vec3 vertPosition;
+layout( location = 0 ) in vec3 v2fColor;
+layout( location = 1 ) in vec3 v2fNormal;
+layout( location = 2 ) in vec3 vertPosition;
 //in vec3 vertPosition;
 layout( location = 2 ) uniform vec3 landMassLight; 
 layout( location = 3 ) uniform vec3 uLightDiffuse; 
@@ -21,7 +21,7 @@ void main()
    // oColor = v2fColor;
     float shininess = 32.0;
     float lightPower = 2.0;
-    vec3 color;  
+    vec3 color = vec3(0.0);
     vec3 landmassColour;
 
     vec3 normal = normalize(v2fNormal);
@@ -4,14 +4,19 @@ layout( location = 0) in vec3 iPosition;
 layout( location = 1) in vec3 iColor;
 layout( location = 2 ) in vec3 iNormal;
 
-layout( location = 0) uniform mat4 uProjection;
-layout( location = 1) uniform mat4 uCamera2World;
+// per-view matrices, written by ViewUniformBuffer::upload(). Without a
+// geometry shader, only the first view is used.
+layout( std140, row_major, binding = 0 ) uniform ViewBlock
+{
+    mat4 uProjCameraWorld[2];
+};
+
 layout( location = 5) uniform mat4 uModel2World;
 layout( location = 6 ) uniform mat3 uNormalMatrix;
 
-out vec3 v2fColor; 
-out vec3 v2fNormal;
-out vec3 vertPosition;
+layout( location = 0 ) out vec3 v2fColor;
+layout( location = 1 ) out vec3 v2fNormal;
+layout( location = 2 ) out vec3 vertPosition;
 
 void main()
 {
@@ -20,6 +25,6 @@ void main()
 
     // Convert to 3D vector by taking the xyz components
     vertPosition = homogenousCoords.xyz;
-    gl_Position = uProjection * uCamera2World * uModel2World * vec4(iPosition, 1.0);
+    gl_Position = uProjCameraWorld[0] * homogenousCoords;
     v2fNormal = (uNormalMatrix * iNormal);
 }
@@ -0,0 +1,46 @@
+#version 430
+
+layout( location = 0) in vec3 iPosition; 
+layout( location = 1) in vec3 iColor;
+layout( location = 2 ) in vec3 iNormal;
+// index of the object being drawn (the draw command's baseInstance)
+layout( location = 4 ) in uint iObjectIndex;
+
+struct ObjectData
+{
+    mat4 model2World;
+    mat4 normalMatrix;
+};
+
+// per-object transforms, written by DrawList::upload()
+layout( std430, row_major, binding = 0 ) readonly buffer ObjectBlock
+{
+    ObjectData uObjects[];
+};
+
+// per-view matrices, written by ViewUniformBuffer::upload(). Without a
+// geometry shader, only the first view is used.
+layout( std140, row_major, binding = 0 ) uniform ViewBlock
+{
+    mat4 uProjCameraWorld[2];
+};
+
+// the depth pre-pass (depthOnly.frag) must produce the same depth
+invariant gl_Position;
+
+layout( location = 0 ) out vec3 v2fColor;
+layout( location = 1 ) out vec3 v2fNormal;
+layout( location = 2 ) out vec3 vertPosition;
+
+void main()
+{
+    ObjectData obj = uObjects[iObjectIndex];
+
+    v2fColor = iColor;
+    vec4 homogenousCoords = obj.model2World * vec4(iPosition, 1.0);
+
+    // Convert to 3D vector by taking the xyz components
+    vertPosition = homogenousCoords.xyz;
+    gl_Position = uProjCameraWorld[0] * homogenousCoords;
+    v2fNormal = mat3(obj.normalMatrix) * iNormal;
+}
@@ -0,0 +1,44 @@
+#version 430
+
+layout( location = 0) in vec3 iPosition;
+layout( location = 1) in vec3 iColor;
+layout( location = 2 ) in vec3 iNormal;
+
+struct InstanceData
+{
+    mat4 model2World;
+    mat4 normalMatrix;
+};
+
+// per-instance transforms, written by InstanceBuffer::assign()
+layout( std430, row_major, binding = 3 ) readonly buffer InstanceBlock
+{
+    InstanceData uInstances[];
+};
+
+// per-view matrices, written by ViewUniformBuffer::upload(). Without a
+// geometry shader, only the first view is used.
+layout( std140, row_major, binding = 0 ) uniform ViewBlock
+{
+    mat4 uProjCameraWorld[2];
+};
+
+// the depth pre-pass (depthOnly.frag) must produce the same depth
+invariant gl_Position;
+
+layout( location = 0 ) out vec3 v2fColor;
+layout( location = 1 ) out vec3 v2fNormal;
+layout( location = 2 ) out vec3 vertPosition;
+
+void main()
+{
+    InstanceData inst = uInstances[gl_InstanceID];
+
+    v2fColor = iColor;
+    vec4 homogenousCoords = inst.model2World * vec4(iPosition, 1.0);
+
+    // Convert to 3D vector by taking the xyz components
+    vertPosition = homogenousCoords.xyz;
+    gl_Position = uProjCameraWorld[0] * homogenousCoords;
+    v2fNormal = mat3(inst.normalMatrix) * iNormal;
+}
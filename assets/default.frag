@@ -1,7 +1,7 @@
 #version 430
 
-in vec2 v2fTexCoord;
-in vec3 v2fNormal;
+layout( location = 0 ) in vec2 v2fTexCoord;
+layout( location = 1 ) in vec3 v2fNormal;
 
 layout( location = 2 ) uniform vec3 uLightDir; 
 layout( location = 3 ) uniform vec3 uLightDiffuse; 
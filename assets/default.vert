@@ -4,17 +4,29 @@ layout( location = 0) in vec3 iPosition;
 layout( location = 3 ) in vec2 iTexCoord;
 layout( location = 2 ) in vec3 iNormal;
 
-layout( location = 0) uniform mat4 uProjCameraWorld;
+// per-view matrices, written by ViewUniformBuffer::upload(). Without a
+// geometry shader, only the first view is used.
+layout( std140, row_major, binding = 0 ) uniform ViewBlock
+{
+    mat4 uProjCameraWorld[2];
+};
+
 layout( location = 1 ) uniform mat3 uNormalMatrix;
+// only moves the land mass to the render origin (see RenderOrigin)
+layout( location = 5 ) uniform mat4 uModel2World;
 
 
-out vec2 v2fTexCoord;
-out vec3 v2fNormal;
+layout( location = 0 ) out vec2 v2fTexCoord;
+layout( location = 1 ) out vec3 v2fNormal;
+// world space position, for the multi-view geometry shader
+layout( location = 2 ) out vec3 v2fPosition;
 
 void main()
 {
     v2fTexCoord = iTexCoord;
-    gl_Position = uProjCameraWorld * vec4(iPosition, 1.0);
+    vec4 worldPosition = uModel2World * vec4(iPosition, 1.0);
+    v2fPosition = worldPosition.xyz;
+    gl_Position = uProjCameraWorld[0] * worldPosition;
     v2fNormal = normalize(uNormalMatrix * iNormal);
 
 }
@@ -0,0 +1,10 @@
+#version 430
+
+// Depth pre-pass: pairs with the colorShader*.vert vertex shaders (and
+// multiview.geom), which declare gl_Position invariant, so the depth written
+// here matches the later pass with colorShader.frag exactly. No color is
+// written; the depth test and write are all this pass is for.
+
+void main()
+{
+}
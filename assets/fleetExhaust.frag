@@ -0,0 +1,15 @@
+#version 430
+
+layout( location = 0 ) in vec4 v2fColor;
+
+layout( location = 0 ) out vec4 oColor;
+
+void main()
+{
+    // round, soft-edged points
+    float r = length( gl_PointCoord * 2.0 - 1.0 );
+    if( r > 1.0 )
+        discard;
+
+    oColor = vec4( v2fColor.rgb, v2fColor.a * (1.0 - r) );
+}
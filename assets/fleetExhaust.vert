@@ -0,0 +1,57 @@
+#version 430
+
+// Exhaust of the rocket fleet: one point per particle, drawn with
+// glDrawArraysInstanced(GL_POINTS, 0, particlesPerRocket, rocketCount). The
+// particles have no state of their own; their age and direction are derived
+// from the particle and rocket indices and the time, so the emitters cost
+// nothing on the CPU.
+
+struct InstanceData
+{
+    mat4 model2World;
+    mat4 normalMatrix;
+};
+
+// per-rocket transforms, written by InstanceBuffer::assign_rigid()
+layout( std430, row_major, binding = 3 ) readonly buffer InstanceBlock
+{
+    InstanceData uInstances[];
+};
+
+layout( std140, row_major, binding = 0 ) uniform ViewBlock
+{
+    mat4 uProjCameraWorld[2];
+};
+
+layout( location = 0 ) uniform float uTime;
+// point size in pixels of a particle of size 1 at distance 1
+layout( location = 1 ) uniform float uPointScale;
+layout( location = 2 ) uniform uint uParticlesPerRocket;
+
+layout( location = 0 ) out vec4 v2fColor;
+
+// integer hash, mapped to [0,1]
+float hash( uint n )
+{
+    n = (n << 13u) ^ n;
+    n = n * (n * n * 15731u + 789221u) + 1376312589u;
+    return float(n & 0x7fffffffu) / float(0x7fffffff);
+}
+
+void main()
+{
+    uint id = uint(gl_InstanceID) * uParticlesPerRocket + uint(gl_VertexID);
+
+    // each particle lives for 1/1.5 seconds, then respawns at the nozzle
+    float age = fract( uTime * 1.5 + hash( id ) );
+
+    // spread out below the rocket (the model points along +y)
+    vec3 spread = vec3( hash( 3u*id + 1u ) - 0.5, -1.0, hash( 3u*id + 2u ) - 0.5 );
+    vec3 local = vec3( 0.0, -0.1, 0.0 ) + spread * vec3( 0.8, 2.5, 0.8 ) * age;
+
+    gl_Position = uProjCameraWorld[0] * (uInstances[gl_InstanceID].model2World * vec4( local, 1.0 ));
+    gl_PointSize = mix( 0.15, 0.5, age ) * uPointScale / max( gl_Position.w, 0.1 );
+
+    // hot at the nozzle, fading to smoke
+    v2fColor = vec4( mix( vec3( 1.0, 0.75, 0.3 ), vec3( 0.3 ), age ), 1.0 - age );
+}
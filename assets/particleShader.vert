@@ -7,8 +7,18 @@ layout( location = 2 ) in vec3 iNormal;
 
 layout( location = 0) uniform mat4 uProjection;
 layout( location = 1) uniform mat4 uCamera2World;
-layout( location = 5) uniform mat4 uModel2World;
-layout( location = 6 ) uniform mat3 uNormalMatrix;
+
+struct InstanceData
+{
+    mat4 model2World;
+    mat4 normalMatrix;
+};
+
+// per-particle transforms, written by InstanceBuffer::assign_rigid()
+layout( std430, row_major, binding = 3 ) readonly buffer InstanceBlock
+{
+    InstanceData uInstances[];
+};
 
 
 // move particle by this much
@@ -22,8 +32,10 @@ void main()
     // scale particule quad
     //float scale = 10.f;
     v2fColor = iColor;
-    gl_Position = uProjection * uCamera2World * uModel2World * vec4(iPosition, 1.0);;
-    v2fNormal = normalize(uNormalMatrix * iNormal);
+    InstanceData inst = uInstances[gl_InstanceID];
+
+    gl_Position = uProjection * uCamera2World * inst.model2World * vec4(iPosition, 1.0);
+    v2fNormal = normalize(mat3(inst.normalMatrix) * iNormal);
 
 }
 
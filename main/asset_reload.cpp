@@ -0,0 +1,251 @@
+#include "asset_reload.hpp"
+
+#include <utility>
+#include <exception>
+
+#include <cstdio>
+
+#include "loadobj.hpp"
+
+#include "../support/error.hpp"
+
+namespace
+{
+	std::string read_text_( char const* aPath )
+	{
+		std::FILE* fin = std::fopen( aPath, "rb" );
+		if( !fin )
+			throw Error( "unable to open '%s'", aPath );
+
+		std::string ret;
+		char buffer[4096];
+		while( auto const n = std::fread( buffer, 1, sizeof(buffer), fin ) )
+			ret.append( buffer, n );
+
+		bool const failed = 0 != std::ferror( fin );
+		std::fclose( fin );
+
+		if( failed )
+			throw Error( "error while reading '%s'", aPath );
+
+		return ret;
+	}
+}
+
+AssetReloader::AssetReloader( std::string aDirectory )
+{
+	mWatcher = std::make_unique<FileWatcher>( std::move(aDirectory), [this] (std::string const& aPath) {
+		load_( aPath );
+	} );
+}
+
+AssetReloader::~AssetReloader()
+{
+	// stop the watcher thread before the members it uses go away
+	mWatcher.reset();
+}
+
+void AssetReloader::watch_program( ShaderProgram& aProgram )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mPrograms.emplace_back( &aProgram );
+}
+void AssetReloader::watch_texture( std::string aPath, GLuint& aTexture )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mTextures.emplace_back( Texture_{ std::move(aPath), &aTexture } );
+}
+void AssetReloader::watch_mesh( std::string aPath, MeshArena& aArena, MeshHandle& aHandle )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mMeshes.emplace_back( Mesh_{ std::move(aPath), &aArena, &aHandle, nullptr, nullptr } );
+}
+void AssetReloader::watch_mesh( std::string aPath, MeshArena& aArena, LodChain& aLods, LodBuilder aBuildLevels )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mMeshes.emplace_back( Mesh_{ std::move(aPath), &aArena, nullptr, &aLods, std::move(aBuildLevels) } );
+}
+
+void AssetReloader::request_shaders()
+{
+	std::vector<std::string> paths;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		for( auto const* program : mPrograms )
+		{
+			for( auto const& source : program->sources() )
+				paths.emplace_back( source.sourcePath );
+		}
+	}
+
+	for( auto const& path : paths )
+		mWatcher->touch( path );
+}
+
+void AssetReloader::load_( std::string const& aPath )
+{
+	Loaded_ loaded{};
+	loaded.path = aPath;
+
+	LodBuilder buildLevels;
+
+	{
+		// Only the source paths of the programs are looked at here. They
+		// don't change after construction, so this is safe while the render
+		// thread rebuilds a program.
+		std::lock_guard<std::mutex> lock( mMutex );
+
+		bool found = false;
+		for( auto const* program : mPrograms )
+		{
+			if( program->uses( aPath ) )
+			{
+				loaded.kind = Kind_::shader;
+				found = true;
+				break;
+			}
+		}
+		for( auto const& tex : mTextures )
+		{
+			if( !found && tex.path == aPath )
+			{
+				loaded.kind = Kind_::texture;
+				found = true;
+			}
+		}
+		for( auto const& mesh : mMeshes )
+		{
+			if( !found && mesh.path == aPath )
+			{
+				loaded.kind = Kind_::mesh;
+				buildLevels = mesh.buildLevels;
+				found = true;
+			}
+		}
+
+		if( !found )
+			return;
+	}
+
+	try
+	{
+		switch( loaded.kind )
+		{
+			case Kind_::shader: loaded.text = read_text_( aPath.c_str() ); break;
+			case Kind_::texture: loaded.image = load_image_rgba( aPath.c_str() ); break;
+			case Kind_::mesh:
+			{
+				loaded.mesh = load_wavefront_obj( aPath.c_str() );
+				if( buildLevels )
+					loaded.levels = buildLevels( loaded.mesh );
+			} break;
+		}
+	}
+	catch( std::exception const& eErr )
+	{
+		loaded.error = eErr.what();
+	}
+
+	std::lock_guard<std::mutex> lock( mMutex );
+	mLoaded.emplace_back( std::move(loaded) );
+}
+
+std::size_t AssetReloader::apply( GLStateCache& aState )
+{
+	std::vector<Loaded_> loaded;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		if( mLoaded.empty() )
+			return 0;
+
+		std::swap( loaded, mLoaded );
+	}
+
+	std::size_t replaced = 0;
+	for( auto& item : loaded )
+	{
+		if( !item.error.empty() )
+		{
+			std::fprintf( stderr, "Reloading '%s' failed: %s\n", item.path.c_str(), item.error.c_str() );
+			continue;
+		}
+
+		std::size_t const before = replaced;
+		switch( item.kind )
+		{
+			case Kind_::shader:
+			{
+				for( auto* program : mPrograms )
+				{
+					if( !program->uses( item.path ) )
+						continue;
+
+					try
+					{
+						// the old program goes away and its name may be reused
+						GLuint const oldProgram = program->programId();
+						program->reload_source( item.path, item.text );
+						aState.forget_program( oldProgram );
+						aState.forget_program( program->programId() );
+						++replaced;
+					}
+					catch( std::exception const& eErr )
+					{
+						std::fprintf( stderr, "Error when reloading '%s':\n%s\nKeeping old shader.\n", item.path.c_str(), eErr.what() );
+					}
+				}
+			} break;
+
+			case Kind_::texture:
+			{
+				for( auto const& tex : mTextures )
+				{
+					if( tex.path != item.path )
+						continue;
+
+					GLuint const texture = create_texture_2d( item.image );
+					glDeleteTextures( 1, tex.texture );
+					*tex.texture = texture;
+					++replaced;
+				}
+			} break;
+
+			case Kind_::mesh:
+			{
+				for( auto const& mesh : mMeshes )
+				{
+					if( mesh.path != item.path )
+						continue;
+
+					if( !mesh.lods )
+					{
+						*mesh.handle = mesh.arena->replace( *mesh.handle, item.mesh );
+						++replaced;
+						continue;
+					}
+
+					if( item.levels.size() != mesh.lods->level_count() )
+					{
+						std::fprintf( stderr, "Reloading '%s' failed: %zu levels of detail instead of %zu\n", item.path.c_str(), item.levels.size(), mesh.lods->level_count() );
+						continue;
+					}
+
+					for( std::size_t i = 0; i < item.levels.size(); ++i )
+					{
+						auto const handle = mesh.arena->replace( mesh.lods->level( i ), item.levels[i].mesh );
+						mesh.lods->set_level( i, handle, item.levels[i].error );
+					}
+					++replaced;
+				}
+			} break;
+		}
+
+		if( replaced != before )
+			std::fprintf( stderr, "Reloaded '%s'.\n", item.path.c_str() );
+	}
+
+	// Texture uploads and buffer reallocations bind objects directly
+	aState.invalidate();
+
+	return replaced;
+}
@@ -0,0 +1,106 @@
+#ifndef ASSET_RELOAD_HPP_585CC794_C54D_4C4A_926E_0C0D9EE9904C
+#define ASSET_RELOAD_HPP_585CC794_C54D_4C4A_926E_0C0D9EE9904C
+
+#include <glad.h>
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "lod.hpp"
+#include "mesh_arena.hpp"
+#include "simple_mesh.hpp"
+#include "textures.hpp"
+
+#include "../support/glstate.hpp"
+#include "../support/program.hpp"
+#include "../support/file_watcher.hpp"
+
+/* AssetReloader: hot reloading of shaders, textures and meshes
+ *
+ * Watches a directory (see FileWatcher) for changes to registered assets.
+ * Changed files are read and decoded on the watcher thread: shader sources
+ * as text, images with load_image_rgba() and meshes with
+ * load_wavefront_obj(). The levels of detail of a mesh are generated there
+ * as well (see watch_mesh()). The render thread calls apply() at the start of a
+ * frame, which only swaps in the results (program rebuild from the loaded
+ * text, texture and buffer uploads). A frame never waits for the disk.
+ *
+ * A broken asset (e.g. a shader that fails to compile) is reported and the
+ * old one is kept.
+ *
+ * The registered objects must outlive the AssetReloader.
+ */
+class AssetReloader final
+{
+	public:
+		explicit AssetReloader( std::string aDirectory );
+		~AssetReloader();
+
+		AssetReloader( AssetReloader const& ) = delete;
+		AssetReloader& operator= (AssetReloader const&) = delete;
+
+	public:
+		void watch_program( ShaderProgram& );
+		void watch_texture( std::string aPath, GLuint& aTexture );
+		void watch_mesh( std::string aPath, MeshArena&, MeshHandle& );
+
+		// A mesh with levels of detail. When the file changes, aBuildLevels
+		// turns the loaded mesh into all levels, finest first, on the watcher
+		// thread (e.g. with simplify_mesh()). apply() then replaces every
+		// level of aLods. It must return as many levels as aLods has.
+		using LodBuilder = std::function<std::vector<LodMeshData>( SimpleMeshData const& )>;
+		void watch_mesh( std::string aPath, MeshArena&, LodChain& aLods, LodBuilder aBuildLevels );
+
+		// Re-read the sources of all watched programs, as if they changed
+		void request_shaders();
+
+		// Swap in everything loaded since the last call. Call on the render
+		// thread, at the start of a frame. Returns the number of replaced
+		// assets.
+		std::size_t apply( GLStateCache& );
+
+	private:
+		enum class Kind_ { shader, texture, mesh };
+
+		struct Loaded_
+		{
+			Kind_ kind;
+			std::string path;
+			std::string error; // non-empty if loading failed
+
+			std::string text;
+			ImageRGBA image;
+			SimpleMeshData mesh;
+			std::vector<LodMeshData> levels; // if registered with a LodBuilder
+		};
+
+		struct Texture_
+		{
+			std::string path;
+			GLuint* texture;
+		};
+		struct Mesh_
+		{
+			std::string path;
+			MeshArena* arena;
+			MeshHandle* handle; // either this
+			LodChain* lods;     // or these two
+			LodBuilder buildLevels;
+		};
+
+		void load_( std::string const& aPath ); // watcher thread
+
+		// registrations and loaded results; shared with the watcher thread
+		std::mutex mMutex;
+		std::vector<ShaderProgram*> mPrograms;
+		std::vector<Texture_> mTextures;
+		std::vector<Mesh_> mMeshes;
+		std::vector<Loaded_> mLoaded;
+
+		std::unique_ptr<FileWatcher> mWatcher;
+};
+
+#endif // ASSET_RELOAD_HPP_585CC794_C54D_4C4A_926E_0C0D9EE9904C
@@ -0,0 +1,284 @@
+#include "draw_list.hpp"
+
+#include <algorithm>
+
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+
+#include "../vmlib/vec3.hpp"
+
+namespace
+{
+	constexpr GLuint kCullGroupSize_ = 64; // must match local_size_x in cullObjects.comp
+
+	// Frustum planes (ax+by+cz+d >= 0 inside) from a row-major projection
+	// matrix (Gribb & Hartmann). Planes are normalized so that the distance
+	// to a bounding sphere center can be compared to its radius.
+	void extract_frustum_planes_( Mat44f const& aM, Vec4f aPlanes[6] ) noexcept
+	{
+		Vec4f const r0{ aM(0,0), aM(0,1), aM(0,2), aM(0,3) };
+		Vec4f const r1{ aM(1,0), aM(1,1), aM(1,2), aM(1,3) };
+		Vec4f const r2{ aM(2,0), aM(2,1), aM(2,2), aM(2,3) };
+		Vec4f const r3{ aM(3,0), aM(3,1), aM(3,2), aM(3,3) };
+
+		aPlanes[0] = r3 + r0; // left
+		aPlanes[1] = r3 - r0; // right
+		aPlanes[2] = r3 + r1; // bottom
+		aPlanes[3] = r3 - r1; // top
+		aPlanes[4] = r3 + r2; // near
+		aPlanes[5] = r3 - r2; // far
+
+		for( int i = 0; i < 6; ++i )
+		{
+			auto const len = length( Vec3f{ aPlanes[i].x, aPlanes[i].y, aPlanes[i].z } );
+			aPlanes[i] /= len;
+		}
+	}
+
+	bool sphere_visible_( Vec4f const aPlanes[6], Vec4f const& aSphere ) noexcept
+	{
+		for( int i = 0; i < 6; ++i )
+		{
+			float const dist = aPlanes[i].x * aSphere.x + aPlanes[i].y * aSphere.y + aPlanes[i].z * aSphere.z + aPlanes[i].w;
+			if( dist < -aSphere.w )
+				return false;
+		}
+		return true;
+	}
+}
+
+DrawList::DrawList( MeshArena const& aArena, GLStateCache& aState, StreamBuffer& aStream )
+	: mArena( &aArena )
+	, mState( &aState )
+	, mStream( &aStream )
+	, mCapacity( 0 )
+	, mDrawCount( 0 )
+	, mObjectData{}
+	, mCullInput{}
+	, mCpuCommands{}
+	, mCulledOnCpu( false )
+	, mCommandBuffer( 0 )
+	, mObjectIndexBuffer( 0 )
+	, mVao( 0 )
+	, mArenaRevision( 0 )
+{}
+
+DrawList::~DrawList()
+{
+	GLuint const buffers[] = { mCommandBuffer, mObjectIndexBuffer };
+	for( auto const buffer : buffers )
+	{
+		if( 0 != buffer )
+			glDeleteBuffers( 1, &buffer );
+	}
+
+	if( 0 != mVao )
+		glDeleteVertexArrays( 1, &mVao );
+}
+
+void DrawList::clear() noexcept
+{
+	mObjects.clear();
+	mCullData.clear();
+	mDrawCount = 0;
+}
+
+void DrawList::add( MeshHandle const& aMesh, Mat44f const& aModel2World )
+{
+	add( aMesh, aModel2World, normal_matrix( aModel2World ) );
+}
+void DrawList::add( MeshHandle const& aMesh, Mat44f const& aModel2World, Mat44f const& aNormalMatrix )
+{
+	ObjectData_ obj;
+	obj.model2World = aModel2World;
+	obj.normalMatrix = aNormalMatrix;
+	mObjects.emplace_back( obj );
+
+	// The bounding sphere is transformed to world space here, so that culling
+	// (CPU or GPU) only needs to test spheres against planes.
+	Vec4f const center = aModel2World * Vec4f{ aMesh.boundsCenter.x, aMesh.boundsCenter.y, aMesh.boundsCenter.z, 1.f };
+
+	float maxScale = 0.f;
+	for( std::size_t j = 0; j < 3; ++j )
+	{
+		Vec3f const axis{ aModel2World(0,j), aModel2World(1,j), aModel2World(2,j) };
+		maxScale = std::max( maxScale, length( axis ) );
+	}
+
+	CullData_ cull{};
+	cull.sphere = Vec4f{ center.x, center.y, center.z, aMesh.boundsRadius * maxScale };
+	cull.count = aMesh.indexCount;
+	cull.firstIndex = aMesh.firstIndex;
+	cull.baseVertex = aMesh.baseVertex;
+	mCullData.emplace_back( cull );
+}
+
+void DrawList::upload()
+{
+	reserve_( mObjects.size() );
+
+	// a hot reload may have moved the arena's buffers
+	if( mArenaRevision != mArena->buffer_revision() )
+		setup_vao_();
+
+	if( mObjects.empty() )
+		return;
+
+	std::size_t const align = mStream->storage_alignment();
+	mObjectData = mStream->write( mObjects.data(), mObjects.size() * sizeof(ObjectData_), align );
+	mCullInput = mStream->write( mCullData.data(), mCullData.size() * sizeof(CullData_), align );
+}
+
+void DrawList::cull( Mat44f const& aProjCameraWorld, GLuint aCullProgram )
+{
+	cull( &aProjCameraWorld, 1, aCullProgram );
+}
+
+void DrawList::cull( Mat44f const* aProjCameraWorld, std::size_t aViewCount, GLuint aCullProgram )
+{
+	assert( aViewCount > 0 && aViewCount <= kMaxViews );
+
+	mDrawCount = 0;
+	if( mObjects.empty() )
+		return;
+
+	Vec4f planes[6*kMaxViews];
+	for( std::size_t v = 0; v < aViewCount; ++v )
+		extract_frustum_planes_( aProjCameraWorld[v], planes + 6*v );
+
+	if( 0 != aCullProgram )
+	{
+		// GPU path: one invocation per object. Culled objects keep their
+		// command, but with instanceCount = 0.
+		mState->use_program( aCullProgram );
+		mState->uniform4fv( 0, GLsizei(6*aViewCount), &planes[0].x );
+		mState->uniform1ui( 12, GLuint(mObjects.size()) );
+		mState->uniform1ui( 13, GLuint(aViewCount) );
+
+		glBindBufferRange( GL_SHADER_STORAGE_BUFFER, 1, mCullInput.buffer, mCullInput.offset, mCullInput.size );
+		glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 2, mCommandBuffer );
+
+		glDispatchCompute( (GLuint(mObjects.size()) + kCullGroupSize_ - 1) / kCullGroupSize_, 1, 1 );
+
+		// Commands are read by the following glMultiDrawElementsIndirect()
+		glMemoryBarrier( GL_COMMAND_BARRIER_BIT );
+
+		mDrawCount = GLsizei(mObjects.size());
+		mCulledOnCpu = false;
+		return;
+	}
+
+	// CPU fallback: only visible objects get a command.
+	mCommands.clear();
+	for( std::size_t i = 0; i < mCullData.size(); ++i )
+	{
+		auto const& cull = mCullData[i];
+
+		bool visible = false;
+		for( std::size_t v = 0; v < aViewCount && !visible; ++v )
+			visible = sphere_visible_( planes + 6*v, cull.sphere );
+
+		if( !visible )
+			continue;
+
+		mCommands.emplace_back( DrawElementsIndirectCommand{
+			cull.count, 1, cull.firstIndex, cull.baseVertex, GLuint(i)
+		} );
+	}
+
+	mDrawCount = GLsizei(mCommands.size());
+	mCulledOnCpu = true;
+	if( 0 == mDrawCount )
+		return;
+
+	mCpuCommands = mStream->write( mCommands.data(), mCommands.size() * sizeof(DrawElementsIndirectCommand), alignof(DrawElementsIndirectCommand) );
+}
+
+void DrawList::draw() const
+{
+	if( 0 == mDrawCount )
+		return;
+
+	glBindBufferRange( GL_SHADER_STORAGE_BUFFER, 0, mObjectData.buffer, mObjectData.offset, mObjectData.size );
+
+	assert( mArenaRevision == mArena->buffer_revision() ); // see upload()
+	mState->bind_vertex_array( mVao );
+
+	if( mCulledOnCpu )
+	{
+		glBindBuffer( GL_DRAW_INDIRECT_BUFFER, mCpuCommands.buffer );
+		glMultiDrawElementsIndirect( GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<void const*>(mCpuCommands.offset), mDrawCount, 0 );
+	}
+	else
+	{
+		glBindBuffer( GL_DRAW_INDIRECT_BUFFER, mCommandBuffer );
+		glMultiDrawElementsIndirect( GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, mDrawCount, 0 );
+	}
+
+	glBindBuffer( GL_DRAW_INDIRECT_BUFFER, 0 );
+}
+
+std::size_t DrawList::object_count() const noexcept
+{
+	return mObjects.size();
+}
+
+void DrawList::reserve_( std::size_t aCount )
+{
+	if( aCount <= mCapacity && 0 != mCommandBuffer )
+		return;
+
+	// grow geometrically so that adding objects over time doesn't reallocate
+	// every frame
+	std::size_t const capacity = std::max<std::size_t>( { aCount, 2*mCapacity, 16 } );
+
+	if( 0 == mCommandBuffer )
+	{
+		glGenBuffers( 1, &mCommandBuffer );
+		glGenBuffers( 1, &mObjectIndexBuffer );
+	}
+
+	// Only written by the culling compute shader
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, mCommandBuffer );
+	glBufferData( GL_SHADER_STORAGE_BUFFER, capacity * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_COPY );
+
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, 0 );
+
+	// Object index i at position i. With a divisor of 1, the vertex shader
+	// sees the value at baseInstance (+ gl_InstanceID), i.e. the index of the
+	// object that is being drawn. This avoids requiring gl_BaseInstance (GL 4.6).
+	std::vector<GLuint> indices( capacity );
+	for( std::size_t i = 0; i < capacity; ++i )
+		indices[i] = GLuint(i);
+
+	glBindBuffer( GL_ARRAY_BUFFER, mObjectIndexBuffer );
+	glBufferData( GL_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW );
+	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+	mCapacity = capacity;
+
+	setup_vao_();
+}
+
+void DrawList::setup_vao_()
+{
+	// The arena's attributes plus the object index. Instance i of a draw
+	// reads element i of the object index buffer, which only has mCapacity
+	// entries. This is why the attribute isn't added to the arena's VAO,
+	// whose instanced draws (see InstanceBuffer) go far beyond that.
+	if( 0 == mVao )
+		glGenVertexArrays( 1, &mVao );
+
+	mState->bind_vertex_array( mVao );
+	mArena->setup_attributes();
+
+	glBindBuffer( GL_ARRAY_BUFFER, mObjectIndexBuffer );
+	glVertexAttribIPointer( 4, 1, GL_UNSIGNED_INT, 0, nullptr );
+	glVertexAttribDivisor( 4, 1 );
+	glEnableVertexAttribArray( 4 );
+
+	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+	mArenaRevision = mArena->buffer_revision();
+}
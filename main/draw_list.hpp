@@ -0,0 +1,133 @@
+#ifndef DRAW_LIST_HPP_7E5B4087_8DFF_4348_B655_0921B06B5131
+#define DRAW_LIST_HPP_7E5B4087_8DFF_4348_B655_0921B06B5131
+
+#include <glad.h>
+
+#include <vector>
+
+#include "mesh_arena.hpp"
+#include "stream_buffer.hpp"
+
+#include "../support/glstate.hpp"
+
+#include "../vmlib/vec4.hpp"
+#include "../vmlib/mat44.hpp"
+
+// Layout defined by OpenGL for glMultiDrawElementsIndirect()
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+/* DrawList: per-frame list of objects drawn from a MeshArena
+ *
+ * Each frame, objects are added with their model-to-world transform. The
+ * transforms are written to a StreamBuffer, bound as shader storage buffer
+ * (binding 0), and the list is then culled against one or more view frusta,
+ * producing one indirect draw command per object. All objects are drawn
+ * with a single glMultiDrawElementsIndirect() call, independent of the
+ * number of objects.
+ *
+ * The command's baseInstance is the object's index in the storage buffer. It
+ * reaches the vertex shader through an instanced attribute (location 4), see
+ * assets/colorShaderIndirect.vert. The attribute lives on the list's own VAO
+ * over the arena's buffers, so that instanced draws from the arena's VAO
+ * don't read past the end of the object index buffer.
+ *
+ * Culling runs in a compute shader (assets/cullObjects.comp) if a program is
+ * given to cull(), otherwise on the CPU.
+ *
+ * Program and VAO binds go through the GLStateCache passed at construction.
+ */
+class DrawList final
+{
+	public:
+		DrawList( MeshArena const&, GLStateCache&, StreamBuffer& );
+		~DrawList();
+
+		DrawList( DrawList const& ) = delete;
+		DrawList& operator= (DrawList const&) = delete;
+
+	public:
+		void clear() noexcept;
+
+		void add( MeshHandle const&, Mat44f const& aModel2World );
+
+		// Same, with a known normal matrix (the inverse transpose of
+		// aModel2World), e.g. from normal_matrix( Transform ) times a
+		// precomputed one for the mesh's placement
+		void add( MeshHandle const&, Mat44f const& aModel2World, Mat44f const& aNormalMatrix );
+
+		// Upload the objects added since clear(). Call once per frame, before
+		// cull() and draw().
+		void upload();
+
+		// Build the draw commands for the objects inside the view frustum of
+		// aProjCameraWorld. With aCullProgram == 0, culling runs on the CPU.
+		void cull( Mat44f const& aProjCameraWorld, GLuint aCullProgram = 0 );
+
+		// As above, but keeps objects that are inside any of the aViewCount
+		// (at most kMaxViews) frusta. Used when all views are drawn in a
+		// single pass.
+		void cull( Mat44f const* aProjCameraWorld, std::size_t aViewCount, GLuint aCullProgram = 0 );
+
+	public:
+		static constexpr std::size_t kMaxViews = 2; // see cullObjects.comp
+
+		// Draw the commands built by the last cull(). The caller binds the
+		// shader program and sets its uniforms.
+		void draw() const;
+
+		std::size_t object_count() const noexcept;
+
+	private:
+		// std430 layout; see assets/colorShaderIndirect.vert
+		struct ObjectData_
+		{
+			Mat44f model2World;
+			Mat44f normalMatrix; // upper 3x3 used
+		};
+
+		// std430 layout; see assets/cullObjects.comp
+		struct CullData_
+		{
+			Vec4f sphere; // world space center + radius
+			GLuint count;
+			GLuint firstIndex;
+			GLint baseVertex;
+			GLuint pad_;
+		};
+
+		void reserve_( std::size_t );
+		void setup_vao_();
+
+		MeshArena const* mArena;
+		GLStateCache* mState;
+		StreamBuffer* mStream;
+
+		std::vector<ObjectData_> mObjects;
+		std::vector<CullData_> mCullData;
+		std::vector<DrawElementsIndirectCommand> mCommands;
+
+		std::size_t mCapacity;
+		GLsizei mDrawCount;
+
+		// This frame's data in the stream buffer. Commands built on the CPU
+		// are streamed as well; the compute shader writes mCommandBuffer.
+		StreamBuffer::Allocation mObjectData;
+		StreamBuffer::Allocation mCullInput;
+		StreamBuffer::Allocation mCpuCommands;
+		bool mCulledOnCpu;
+
+		GLuint mCommandBuffer;
+		GLuint mObjectIndexBuffer;
+
+		GLuint mVao;
+		std::size_t mArenaRevision; // see MeshArena::buffer_revision()
+};
+
+#endif // DRAW_LIST_HPP_7E5B4087_8DFF_4348_B655_0921B06B5131
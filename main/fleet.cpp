@@ -0,0 +1,169 @@
+#include "fleet.hpp"
+
+#include <algorithm>
+
+#include <cmath>
+
+namespace
+{
+	// Fractional parts of multiples of the golden ratio are spread evenly
+	// over [0,1), however many rockets there are.
+	constexpr double kGoldenRatioFrac_ = 0.6180339887498949;
+}
+
+RocketFleet::RocketFleet( Trajectory const& aTrajectory, std::size_t aCount, Vec3f aFirstSite, float aSiteSpacing, std::size_t aThreads )
+	: mTrajectory( &aTrajectory )
+	, mTrajectoryOrigin( aTrajectory.sample( 0.f ).position )
+	, mGeneration( 0 )
+	, mBusy( 0 )
+	, mTime( 0.f )
+	, mOrigin{ 0., 0., 0. }
+	, mQuit( false )
+{
+	mPhase.resize( aCount );
+	mSiteX.resize( aCount );
+	mSiteY.resize( aCount );
+	mSiteZ.resize( aCount );
+	mPosX.resize( aCount );
+	mPosY.resize( aCount );
+	mPosZ.resize( aCount );
+	mAngle.resize( aCount );
+	mTransforms.resize( aCount, kIdentity44f );
+
+	// square grid of launch sites, rows going away from the first site
+	auto const perRow = std::max<std::size_t>( 1, std::size_t(std::ceil( std::sqrt( double(aCount) ) )) );
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		mSiteX[i] = aFirstSite.x + float(i % perRow) * aSiteSpacing;
+		mSiteY[i] = aFirstSite.y;
+		mSiteZ[i] = aFirstSite.z - float(i / perRow) * aSiteSpacing;
+
+		double const phase = double(i) * kGoldenRatioFrac_;
+		mPhase[i] = float(phase - std::floor( phase )) * LaunchSimulation::kLoopDuration;
+	}
+
+	if( 0 == aThreads )
+		aThreads = std::max( 1u, std::thread::hardware_concurrency() );
+
+	// no point in threads that would get no rockets
+	aThreads = std::max<std::size_t>( 1, std::min( aThreads, aCount ) );
+
+	mWorkers.reserve( aThreads-1 );
+	for( std::size_t i = 0; i+1 < aThreads; ++i )
+		mWorkers.emplace_back( [this, i] { work_( i ); } );
+}
+
+RocketFleet::~RocketFleet()
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mQuit = true;
+	}
+	mWake.notify_all();
+
+	for( auto& worker : mWorkers )
+		worker.join();
+}
+
+void RocketFleet::update( float aTime, Vec3d aOrigin )
+{
+	std::size_t const threads = mWorkers.size()+1;
+	std::size_t const count = mPhase.size();
+
+	if( !mWorkers.empty() )
+	{
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			mTime = aTime;
+			mOrigin = aOrigin;
+			mBusy = mWorkers.size();
+			++mGeneration;
+		}
+		mWake.notify_all();
+	}
+
+	update_range_( 0, count / threads, aTime, aOrigin );
+
+	if( !mWorkers.empty() )
+	{
+		std::unique_lock<std::mutex> lock( mMutex );
+		mDone.wait( lock, [this] { return 0 == mBusy; } );
+	}
+}
+
+std::vector<Mat44f> const& RocketFleet::transforms() const noexcept
+{
+	return mTransforms;
+}
+
+std::size_t RocketFleet::size() const noexcept
+{
+	return mPhase.size();
+}
+std::size_t RocketFleet::thread_count() const noexcept
+{
+	return mWorkers.size()+1;
+}
+
+void RocketFleet::work_( std::size_t aWorker )
+{
+	std::uint64_t seen = 0;
+	for( ;; )
+	{
+		float time;
+		Vec3d origin;
+		{
+			std::unique_lock<std::mutex> lock( mMutex );
+			mWake.wait( lock, [&] { return mQuit || seen != mGeneration; } );
+
+			if( mQuit )
+				return;
+
+			seen = mGeneration;
+			time = mTime;
+			origin = mOrigin;
+		}
+
+		// every worker takes part in every update, see update()
+		std::size_t const threads = mWorkers.size()+1;
+		std::size_t const count = mPhase.size();
+		std::size_t const range = aWorker+1;
+		update_range_( count * range / threads, count * (range+1) / threads, time, origin );
+
+		bool last;
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			last = (0 == --mBusy);
+		}
+		if( last )
+			mDone.notify_one();
+	}
+}
+
+void RocketFleet::update_range_( std::size_t aBegin, std::size_t aEnd, float aTime, Vec3d aOrigin ) noexcept
+{
+	for( std::size_t i = aBegin; i < aEnd; ++i )
+	{
+		float const time = std::fmod( aTime + mPhase[i], LaunchSimulation::kLoopDuration );
+		auto const state = mTrajectory->sample( time );
+
+		mPosX[i] = float( (double(mSiteX[i]) - aOrigin.x) + (state.position.x - mTrajectoryOrigin.x) );
+		mPosY[i] = float( (double(mSiteY[i]) - aOrigin.y) + (state.position.y - mTrajectoryOrigin.y) );
+		mPosZ[i] = float( (double(mSiteZ[i]) - aOrigin.z) + (state.position.z - mTrajectoryOrigin.z) );
+		mAngle[i] = state.angle;
+	}
+
+	// translation times rotation about z, see launch_model_to_world()
+	for( std::size_t i = aBegin; i < aEnd; ++i )
+	{
+		float const c = std::cos( mAngle[i] );
+		float const s = std::sin( mAngle[i] );
+
+		mTransforms[i] = Mat44f{ {
+			c, -s, 0.f, mPosX[i],
+			s, c, 0.f, mPosY[i],
+			0.f, 0.f, 1.f, mPosZ[i],
+			0.f, 0.f, 0.f, 1.f
+		} };
+	}
+}
@@ -0,0 +1,89 @@
+#ifndef FLEET_HPP_A8609888_7F12_4102_BE7D_99C690D85533
+#define FLEET_HPP_A8609888_7F12_4102_BE7D_99C690D85533
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "trajectory.hpp"
+
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/vec3d.hpp"
+#include "../vmlib/mat44.hpp"
+
+/* RocketFleet: many independent launches along the same trajectory
+ *
+ * Each rocket has its own launch site on a square grid and its own phase in
+ * the flight, so the launches are staggered. The flight restarts from the
+ * site every LaunchSimulation::kLoopDuration seconds.
+ *
+ * The per-rocket state is stored as separate arrays (structure of arrays),
+ * and update() splits the rockets into contiguous ranges that are sampled
+ * from the Trajectory in parallel by a set of persistent worker threads
+ * (plus the calling thread). Its results are the rockets' model-to-world
+ * transforms, ready for InstanceBuffer::assign_rigid(). The positions are
+ * computed in double precision and made relative to the origin passed to
+ * update() before they are rounded to float (see RenderOrigin).
+ *
+ * No OpenGL calls are made here, so the fleet can also be run without a
+ * window (see --simulate in main.cpp).
+ */
+class RocketFleet final
+{
+	public:
+		// aThreads is the total number of threads used by update(),
+		// including the calling one. Zero picks one per hardware thread.
+		RocketFleet(
+			Trajectory const&,
+			std::size_t aCount,
+			Vec3f aFirstSite,
+			float aSiteSpacing,
+			std::size_t aThreads = 0
+		);
+		~RocketFleet();
+
+		RocketFleet( RocketFleet const& ) = delete;
+		RocketFleet& operator= (RocketFleet const&) = delete;
+
+	public:
+		// Move all rockets to aTime seconds after the fleet started. The
+		// transforms are relative to aOrigin.
+		void update( float aTime, Vec3d aOrigin = Vec3d{ 0., 0., 0. } );
+
+		std::vector<Mat44f> const& transforms() const noexcept;
+
+		std::size_t size() const noexcept;
+		std::size_t thread_count() const noexcept;
+
+	private:
+		void work_( std::size_t aWorker );
+		void update_range_( std::size_t aBegin, std::size_t aEnd, float aTime, Vec3d aOrigin ) noexcept;
+
+		Trajectory const* mTrajectory;
+		Vec3d mTrajectoryOrigin;
+
+		// per rocket
+		std::vector<float> mPhase;
+		std::vector<float> mSiteX, mSiteY, mSiteZ;
+		std::vector<float> mPosX, mPosY, mPosZ;
+		std::vector<float> mAngle;
+
+		std::vector<Mat44f> mTransforms;
+
+		// workers; worker k updates range k+1, the caller range 0
+		std::vector<std::thread> mWorkers;
+
+		std::mutex mMutex;
+		std::condition_variable mWake, mDone;
+		std::uint64_t mGeneration;
+		std::size_t mBusy;
+		float mTime;
+		Vec3d mOrigin;
+		bool mQuit;
+};
+
+#endif // FLEET_HPP_A8609888_7F12_4102_BE7D_99C690D85533
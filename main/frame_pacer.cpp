@@ -0,0 +1,142 @@
+#include "frame_pacer.hpp"
+
+#include <GLFW/glfw3.h>
+
+#include <thread>
+#include <algorithm>
+
+#include <cstdio>
+
+namespace
+{
+	// Sleeps are woken up to this much before the deadline; the rest is spun
+	constexpr Clock::duration kSpinMargin_ = std::chrono::milliseconds( 2 );
+
+	constexpr Clock::duration kDefaultRefreshPeriod_ = std::chrono::duration_cast<Clock::duration>( Secondsf( 1.f / 60.f ) );
+
+	bool has_swap_control_tear_()
+	{
+		return glfwExtensionSupported( "WGL_EXT_swap_control_tear" )
+			|| glfwExtensionSupported( "GLX_EXT_swap_control_tear" );
+	}
+}
+
+char const* to_string( PaceMode aMode ) noexcept
+{
+	switch( aMode )
+	{
+		case PaceMode::vsync: return "vsync";
+		case PaceMode::adaptive: return "adaptive vsync";
+		case PaceMode::uncapped: return "uncapped";
+		case PaceMode::limited: return "limited";
+	}
+	return "unknown";
+}
+
+PaceMode next_mode( PaceMode aMode ) noexcept
+{
+	switch( aMode )
+	{
+		case PaceMode::vsync: return PaceMode::adaptive;
+		case PaceMode::adaptive: return PaceMode::uncapped;
+		case PaceMode::uncapped: return PaceMode::limited;
+		case PaceMode::limited: return PaceMode::vsync;
+	}
+	return PaceMode::vsync;
+}
+
+FramePacer::FramePacer( PaceMode aMode, Clock::duration aRefreshPeriod, Clock::duration aTargetFrameTime )
+	: mMode( aMode )
+	, mRefreshPeriod( aRefreshPeriod )
+	, mTargetFrameTime( aTargetFrameTime )
+{
+	set_mode( aMode );
+}
+
+void FramePacer::set_mode( PaceMode aMode )
+{
+	if( PaceMode::adaptive == aMode && !has_swap_control_tear_() )
+	{
+		std::fprintf( stderr, "Adaptive vsync needs EXT_swap_control_tear, using vsync.\n" );
+		aMode = PaceMode::vsync;
+	}
+
+	switch( aMode )
+	{
+		case PaceMode::vsync: glfwSwapInterval( 1 ); break;
+		case PaceMode::adaptive: glfwSwapInterval( -1 ); break;
+		case PaceMode::uncapped: // fall through
+		case PaceMode::limited: glfwSwapInterval( 0 ); break;
+	}
+
+	mMode = aMode;
+	mDeadline = Clock::now() + mTargetFrameTime;
+	mLastPresent = Clock::time_point{};
+	mStats = FrameStats{};
+}
+
+PaceMode FramePacer::mode() const noexcept
+{
+	return mMode;
+}
+
+void FramePacer::wait()
+{
+	if( PaceMode::limited != mMode )
+		return;
+
+	auto const now = Clock::now();
+	if( now > mDeadline + mTargetFrameTime )
+		mDeadline = now;
+
+	if( mDeadline - now > kSpinMargin_ )
+		std::this_thread::sleep_until( mDeadline - kSpinMargin_ );
+	while( Clock::now() < mDeadline )
+		;
+
+	mDeadline += mTargetFrameTime;
+}
+
+void FramePacer::presented() noexcept
+{
+	auto const now = Clock::now();
+	auto const last = mLastPresent;
+	mLastPresent = now;
+
+	if( Clock::time_point{} == last )
+		return;
+
+	// Welford's update, so the variance doesn't suffer from cancellation
+	double const frameSeconds = std::chrono::duration<double>( now - last ).count();
+	std::size_t const n = ++mStats.frames;
+	double const delta = frameSeconds - mStats.meanSeconds;
+	mStats.meanSeconds += delta / double(n);
+	double const m2 = mStats.varianceSeconds2 * double(n-1) + delta * (frameSeconds - mStats.meanSeconds);
+	mStats.varianceSeconds2 = m2 / double(n);
+
+	mStats.minSeconds = 1 == n ? frameSeconds : std::min( mStats.minSeconds, frameSeconds );
+	mStats.maxSeconds = std::max( mStats.maxSeconds, frameSeconds );
+
+	if( frameSeconds > 1.5 * std::chrono::duration<double>( frame_period() ).count() )
+		++mStats.missedDeadlines;
+}
+
+Clock::duration FramePacer::frame_period() const noexcept
+{
+	return PaceMode::limited == mMode ? mTargetFrameTime : mRefreshPeriod;
+}
+
+FrameStats const& FramePacer::stats() const noexcept
+{
+	return mStats;
+}
+
+Clock::duration display_refresh_period()
+{
+	GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+	GLFWvidmode const* videoMode = monitor ? glfwGetVideoMode( monitor ) : nullptr;
+	if( !videoMode || videoMode->refreshRate <= 0 )
+		return kDefaultRefreshPeriod_;
+
+	return std::chrono::duration_cast<Clock::duration>( Secondsf( 1.f / float(videoMode->refreshRate) ) );
+}
@@ -0,0 +1,93 @@
+#ifndef FRAME_PACER_HPP_F6C0FD70_1DCA_4E8D_8066_B29CC26F7C8E
+#define FRAME_PACER_HPP_F6C0FD70_1DCA_4E8D_8066_B29CC26F7C8E
+
+#include <cstddef>
+
+#include "defaults.hpp"
+
+/* PaceMode: how frames are paced
+ *
+ *  - vsync: swap interval 1, frames wait for the display refresh
+ *  - adaptive: swap interval -1 (EXT_swap_control_tear), i.e. vsync, but a
+ *    late frame is shown right away instead of waiting for the next refresh
+ *  - uncapped: swap interval 0, as fast as the CPU and GPU go
+ *  - limited: swap interval 0, and the CPU waits until the target frame time
+ *    has passed before each swap (see FramePacer::wait())
+ */
+enum class PaceMode
+{
+	vsync,
+	adaptive,
+	uncapped,
+	limited
+};
+
+char const* to_string( PaceMode ) noexcept;
+
+// The mode after aMode, for cycling through them with a key
+PaceMode next_mode( PaceMode aMode ) noexcept;
+
+/* FrameStats: frame to frame times, measured after each swap
+ *
+ * A frame misses its deadline when it took more than one and a half frame
+ * periods (of the display in vsync, adaptive and uncapped mode, the target
+ * frame time in limited mode), i.e. when it was shown at least one refresh
+ * later than it should have been.
+ */
+struct FrameStats
+{
+	std::size_t frames;
+	std::size_t missedDeadlines;
+
+	double meanSeconds;
+	double varianceSeconds2;
+	double minSeconds, maxSeconds;
+};
+
+/* FramePacer: swap interval and CPU-side frame limiter
+ *
+ * Call wait() right before glfwSwapBuffers() and presented() right after
+ * it. In limited mode, wait() sleeps for most of the remaining frame time
+ * and spins for the last bit, since a sleep may overshoot by a millisecond or
+ * more. A frame that comes in later than one period past its deadline starts
+ * a new schedule instead of being caught up with.
+ *
+ * The swap interval is that of the current GL context; set_mode() has to be
+ * called with the context current. Adaptive vsync falls back to vsync if the
+ * platform doesn't have EXT_swap_control_tear. The statistics start over on
+ * every mode change.
+ */
+class FramePacer final
+{
+	public:
+		FramePacer( PaceMode, Clock::duration aRefreshPeriod, Clock::duration aTargetFrameTime );
+
+	public:
+		void set_mode( PaceMode );
+		PaceMode mode() const noexcept;
+
+		void wait();
+		void presented() noexcept;
+
+		// The period the frames are measured against, see FrameStats
+		Clock::duration frame_period() const noexcept;
+
+		FrameStats const& stats() const noexcept;
+
+	private:
+		PaceMode mMode;
+
+		Clock::duration mRefreshPeriod;
+		Clock::duration mTargetFrameTime;
+
+		Clock::time_point mDeadline;
+		Clock::time_point mLastPresent;
+
+		FrameStats mStats;
+};
+
+// Refresh period of the primary monitor; 60 Hz if it can't be determined.
+// Requires GLFW to be initialized.
+Clock::duration display_refresh_period();
+
+#endif // FRAME_PACER_HPP_F6C0FD70_1DCA_4E8D_8066_B29CC26F7C8E
@@ -0,0 +1,89 @@
+#include "input_sampler.hpp"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+
+InputSampler::InputSampler() noexcept
+	: mHasPosition( false )
+	, mX( 0. ), mY( 0. )
+	, mSampledX( 0. ), mSampledY( 0. )
+	, mPending( false )
+	, mLatency{}
+{}
+
+void InputSampler::cursor_moved( double aX, double aY, Clock::time_point aWhen ) noexcept
+{
+	if( !mHasPosition )
+	{
+		// nothing to measure the first position against
+		mSampledX = aX;
+		mSampledY = aY;
+		mHasPosition = true;
+	}
+	else if( !mPending && (aX != mSampledX || aY != mSampledY) )
+	{
+		mOldestEvent = aWhen;
+		mPending = true;
+	}
+
+	mX = aX;
+	mY = aY;
+}
+
+CursorSample InputSampler::sample( GLFWwindow* aWindow ) noexcept
+{
+	auto const now = Clock::now();
+	poll_( aWindow, now );
+
+	CursorSample ret{};
+	ret.dx = float(mX - mSampledX);
+	ret.dy = float(mY - mSampledY);
+	// events for movement that an earlier sample already picked up from
+	// glfwGetCursorPos() leave the cursor where it was sampled
+	ret.moved = mPending && (0.f != ret.dx || 0.f != ret.dy);
+	ret.oldestEvent = mOldestEvent;
+	ret.sampled = now;
+
+	mSampledX = mX;
+	mSampledY = mY;
+	mPending = false;
+	return ret;
+}
+
+void InputSampler::discard( GLFWwindow* aWindow ) noexcept
+{
+	poll_( aWindow, Clock::now() );
+
+	mSampledX = mX;
+	mSampledY = mY;
+	mPending = false;
+}
+
+void InputSampler::submitted( CursorSample const& aSample, Clock::time_point aSubmit ) noexcept
+{
+	if( !aSample.moved )
+		return;
+
+	double const eventSeconds = std::chrono::duration<double>( aSubmit - aSample.oldestEvent ).count();
+	double const sampleSeconds = std::chrono::duration<double>( aSubmit - aSample.sampled ).count();
+
+	std::size_t const n = ++mLatency.frames;
+	mLatency.meanEventSeconds += (eventSeconds - mLatency.meanEventSeconds) / double(n);
+	mLatency.meanSampleSeconds += (sampleSeconds - mLatency.meanSampleSeconds) / double(n);
+	mLatency.maxEventSeconds = std::max( mLatency.maxEventSeconds, eventSeconds );
+}
+
+InputLatency const& InputSampler::latency() const noexcept
+{
+	return mLatency;
+}
+
+void InputSampler::poll_( GLFWwindow* aWindow, Clock::time_point aNow ) noexcept
+{
+	// glfwGetCursorPos() asks the OS, so this may be newer than the last event
+	double x, y;
+	glfwGetCursorPos( aWindow, &x, &y );
+	if( !mHasPosition || x != mX || y != mY )
+		cursor_moved( x, y, aNow );
+}
@@ -0,0 +1,86 @@
+#ifndef INPUT_SAMPLER_HPP_FE50B7F8_144B_4301_BF9B_BF181F30FD36
+#define INPUT_SAMPLER_HPP_FE50B7F8_144B_4301_BF9B_BF181F30FD36
+
+#include <cstddef>
+
+#include "defaults.hpp"
+
+struct GLFWwindow;
+
+/* CursorSample: cursor movement taken by InputSampler::sample()
+ *
+ * dx and dy are in pixels (screen coordinates, y down). oldestEvent is when
+ * the earliest of the movements in the sample came in; it is only valid if
+ * moved is set.
+ */
+struct CursorSample
+{
+	float dx, dy;
+	bool moved;
+
+	Clock::time_point oldestEvent;
+	Clock::time_point sampled;
+};
+
+/* InputLatency: time from input to frame submission
+ *
+ * Only frames where the camera used cursor movement are counted. The event
+ * to submit time runs from the oldest movement in the sample, the sample to
+ * submit time from when the camera took it.
+ */
+struct InputLatency
+{
+	std::size_t frames;
+
+	double meanEventSeconds, maxEventSeconds;
+	double meanSampleSeconds;
+};
+
+/* InputSampler: timestamped cursor input for the camera
+ *
+ * The cursor callback only records where the cursor went and when
+ * (cursor_moved()). The camera takes the movement since its previous sample
+ * with sample(), as late in the frame as it can, right before the view
+ * matrices are uploaded. sample() also asks GLFW where the cursor is now, so
+ * movement that happened after the last glfwPollEvents() is included. The
+ * positions are absolute, so nothing is counted twice when the events for
+ * movement that was already sampled come in later.
+ *
+ * GLFW doesn't pass on the timestamps of the OS, so an event is timed when
+ * its callback runs, i.e. in glfwPollEvents().
+ *
+ * submitted() records the latency of a sample once the frame that used it
+ * is submitted.
+ */
+class InputSampler final
+{
+	public:
+		InputSampler() noexcept;
+
+	public:
+		void cursor_moved( double aX, double aY, Clock::time_point aWhen ) noexcept;
+
+		// Movement since the previous sample (or discard())
+		CursorSample sample( GLFWwindow* ) noexcept;
+
+		// Drop the movement so far, e.g. while the camera ignores the mouse
+		void discard( GLFWwindow* ) noexcept;
+
+		void submitted( CursorSample const&, Clock::time_point aSubmit ) noexcept;
+
+		InputLatency const& latency() const noexcept;
+
+	private:
+		void poll_( GLFWwindow*, Clock::time_point aNow ) noexcept;
+
+		bool mHasPosition;
+		double mX, mY;
+		double mSampledX, mSampledY;
+
+		bool mPending;
+		Clock::time_point mOldestEvent;
+
+		InputLatency mLatency;
+};
+
+#endif // INPUT_SAMPLER_HPP_FE50B7F8_144B_4301_BF9B_BF181F30FD36
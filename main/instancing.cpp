@@ -0,0 +1,138 @@
+#include "instancing.hpp"
+
+#include <algorithm>
+
+InstanceBuffer::InstanceBuffer( GLStateCache& aState )
+	: mState( &aState )
+	, mStream( nullptr )
+	, mStreamed{}
+	, mCount( 0 )
+	, mCapacity( 0 )
+	, mBuffer( 0 )
+{}
+InstanceBuffer::InstanceBuffer( GLStateCache& aState, StreamBuffer& aStream )
+	: mState( &aState )
+	, mStream( &aStream )
+	, mStreamed{}
+	, mCount( 0 )
+	, mCapacity( 0 )
+	, mBuffer( 0 )
+{}
+
+InstanceBuffer::~InstanceBuffer()
+{
+	if( 0 != mBuffer )
+		glDeleteBuffers( 1, &mBuffer );
+}
+
+void InstanceBuffer::assign( std::vector<Mat44f> const& aModel2World )
+{
+	mStaging.clear();
+	mStaging.reserve( aModel2World.size() );
+
+	for( auto const& model2World : aModel2World )
+	{
+		InstanceData_ inst;
+		inst.model2World = model2World;
+		inst.normalMatrix = normal_matrix( model2World );
+		mStaging.emplace_back( inst );
+	}
+
+	upload_();
+}
+
+void InstanceBuffer::assign_rigid( std::vector<Mat44f> const& aModel2World )
+{
+	assign_rigid( aModel2World.data(), aModel2World.size() );
+}
+void InstanceBuffer::assign_rigid( Mat44f const* aModel2World, std::size_t aCount )
+{
+	mStaging.resize( aCount );
+
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		mStaging[i].model2World = aModel2World[i];
+		mStaging[i].normalMatrix = aModel2World[i];
+	}
+
+	upload_();
+}
+
+void InstanceBuffer::reserve( std::size_t aCount )
+{
+	mStaging.reserve( aCount );
+
+	if( !mStream && aCount > mCapacity )
+	{
+		if( 0 == mBuffer )
+			glGenBuffers( 1, &mBuffer );
+
+		// Contents are replaced by the next assign() anyway
+		glBindBuffer( GL_SHADER_STORAGE_BUFFER, mBuffer );
+		glBufferData( GL_SHADER_STORAGE_BUFFER, aCount * sizeof(InstanceData_), nullptr, GL_STATIC_DRAW );
+		glBindBuffer( GL_SHADER_STORAGE_BUFFER, 0 );
+
+		mCapacity = aCount;
+		mCount = 0;
+	}
+}
+
+void InstanceBuffer::upload_()
+{
+	mCount = mStaging.size();
+	if( 0 == mCount )
+		return;
+
+	if( mStream )
+	{
+		mStreamed = mStream->write( mStaging.data(), mCount * sizeof(InstanceData_), mStream->storage_alignment() );
+		return;
+	}
+
+	if( 0 == mBuffer )
+		glGenBuffers( 1, &mBuffer );
+
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, mBuffer );
+	if( mCount > mCapacity )
+	{
+		mCapacity = std::max<std::size_t>( mCount, 2*mCapacity );
+		glBufferData( GL_SHADER_STORAGE_BUFFER, mCapacity * sizeof(InstanceData_), nullptr, GL_STATIC_DRAW );
+	}
+	glBufferSubData( GL_SHADER_STORAGE_BUFFER, 0, mCount * sizeof(InstanceData_), mStaging.data() );
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, 0 );
+}
+
+void InstanceBuffer::draw( MeshArena const& aArena, MeshHandle const& aMesh ) const
+{
+	if( 0 == mCount )
+		return;
+
+	bind();
+
+	mState->bind_vertex_array( aArena.vao() );
+	glDrawElementsInstancedBaseVertex(
+		GL_TRIANGLES,
+		aMesh.indexCount,
+		GL_UNSIGNED_INT,
+		reinterpret_cast<void const*>(aMesh.firstIndex * sizeof(GLuint)),
+		GLsizei(mCount),
+		aMesh.baseVertex
+	);
+}
+
+void InstanceBuffer::bind() const
+{
+	if( mStream )
+	{
+		if( 0 != mCount )
+			glBindBufferRange( GL_SHADER_STORAGE_BUFFER, kBinding, mStreamed.buffer, mStreamed.offset, mStreamed.size );
+		return;
+	}
+
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, kBinding, mBuffer );
+}
+
+std::size_t InstanceBuffer::size() const noexcept
+{
+	return mCount;
+}
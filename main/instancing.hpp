@@ -0,0 +1,87 @@
+#ifndef INSTANCING_HPP_CDF7A496_61F7_4F72_B4B9_559ADDD370B1
+#define INSTANCING_HPP_CDF7A496_61F7_4F72_B4B9_559ADDD370B1
+
+#include <glad.h>
+
+#include <vector>
+
+#include "mesh_arena.hpp"
+#include "stream_buffer.hpp"
+
+#include "../support/glstate.hpp"
+
+#include "../vmlib/mat44.hpp"
+
+/* InstanceBuffer: per-instance transforms for drawing one mesh many times
+ *
+ * Holds the model-to-world and normal matrices of all instances of a
+ * repeated prop (e.g. the landing pads) in a shader storage buffer. The mesh
+ * is then drawn with a single glDrawElementsInstancedBaseVertex(), and the
+ * vertex shader picks its transform with gl_InstanceID, see
+ * assets/colorShaderInstanced.vert.
+ *
+ * The transforms are only uploaded by assign(), so static props cost nothing
+ * per frame beyond the draw call.
+ *
+ * Instances that move every frame (e.g. the fleet) are instead written to a
+ * StreamBuffer, if one is given at construction. Their data then only lasts
+ * for the current frame: assign() every frame they are drawn.
+ */
+class InstanceBuffer final
+{
+	public:
+		explicit InstanceBuffer( GLStateCache& );
+		InstanceBuffer( GLStateCache&, StreamBuffer& );
+		~InstanceBuffer();
+
+		InstanceBuffer( InstanceBuffer const& ) = delete;
+		InstanceBuffer& operator= (InstanceBuffer const&) = delete;
+
+	public:
+		// Replace all instances
+		void assign( std::vector<Mat44f> const& aModel2World );
+
+		// Replace all instances with transforms that only rotate and
+		// translate. Their normal matrix is the transform itself, which
+		// saves inverting each of them.
+		void assign_rigid( std::vector<Mat44f> const& aModel2World );
+		void assign_rigid( Mat44f const* aModel2World, std::size_t aCount );
+
+		// Make room for aCount instances, so that assigning up to that many
+		// does not reallocate
+		void reserve( std::size_t aCount );
+
+		// Draw aMesh once per instance. The caller binds the shader program
+		// and sets its uniforms.
+		void draw( MeshArena const&, MeshHandle const& ) const;
+
+		// Bind the instance data to kBinding, for draws made by the caller
+		void bind() const;
+
+		std::size_t size() const noexcept;
+
+	public:
+		// Shader storage binding used by assets/colorShaderInstanced.vert
+		static constexpr GLuint kBinding = 3;
+
+	private:
+		// std430 layout; see assets/colorShaderInstanced.vert
+		struct InstanceData_
+		{
+			Mat44f model2World;
+			Mat44f normalMatrix; // upper 3x3 used
+		};
+
+		void upload_();
+
+		GLStateCache* mState;
+		StreamBuffer* mStream;
+		StreamBuffer::Allocation mStreamed;
+
+		std::vector<InstanceData_> mStaging;
+
+		std::size_t mCount, mCapacity;
+		GLuint mBuffer;
+};
+
+#endif // INSTANCING_HPP_CDF7A496_61F7_4F72_B4B9_559ADDD370B1
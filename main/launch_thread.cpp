@@ -0,0 +1,108 @@
+#include "launch_thread.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	constexpr auto kStep_ = std::chrono::duration_cast<Clock::duration>( Secondsf( LaunchSimulation::kTimeStep ) );
+}
+
+LaunchState interpolate( LaunchFrame const& aFrame, Clock::time_point aNow ) noexcept
+{
+	float const alpha = std::chrono::duration_cast<Secondsf>(aNow - aFrame.stepTime).count() / LaunchSimulation::kTimeStep;
+	return interpolate( aFrame.previous, aFrame.current, std::clamp( alpha, 0.f, 1.f ) );
+}
+
+LaunchThread::LaunchThread( Vec3f aLaunchPosition, std::vector<Particle> aParticles )
+	: mSimulation( aLaunchPosition )
+	, mParticles( std::move(aParticles) )
+	, mActive( false )
+	, mQuit( false )
+{
+	// the first frame is there before the thread starts
+	publish_( Clock::now() );
+
+	mThread = std::thread( [this] { run_(); } );
+}
+
+LaunchThread::~LaunchThread()
+{
+	mQuit.store( true, std::memory_order_release );
+	mThread.join();
+}
+
+void LaunchThread::set_active( bool aActive ) noexcept
+{
+	mActive.store( aActive, std::memory_order_release );
+}
+
+LaunchFrame const& LaunchThread::latest() noexcept
+{
+	mFrames.update();
+	return mFrames.front();
+}
+
+Vec3f LaunchThread::launch_position() const noexcept
+{
+	return mSimulation.launch_position();
+}
+
+void LaunchThread::run_()
+{
+	auto next = Clock::now();
+	while( !mQuit.load( std::memory_order_acquire ) )
+	{
+		auto const now = Clock::now();
+
+		if( !mActive.load( std::memory_order_acquire ) )
+		{
+			if( 0 != mSimulation.step_count() )
+			{
+				mSimulation.reset();
+				publish_( now );
+			}
+
+			next = now + kStep_;
+			std::this_thread::sleep_until( next );
+			continue;
+		}
+
+		// drop what can't be caught up with, see LaunchSimulation::advance()
+		if( now - next > LaunchSimulation::kMaxStepsPerAdvance * kStep_ )
+			next = now - LaunchSimulation::kMaxStepsPerAdvance * kStep_;
+
+		std::size_t steps = 0;
+		while( next <= now )
+		{
+			mSimulation.step();
+			runParticles( mParticles, 0, LaunchSimulation::kTimeStep );
+
+			next += kStep_;
+			++steps;
+		}
+
+		if( steps > 0 )
+			publish_( next - kStep_ );
+
+		std::this_thread::sleep_until( next );
+	}
+}
+
+void LaunchThread::publish_( Clock::time_point aStepTime )
+{
+	LaunchFrame& frame = mFrames.back();
+	frame.previous = mSimulation.previous();
+	frame.current = mSimulation.current();
+	frame.stepTime = aStepTime;
+	frame.steps = mSimulation.step_count();
+
+	// only the live particles are drawn
+	frame.particles.clear();
+	for( auto const& particle : mParticles )
+	{
+		if( particle.lifespan > 0.f )
+			frame.particles.emplace_back( particle.placement );
+	}
+
+	mFrames.publish();
+}
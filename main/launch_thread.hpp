@@ -0,0 +1,83 @@
+#ifndef LAUNCH_THREAD_HPP_2E3C1DFD_91B7_4885_AC2E_B13FEE10413B
+#define LAUNCH_THREAD_HPP_2E3C1DFD_91B7_4885_AC2E_B13FEE10413B
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <cstdint>
+
+#include "defaults.hpp"
+#include "particle.hpp"
+#include "simulation.hpp"
+
+#include "../support/triple_buffer.hpp"
+
+#include "../vmlib/mat44.hpp"
+
+/* LaunchFrame: snapshot of the launch, as produced by LaunchThread
+ *
+ * Everything the renderer needs from the flight: the last two simulation
+ * steps (to interpolate between), when the later one was due, and the
+ * placements of the live exhaust particles relative to the rocket.
+ */
+struct LaunchFrame
+{
+	LaunchState previous, current;
+	Clock::time_point stepTime;
+	std::uint64_t steps;
+
+	std::vector<Mat44f> particles;
+};
+
+// State to draw at aNow: blends previous and current by the time passed
+// since stepTime, which puts the drawn flight one step behind the simulation
+LaunchState interpolate( LaunchFrame const&, Clock::time_point aNow ) noexcept;
+
+/* LaunchThread: runs the launch simulation on its own thread
+ *
+ * The flight and its exhaust particles are stepped at a fixed rate of
+ * LaunchSimulation::kTimeStep, independent of the frame rate (at most
+ * kMaxStepsPerAdvance steps are caught up after a stall, the rest is dropped,
+ * as with LaunchSimulation::advance()). After each batch of steps the thread
+ * writes a LaunchFrame and hands it to the render thread through a
+ * TripleBuffer, so neither thread ever waits for the other. The render
+ * thread only reads latest(), which stays valid and unchanged until the next
+ * call to latest().
+ *
+ * While inactive, the flight is held at the launch position.
+ */
+class LaunchThread final
+{
+	public:
+		LaunchThread( Vec3f aLaunchPosition, std::vector<Particle> aParticles );
+		~LaunchThread();
+
+		LaunchThread( LaunchThread const& ) = delete;
+		LaunchThread& operator= (LaunchThread const&) = delete;
+
+	public:
+		// Start or stop the flight; stopping puts the rocket back on the pad
+		void set_active( bool ) noexcept;
+
+		// Render thread only
+		LaunchFrame const& latest() noexcept;
+
+		Vec3f launch_position() const noexcept;
+
+	private:
+		void run_();
+		void publish_( Clock::time_point aStepTime );
+
+		LaunchSimulation mSimulation; // update thread only, after construction
+		std::vector<Particle> mParticles;
+
+		TripleBuffer<LaunchFrame> mFrames;
+
+		std::atomic<bool> mActive;
+		std::atomic<bool> mQuit;
+
+		std::thread mThread;
+};
+
+#endif // LAUNCH_THREAD_HPP_2E3C1DFD_91B7_4885_AC2E_B13FEE10413B
@@ -0,0 +1,593 @@
+#include "lod.hpp"
+
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include "../vmlib/vec4.hpp"
+
+namespace
+{
+	// Boundary edges get an extra plane, perpendicular to their triangle,
+	// with this weight. Keeps open borders (e.g. the rim of a model) in place.
+	constexpr double kBoundaryWeight_ = 100.0;
+
+	// Nearest depth considered for pixels_per_unit(), to avoid dividing by
+	// zero for objects around the camera.
+	constexpr float kMinDepth_ = 1e-3f;
+
+	struct V3_
+	{
+		double x, y, z;
+	};
+
+	V3_ operator+( V3_ aA, V3_ aB ) noexcept { return { aA.x+aB.x, aA.y+aB.y, aA.z+aB.z }; }
+	V3_ operator-( V3_ aA, V3_ aB ) noexcept { return { aA.x-aB.x, aA.y-aB.y, aA.z-aB.z }; }
+	V3_ operator*( V3_ aA, double aS ) noexcept { return { aA.x*aS, aA.y*aS, aA.z*aS }; }
+
+	double dot_( V3_ aA, V3_ aB ) noexcept
+	{
+		return aA.x*aB.x + aA.y*aB.y + aA.z*aB.z;
+	}
+	V3_ cross_( V3_ aA, V3_ aB ) noexcept
+	{
+		return { aA.y*aB.z - aA.z*aB.y, aA.z*aB.x - aA.x*aB.z, aA.x*aB.y - aA.y*aB.x };
+	}
+
+	// Symmetric 4x4 matrix: sum of squared distances to a set of planes.
+	// Stored as its upper triangle: xx xy xz xw yy yz yw zz zw ww.
+	struct Quadric_
+	{
+		double q[10];
+	};
+
+	Quadric_ operator+( Quadric_ const& aA, Quadric_ const& aB ) noexcept
+	{
+		Quadric_ ret;
+		for( int i = 0; i < 10; ++i )
+			ret.q[i] = aA.q[i] + aB.q[i];
+		return ret;
+	}
+
+	void add_plane_( Quadric_& aQ, V3_ aNormal, double aD, double aWeight ) noexcept
+	{
+		double const a = aNormal.x, b = aNormal.y, c = aNormal.z, d = aD;
+		double const plane[10] = {
+			a*a, a*b, a*c, a*d,
+			     b*b, b*c, b*d,
+			          c*c, c*d,
+			               d*d
+		};
+		for( int i = 0; i < 10; ++i )
+			aQ.q[i] += aWeight * plane[i];
+	}
+
+	double evaluate_( Quadric_ const& aQ, V3_ aP ) noexcept
+	{
+		auto const* q = aQ.q;
+		double const x = aP.x, y = aP.y, z = aP.z;
+		return q[0]*x*x + 2.0*q[1]*x*y + 2.0*q[2]*x*z + 2.0*q[3]*x
+			+ q[4]*y*y + 2.0*q[5]*y*z + 2.0*q[6]*y
+			+ q[7]*z*z + 2.0*q[8]*z
+			+ q[9];
+	}
+
+	// Position minimizing the quadric, if the 3x3 system is well conditioned
+	bool minimize_( Quadric_ const& aQ, V3_& aOut ) noexcept
+	{
+		auto const* q = aQ.q;
+		double const a00 = q[0], a01 = q[1], a02 = q[2];
+		double const a11 = q[4], a12 = q[5];
+		double const a22 = q[7];
+		double const b0 = -q[3], b1 = -q[6], b2 = -q[8];
+
+		double const c00 = a11*a22 - a12*a12;
+		double const c01 = a02*a12 - a01*a22;
+		double const c02 = a01*a12 - a02*a11;
+		double const det = a00*c00 + a01*c01 + a02*c02;
+
+		double const scale = a00*a00 + a11*a11 + a22*a22;
+		if( std::fabs( det ) <= 1e-12 * scale * std::sqrt( scale ) )
+			return false;
+
+		double const c11 = a00*a22 - a02*a02;
+		double const c12 = a01*a02 - a00*a12;
+		double const c22 = a00*a11 - a01*a01;
+
+		aOut = V3_{
+			(c00*b0 + c01*b1 + c02*b2) / det,
+			(c01*b0 + c11*b1 + c12*b2) / det,
+			(c02*b0 + c12*b1 + c22*b2) / det
+		};
+		return true;
+	}
+
+	struct Triangle_
+	{
+		std::uint32_t v[3];
+		std::uint32_t corner; // first corner in the input mesh
+		bool alive;
+	};
+
+	struct Collapse_
+	{
+		double cost;
+		std::uint32_t keep, remove;
+		std::uint32_t keepStamp, removeStamp;
+		V3_ target;
+
+		bool operator> ( Collapse_ const& aOther ) const noexcept
+		{
+			return cost > aOther.cost;
+		}
+	};
+
+	std::uint64_t edge_key_( std::uint32_t aA, std::uint32_t aB ) noexcept
+	{
+		if( aA > aB )
+			std::swap( aA, aB );
+		return (std::uint64_t(aA) << 32) | aB;
+	}
+
+	struct PositionKey_
+	{
+		std::uint32_t bits[3];
+
+		bool operator== ( PositionKey_ const& aOther ) const noexcept
+		{
+			return 0 == std::memcmp( bits, aOther.bits, sizeof(bits) );
+		}
+	};
+	struct PositionKeyHash_
+	{
+		std::size_t operator() ( PositionKey_ const& aKey ) const noexcept
+		{
+			std::uint64_t h = 0xcbf29ce484222325ull;
+			for( auto const b : aKey.bits )
+				h = (h ^ b) * 0x100000001b3ull;
+			return std::size_t(h);
+		}
+	};
+
+	PositionKey_ position_key_( Vec3f aP ) noexcept
+	{
+		// + 0.f turns -0 into +0, so both weld
+		float const values[3] = { aP.x + 0.f, aP.y + 0.f, aP.z + 0.f };
+
+		PositionKey_ key;
+		std::memcpy( key.bits, values, sizeof(key.bits) );
+		return key;
+	}
+
+	class Simplifier_
+	{
+		public:
+			explicit Simplifier_( SimpleMeshData const& );
+
+			void run( std::size_t aTargetTriangles );
+
+			SimpleMeshData result( SimpleMeshData const& aInput ) const;
+			double max_cost() const noexcept { return mMaxCost; }
+
+		private:
+			void push_( std::uint32_t aKeep, std::uint32_t aRemove );
+			bool flips_( std::uint32_t aMoved, std::uint32_t aOther, V3_ aTarget ) const;
+			bool manifold_( std::uint32_t aA, std::uint32_t aB ) const;
+			void neighbors_( std::uint32_t aV, std::vector<std::uint32_t>& aOut ) const;
+			void collapse_( Collapse_ const& );
+
+			std::vector<V3_> mPositions;
+			std::vector<Quadric_> mQuadrics;
+			std::vector<std::uint32_t> mStamps;
+			std::vector<bool> mAlive;
+			std::vector<std::vector<std::uint32_t>> mVertexTriangles;
+
+			std::vector<Triangle_> mTriangles;
+			std::size_t mLiveTriangles;
+
+			std::priority_queue<Collapse_, std::vector<Collapse_>, std::greater<Collapse_>> mHeap;
+			double mMaxCost;
+
+			// scratch
+			mutable std::vector<std::uint32_t> mScratchA, mScratchB;
+	};
+
+	Simplifier_::Simplifier_( SimpleMeshData const& aMesh )
+		: mLiveTriangles( 0 )
+		, mMaxCost( 0.0 )
+	{
+		std::size_t const corners = aMesh.positions.size() / 3 * 3;
+
+		// weld corners by position
+		std::unordered_map<PositionKey_, std::uint32_t, PositionKeyHash_> welded;
+		std::vector<std::uint32_t> cornerVertex( corners );
+		for( std::size_t i = 0; i < corners; ++i )
+		{
+			auto const& p = aMesh.positions[i];
+			auto const [it, added] = welded.emplace( position_key_( p ), std::uint32_t(mPositions.size()) );
+			if( added )
+				mPositions.emplace_back( V3_{ p.x, p.y, p.z } );
+			cornerVertex[i] = it->second;
+		}
+
+		std::size_t const vertexCount = mPositions.size();
+		mQuadrics.assign( vertexCount, Quadric_{} );
+		mStamps.assign( vertexCount, 0 );
+		mAlive.assign( vertexCount, true );
+		mVertexTriangles.resize( vertexCount );
+
+		// triangles and their plane quadrics; degenerate ones are dropped
+		std::unordered_map<std::uint64_t, std::uint32_t> edgeUses;
+		for( std::size_t i = 0; i < corners; i += 3 )
+		{
+			Triangle_ tri{ { cornerVertex[i], cornerVertex[i+1], cornerVertex[i+2] }, std::uint32_t(i), true };
+			if( tri.v[0] == tri.v[1] || tri.v[1] == tri.v[2] || tri.v[0] == tri.v[2] )
+				continue;
+
+			V3_ const p0 = mPositions[tri.v[0]];
+			V3_ n = cross_( mPositions[tri.v[1]] - p0, mPositions[tri.v[2]] - p0 );
+			double const len = std::sqrt( dot_( n, n ) );
+			if( len > 0.0 )
+			{
+				n = n * (1.0 / len);
+				for( auto const v : tri.v )
+					add_plane_( mQuadrics[v], n, -dot_( n, p0 ), 1.0 );
+			}
+
+			auto const index = std::uint32_t(mTriangles.size());
+			for( int k = 0; k < 3; ++k )
+			{
+				mVertexTriangles[tri.v[k]].emplace_back( index );
+				++edgeUses[edge_key_( tri.v[k], tri.v[(k+1)%3] )];
+			}
+			mTriangles.emplace_back( tri );
+		}
+		mLiveTriangles = mTriangles.size();
+
+		// boundary edges: plane through the edge, perpendicular to its triangle
+		for( auto const& tri : mTriangles )
+		{
+			V3_ const p0 = mPositions[tri.v[0]];
+			V3_ n = cross_( mPositions[tri.v[1]] - p0, mPositions[tri.v[2]] - p0 );
+			double const len = std::sqrt( dot_( n, n ) );
+			if( len <= 0.0 )
+				continue;
+			n = n * (1.0 / len);
+
+			for( int k = 0; k < 3; ++k )
+			{
+				auto const a = tri.v[k], b = tri.v[(k+1)%3];
+				if( 1 != edgeUses[edge_key_( a, b )] )
+					continue;
+
+				V3_ bn = cross_( mPositions[b] - mPositions[a], n );
+				double const blen = std::sqrt( dot_( bn, bn ) );
+				if( blen <= 0.0 )
+					continue;
+				bn = bn * (1.0 / blen);
+
+				double const d = -dot_( bn, mPositions[a] );
+				add_plane_( mQuadrics[a], bn, d, kBoundaryWeight_ );
+				add_plane_( mQuadrics[b], bn, d, kBoundaryWeight_ );
+			}
+		}
+
+		for( auto const& edge : edgeUses )
+			push_( std::uint32_t(edge.first >> 32), std::uint32_t(edge.first) );
+	}
+
+	void Simplifier_::run( std::size_t aTargetTriangles )
+	{
+		while( mLiveTriangles > aTargetTriangles && !mHeap.empty() )
+		{
+			Collapse_ const c = mHeap.top();
+			mHeap.pop();
+
+			// stale: one of the vertices moved or went away since
+			if( !mAlive[c.keep] || !mAlive[c.remove] )
+				continue;
+			if( mStamps[c.keep] != c.keepStamp || mStamps[c.remove] != c.removeStamp )
+				continue;
+
+			if( !manifold_( c.keep, c.remove ) )
+				continue;
+			if( flips_( c.keep, c.remove, c.target ) || flips_( c.remove, c.keep, c.target ) )
+				continue;
+
+			collapse_( c );
+			mMaxCost = std::max( mMaxCost, c.cost );
+		}
+	}
+
+	void Simplifier_::push_( std::uint32_t aKeep, std::uint32_t aRemove )
+	{
+		Quadric_ const q = mQuadrics[aKeep] + mQuadrics[aRemove];
+
+		V3_ const a = mPositions[aKeep], b = mPositions[aRemove];
+		V3_ const mid = (a + b) * 0.5;
+
+		// the optimum, unless it is ill-defined or strays far from the edge;
+		// otherwise the best of the two ends and the midpoint
+		V3_ best = mid;
+		double bestCost = evaluate_( q, mid );
+
+		V3_ opt;
+		V3_ const edge = b - a;
+		if( minimize_( q, opt ) && dot_( opt - mid, opt - mid ) <= 4.0 * dot_( edge, edge ) )
+		{
+			best = opt;
+			bestCost = evaluate_( q, opt );
+		}
+		else
+		{
+			for( auto const& candidate : { a, b } )
+			{
+				double const cost = evaluate_( q, candidate );
+				if( cost < bestCost )
+				{
+					best = candidate;
+					bestCost = cost;
+				}
+			}
+		}
+
+		mHeap.push( Collapse_{
+			std::max( bestCost, 0.0 ),
+			aKeep, aRemove,
+			mStamps[aKeep], mStamps[aRemove],
+			best
+		} );
+	}
+
+	bool Simplifier_::flips_( std::uint32_t aMoved, std::uint32_t aOther, V3_ aTarget ) const
+	{
+		for( auto const t : mVertexTriangles[aMoved] )
+		{
+			auto const& tri = mTriangles[t];
+			if( !tri.alive )
+				continue;
+			if( aOther == tri.v[0] || aOther == tri.v[1] || aOther == tri.v[2] )
+				continue; // removed by the collapse
+
+			V3_ before[3], after[3];
+			for( int k = 0; k < 3; ++k )
+			{
+				before[k] = mPositions[tri.v[k]];
+				after[k] = aMoved == tri.v[k] ? aTarget : before[k];
+			}
+
+			V3_ const n0 = cross_( before[1] - before[0], before[2] - before[0] );
+			V3_ const n1 = cross_( after[1] - after[0], after[2] - after[0] );
+			if( dot_( n0, n1 ) <= 0.0 )
+				return true;
+		}
+		return false;
+	}
+
+	// An edge may only collapse if its ends share no neighbors other than
+	// the opposite corners of the edge's triangles; otherwise the result
+	// would no longer be a manifold surface.
+	bool Simplifier_::manifold_( std::uint32_t aA, std::uint32_t aB ) const
+	{
+		neighbors_( aA, mScratchA );
+		neighbors_( aB, mScratchB );
+
+		std::size_t shared = 0;
+		for( auto const n : mScratchA )
+		{
+			if( std::binary_search( mScratchB.begin(), mScratchB.end(), n ) )
+				++shared;
+		}
+
+		std::size_t edgeTriangles = 0;
+		for( auto const t : mVertexTriangles[aA] )
+		{
+			auto const& tri = mTriangles[t];
+			if( tri.alive && (aB == tri.v[0] || aB == tri.v[1] || aB == tri.v[2]) )
+				++edgeTriangles;
+		}
+
+		return shared <= edgeTriangles;
+	}
+
+	void Simplifier_::neighbors_( std::uint32_t aV, std::vector<std::uint32_t>& aOut ) const
+	{
+		aOut.clear();
+		for( auto const t : mVertexTriangles[aV] )
+		{
+			auto const& tri = mTriangles[t];
+			if( !tri.alive )
+				continue;
+
+			for( auto const v : tri.v )
+			{
+				if( v != aV )
+					aOut.emplace_back( v );
+			}
+		}
+
+		std::sort( aOut.begin(), aOut.end() );
+		aOut.erase( std::unique( aOut.begin(), aOut.end() ), aOut.end() );
+	}
+
+	void Simplifier_::collapse_( Collapse_ const& aCollapse )
+	{
+		auto const keep = aCollapse.keep;
+		auto const remove = aCollapse.remove;
+
+		mPositions[keep] = aCollapse.target;
+		mQuadrics[keep] = mQuadrics[keep] + mQuadrics[remove];
+		mAlive[remove] = false;
+		++mStamps[keep];
+
+		for( auto const t : mVertexTriangles[remove] )
+		{
+			auto& tri = mTriangles[t];
+			if( !tri.alive )
+				continue;
+
+			if( keep == tri.v[0] || keep == tri.v[1] || keep == tri.v[2] )
+			{
+				tri.alive = false;
+				--mLiveTriangles;
+				continue;
+			}
+
+			for( auto& v : tri.v )
+			{
+				if( remove == v )
+					v = keep;
+			}
+			mVertexTriangles[keep].emplace_back( t );
+		}
+		mVertexTriangles[remove].clear();
+
+		// drop dead triangles from the kept vertex' list
+		auto& tris = mVertexTriangles[keep];
+		tris.erase( std::remove_if( tris.begin(), tris.end(), [this] (std::uint32_t aT) {
+			return !mTriangles[aT].alive;
+		} ), tris.end() );
+
+		// all edges around the kept vertex changed cost
+		std::vector<std::uint32_t> neighbors;
+		neighbors_( keep, neighbors );
+		for( auto const n : neighbors )
+			push_( keep, n );
+	}
+
+	SimpleMeshData Simplifier_::result( SimpleMeshData const& aInput ) const
+	{
+		bool const hasColors = aInput.colors.size() == aInput.positions.size();
+		bool const hasNormals = aInput.normals.size() == aInput.positions.size();
+		bool const hasTexcoords = aInput.texcoords.size() == aInput.positions.size();
+
+		SimpleMeshData ret;
+		for( auto const& tri : mTriangles )
+		{
+			if( !tri.alive )
+				continue;
+
+			for( std::size_t k = 0; k < 3; ++k )
+			{
+				auto const& p = mPositions[tri.v[k]];
+				ret.positions.emplace_back( Vec3f{ float(p.x), float(p.y), float(p.z) } );
+
+				std::size_t const corner = tri.corner + k;
+				if( hasColors )
+					ret.colors.emplace_back( aInput.colors[corner] );
+				if( hasNormals )
+					ret.normals.emplace_back( aInput.normals[corner] );
+				if( hasTexcoords )
+					ret.texcoords.emplace_back( aInput.texcoords[corner] );
+			}
+		}
+		return ret;
+	}
+}
+
+void LodChain::add_level( MeshHandle const& aMesh, float aError )
+{
+	assert( mErrors.empty() || aError >= mErrors.back() );
+
+	mLevels.emplace_back( aMesh );
+	mErrors.emplace_back( aError );
+}
+void LodChain::set_level( std::size_t aLevel, MeshHandle const& aMesh, float aError )
+{
+	assert( aLevel < mLevels.size() );
+	assert( 0 == aLevel || aError >= mErrors[aLevel-1] );
+
+	mLevels[aLevel] = aMesh;
+	mErrors[aLevel] = aError;
+}
+
+std::size_t LodChain::level_count() const noexcept
+{
+	return mLevels.size();
+}
+
+MeshHandle& LodChain::level( std::size_t aLevel ) noexcept
+{
+	assert( aLevel < mLevels.size() );
+	return mLevels[aLevel];
+}
+MeshHandle const& LodChain::level( std::size_t aLevel ) const noexcept
+{
+	assert( aLevel < mLevels.size() );
+	return mLevels[aLevel];
+}
+float LodChain::error( std::size_t aLevel ) const noexcept
+{
+	assert( aLevel < mErrors.size() );
+	return mErrors[aLevel];
+}
+
+std::size_t LodChain::select( float aPixelsPerUnit, float aMaxPixelError ) const noexcept
+{
+	// errors grow with the level, so walk down from the coarsest
+	for( std::size_t i = mErrors.size(); i > 1; --i )
+	{
+		if( mErrors[i-1] * aPixelsPerUnit <= aMaxPixelError )
+			return i-1;
+	}
+	return 0;
+}
+
+float pixels_per_unit( Mat44f const& aProjCameraWorld, Vec3f aCenter, float aRadius, float aPixelScale ) noexcept
+{
+	// clip space w is the distance along the view direction
+	float const w = aProjCameraWorld(3,0) * aCenter.x
+		+ aProjCameraWorld(3,1) * aCenter.y
+		+ aProjCameraWorld(3,2) * aCenter.z
+		+ aProjCameraWorld(3,3);
+
+	return aPixelScale / std::max( w - aRadius, kMinDepth_ );
+}
+
+std::size_t select_lod( LodChain const& aChain, Mat44f const& aModel2World, Mat44f const* aProjCameraWorld, std::size_t aViewCount, float aPixelScale )
+{
+	if( 0 == aChain.level_count() )
+		return 0;
+
+	auto const& bounds = aChain.level( 0 );
+	Vec4f const c = aModel2World * Vec4f{ bounds.boundsCenter.x, bounds.boundsCenter.y, bounds.boundsCenter.z, 1.f };
+	Vec3f const center{ c.x, c.y, c.z };
+
+	float ppu = 0.f;
+	for( std::size_t v = 0; v < aViewCount; ++v )
+		ppu = std::max( ppu, pixels_per_unit( aProjCameraWorld[v], center, bounds.boundsRadius, aPixelScale ) );
+
+	return aChain.select( ppu );
+}
+
+void select_instance_lods( LodChain const& aChain, std::vector<Mat44f> const& aModel2World, Mat44f const* aProjCameraWorld, std::size_t aViewCount, float aPixelScale, std::vector<Mat44f>* aPerLevel )
+{
+	for( std::size_t i = 0; i < aChain.level_count(); ++i )
+		aPerLevel[i].clear();
+
+	if( 0 == aChain.level_count() )
+		return;
+
+	for( auto const& model2World : aModel2World )
+	{
+		auto const level = select_lod( aChain, model2World, aProjCameraWorld, aViewCount, aPixelScale );
+		aPerLevel[level].emplace_back( model2World );
+	}
+}
+
+SimpleMeshData simplify_mesh( SimpleMeshData const& aMesh, std::size_t aTargetTriangles, float* aError )
+{
+	Simplifier_ simplifier( aMesh );
+	simplifier.run( aTargetTriangles );
+
+	if( aError )
+		*aError = float(std::sqrt( simplifier.max_cost() ));
+
+	return simplifier.result( aMesh );
+}
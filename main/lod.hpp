@@ -0,0 +1,106 @@
+#ifndef LOD_HPP_5A632199_2193_4295_97DB_9BC3711CC703
+#define LOD_HPP_5A632199_2193_4295_97DB_9BC3711CC703
+
+#include <vector>
+
+#include <cstddef>
+
+#include "mesh_arena.hpp"
+#include "simple_mesh.hpp"
+
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/mat44.hpp"
+
+/* Levels of detail
+ *
+ * A LodChain holds versions of the same mesh from finest to coarsest, each
+ * with its geometric error: how far (in model units) its surface may be from
+ * the full detail one. Per object and frame, select() picks the coarsest
+ * level whose error stays below about a pixel on screen, so distant
+ * objects are drawn with a few triangles.
+ *
+ * Levels are either generated again with fewer subdivisions (procedural
+ * shapes, see make_cylinder()), or simplified from the full mesh with
+ * simplify_mesh() (loaded models).
+ *
+ * Model transforms are assumed not to scale; the errors are compared in
+ * model units.
+ */
+class LodChain final
+{
+	public:
+		// Levels must be added from finest to coarsest
+		void add_level( MeshHandle const&, float aError );
+
+		// Swap in a new version of an existing level, e.g. after a hot
+		// reload. Levels are replaced from finest to coarsest, so that the
+		// errors keep growing with the level.
+		void set_level( std::size_t, MeshHandle const&, float aError );
+
+		std::size_t level_count() const noexcept;
+
+		MeshHandle& level( std::size_t ) noexcept;
+		MeshHandle const& level( std::size_t ) const noexcept;
+		float error( std::size_t ) const noexcept;
+
+		// Coarsest level whose error stays below aMaxPixelError pixels, at
+		// a distance where one model unit spans aPixelsPerUnit pixels
+		std::size_t select( float aPixelsPerUnit, float aMaxPixelError = kDefaultPixelError ) const noexcept;
+
+	public:
+		static constexpr float kDefaultPixelError = 1.f;
+
+	private:
+		std::vector<MeshHandle> mLevels;
+		std::vector<float> mErrors;
+};
+
+// Pixels per world unit on the nearest point of a bounding sphere, for a
+// projection that maps one unit at distance one to aPixelScale pixels (i.e.,
+// projection(1,1) times half the viewport height).
+float pixels_per_unit( Mat44f const& aProjCameraWorld, Vec3f aCenter, float aRadius, float aPixelScale ) noexcept;
+
+// Level of aChain for an object at aModel2World, for the largest size it has
+// in any of the aViewCount views. The bounds of the finest level are used.
+std::size_t select_lod(
+	LodChain const&,
+	Mat44f const& aModel2World,
+	Mat44f const* aProjCameraWorld,
+	std::size_t aViewCount,
+	float aPixelScale
+);
+
+// Sort the instance transforms in aModel2World into one list per level of
+// aChain (aPerLevel must have level_count() entries), choosing the level for
+// the largest size in any of the aViewCount views.
+void select_instance_lods(
+	LodChain const&,
+	std::vector<Mat44f> const& aModel2World,
+	Mat44f const* aProjCameraWorld,
+	std::size_t aViewCount,
+	float aPixelScale,
+	std::vector<Mat44f>* aPerLevel
+);
+
+/* Quadric error metric simplification (Garland & Heckbert)
+ *
+ * Welds the corners of aMesh by position and collapses edges, cheapest
+ * first, until at most aTargetTriangles triangles remain (or no collapse is
+ * possible without flipping a triangle). The cost of a collapse is the sum of
+ * squared distances to the planes of the original triangles around it;
+ * boundary edges are additionally held in place.
+ *
+ * Triangles keep the colors, normals and texture coordinates of their
+ * original corners. aError (if given) receives the largest distance error of
+ * any collapse, in model units.
+ */
+SimpleMeshData simplify_mesh( SimpleMeshData const& aMesh, std::size_t aTargetTriangles, float* aError = nullptr );
+
+// One level of detail of a loaded model, before it is added to a MeshArena
+struct LodMeshData
+{
+	SimpleMeshData mesh;
+	float error;
+};
+
+#endif // LOD_HPP_5A632199_2193_4295_97DB_9BC3711CC703
@@ -2,20 +2,29 @@
 #include <GLFW/glfw3.h>
 
 #include <typeinfo>
+#include <cassert>
+#include <algorithm>
+#include <optional>
 #include <stdexcept>
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <cmath>
 #include <iostream>
 
 #include "../support/error.hpp"
 #include "../support/program.hpp"
+#include "../support/program_cache.hpp"
 #include "../support/checkpoint.hpp"
 #include "../support/debug_output.hpp"
+#include "../support/glstate.hpp"
+#include "../support/frame_arena.hpp"
+#include "../support/heap_counter.hpp"
 
 #include "../vmlib/vec4.hpp"
 #include "../vmlib/mat44.hpp"
+#include "../vmlib/transform.hpp"
 
 #include "defaults.hpp"
 #include "simple_mesh.hpp"
@@ -24,6 +33,23 @@
 #include "textures.hpp"
 #include "shapes.hpp"
 #include "particle.hpp"
+#include "mesh_arena.hpp"
+#include "mesh_registry.hpp"
+#include "mesh_builder.hpp"
+#include "draw_list.hpp"
+#include "instancing.hpp"
+#include "view_uniforms.hpp"
+#include "stream_buffer.hpp"
+#include "asset_reload.hpp"
+#include "simulation.hpp"
+#include "launch_thread.hpp"
+#include "trajectory.hpp"
+#include "fleet.hpp"
+#include "lod.hpp"
+#include "render_origin.hpp"
+#include "frame_pacer.hpp"
+#include "input_sampler.hpp"
+#include "render_queue.hpp"
 
 
 namespace
@@ -32,23 +58,63 @@ namespace
 	
 	constexpr float kPi_ = 3.1415926f;
 
-	constexpr float kMouseSensitivity_ = 0.01f; // radians per pixel
+	//the tracking cameras aim this far ahead along the flight path (seconds), but
+	//never more than kCameraMaxLookAhead_ units ahead of the rocket
+	constexpr float kCameraLookAhead_ = 0.5f;
+	constexpr float kCameraMaxLookAhead_ = 4.f;
+
+	//the tracking cameras: one fixed on the ground, one following the rocket
+	constexpr Vec3d kGroundCameraPos_ = to_vec3d(Vec3f{ -10.f, 0.1f, -20.f });
+	constexpr Vec3d kFollowCameraOffset_ = { 0., 3., 30. };
+
+	//fleet mode (L key, or --fleet N): rockets launching from a grid on the spaceport
+	constexpr std::size_t kDefaultFleetSize_ = 1024;
+	constexpr GLuint kFleetExhaustParticles_ = 32; //per rocket
+
+	//levels of detail (O toggles them). the rocket is generated again with fewer
+	//subdivisions per level, the landing pad is simplified from the loaded model
+	constexpr std::size_t kSpaceshipLodSubdivs_[] = { 128, 32, 12, 6, 3 };
+	constexpr std::size_t kLandingPadLodReduction_[] = { 4, 16, 64 }; //triangles divided by
+	constexpr std::size_t kMaxLodLevels_ = 5;
+	static_assert(sizeof(kSpaceshipLodSubdivs_) / sizeof(kSpaceshipLodSubdivs_[0]) <= kMaxLodLevels_, "too many spaceship levels");
+	static_assert(sizeof(kLandingPadLodReduction_) / sizeof(kLandingPadLodReduction_[0]) + 1 <= kMaxLodLevels_, "too many landing pad levels");
+
+	//the first frames set up buffers and driver state, and are allowed to allocate
+	constexpr std::size_t kWarmupFrames_ = 2;
+
+	//what a queued draw is (RenderItem::id); RenderItem::arg is the level of detail
+	enum class SceneDraw_ : std::uint32_t
+	{
+		landMass,
+		landingPads,
+		spaceship,
+		fleet,
+		particles,
+		fleetExhaust,
+		count
+	};
+
+	//one GPU timer per queued draw and pre-pass draw
+	constexpr std::size_t kMaxTimedDraws_ = 64;
+	//frames of GPU queries in flight. a frame's results are read two frames later, by
+	//when the GPU is done with them, so reading them doesn't wait
+	constexpr std::size_t kQueryFrames_ = 3;
 
 	struct CameraValues
 	{
-		Vec3f cameraFront;
-		Vec3f cameraUp;
 		Vec3f cameraPos;
 		float movementSpeed;
+	};
+
+	struct CameraLook
+	{
+		Vec3f cameraFront;
 		float yaw;
 		float pitch;
-		bool firstMouse;
 	};
 
 	struct State_
 	{
-		ShaderProgram* prog;
-
 		struct CamCtrl_
 		{
 			bool cameraActive;
@@ -62,10 +128,12 @@ namespace
 			float radius;
 			float x_move_speed, y_move_speed, z_move_speed;
 
-			float lastX, lastY;
 			float currentX, currentY;
 		} camControl, camComtrolViewport2;
 
+		//cursor movement for the camera, with the time it came in
+		InputSampler input;
+
 		std::vector<Vec3f> lightPositions;
 		std::vector<Vec3f> lightColors;
 		std::vector<Vec3f> vertPositions;
@@ -74,8 +142,20 @@ namespace
 		float mousePressedX;
 		float mousePressedY;
 
+		//key presses and mouse clicks so far. frames with new ones may allocate
+		std::size_t inputEvents;
+
+		bool reloadShaders;
 		bool splitscreen;
 		bool switchscreen;
+		bool cpuCulling;
+		bool spaceport;
+		bool padsChanged;
+		bool padsPerDrawLoop;
+		bool fleet;
+		bool lod;
+		bool cyclePaceMode;
+		bool depthPrepass;
 		enum cameraTracking
 		{
 			cameraNormal,
@@ -84,7 +164,7 @@ namespace
 		} cameraMode = cameraNormal, cameraMode2 = cameraNormal;
 
 		
-		Vec3f vecSpaceshipTranslation;
+		Vec3d vecSpaceshipTranslation;
 	};
 
 	
@@ -98,35 +178,65 @@ namespace
 
 	float radians(float degrees);
 	
-	void draw_land_mass(GLuint shaderId, Mat44f projCameraWorld, Mat33f normalMatrix, Vec3f lightDir, GLuint tex, GLuint vao, int vertexCount);
+	void draw_land_mass(GLStateCache& glState, GLuint shaderId, Mat44f model2World, Mat33f normalMatrix, Vec3f lightDir, GLuint tex, GLuint vao, MeshHandle const& mesh);
+
+	void set_color_shader_uniforms(GLStateCache& glState, Vec3f lightDir,
+		std::vector<Vec3f> const& lightPositions, std::vector<Vec3f> const& lightColors, std::vector<Vec3f> const& vertPositions);
+
+	void draw_scene_objects(GLStateCache& glState, GLuint shaderId, Vec3f lightDir, DrawList const& drawList,
+		std::vector<Vec3f> const& lightPositions, std::vector<Vec3f> const& lightColors, std::vector<Vec3f> const& vertPositions);
 
-	void draw_landing_pad(GLuint shaderId, Mat44f projection, Mat44f lookAt, Mat44f translations[], int numTranslations,
-		Mat33f normalMatrix, Vec3f lightDir, GLuint vao, int vertexCount,
-		std::vector<Vec3f> lightPositions, std::vector<Vec3f> lightColors, std::vector<Vec3f> vertPositions);
+	void draw_landing_pads(GLStateCache& glState, GLuint shaderId, Vec3f lightDir,
+		MeshArena const& arena, MeshHandle const& mesh, InstanceBuffer const& instances,
+		std::vector<Vec3f> const& lightPositions, std::vector<Vec3f> const& lightColors, std::vector<Vec3f> const& vertPositions);
 
-	void draw_spaceship(GLuint shaderId, Mat44f projection, Mat44f lookAt, Mat44f translation, Mat33f normalMatrix, Vec3f lightDir, GLuint vao, int vertexCount,
-		std::vector<Vec3f> lightPositions, std::vector<Vec3f> lightColors, std::vector<Vec3f> vertPositions);
+	void draw_landing_pads_loop(GLStateCache& glState, GLuint shaderId, Vec3f lightDir, Mat33f normalMatrix,
+		MeshArena const& arena, MeshHandle const& mesh, std::vector<Mat44f> const& translations,
+		std::vector<Vec3f> const& lightPositions, std::vector<Vec3f> const& lightColors, std::vector<Vec3f> const& vertPositions);
 
-	void draw_particles(GLuint shaderId, Mat44f projection, Mat44f lookAt, Mat44f translation, Mat33f normalMatrix,
-		std::vector<Particle> particleList, std::vector<GLuint> vao, int vertexCount, std::vector<Vec3f> particleMovement);
+	void add_spaceport_pads(std::vector<Mat44f>& pads);
+	std::vector<LodMeshData> landing_pad_levels(SimpleMeshData const& landingPad);
+
+	std::vector<PlacedMesh> spaceship_parts(MeshRegistry& registry, std::size_t subdivs);
+
+	void draw_particles(GLStateCache& glState, GLuint shaderId, Mat44f projection, Mat44f lookAt, Mat44f translation,
+		std::vector<Mat44f> const& particlePlacements, MeshArena const& arena, MeshHandle const& mesh,
+		FrameArena& frameArena, InstanceBuffer& instances);
 
 	Mat44f lookAt(Vec3f eye, Vec3f target);
 
-	CameraValues get_camera_values(State_ &state, float movementSpeed, float dt, Vec3f cameraPos, Vec3f cameraFront, Vec3f cameraUp,
-			float xDiff, float yDiff, float yaw, float pitch, bool firstMouse);
+	CameraValues get_camera_values(State_ &state, float movementSpeed, float dt, Vec3f cameraPos, Vec3f cameraFront, Vec3f cameraUp);
+	CameraLook get_camera_look(float xDiff, float yDiff, float yaw, float pitch);
 
 	std::vector<Vec3f> get_lightpositions();
 	std::vector<Vec3f> get_lightcolors();
 	std::vector<Vec3f> get_vertpositions();
 
-	GLuint create_rectangle_vao(std::vector<Vec2f> kPositions, Vec4f color);
+	GLuint create_rectangle_vao(GLStateCache& glState, FrameArena& arena, std::vector<Vec2f> const& kPositions, Vec4f color);
+	GLuint create_stream_rectangle_vao(GLStateCache& glState);
+	void draw_stream_rectangle(GLStateCache& glState, StreamBuffer& stream, FrameArena& arena, GLuint vao,
+		std::vector<Vec2f> const& positions, Vec4f color);
 
 	Vec2f translate_2d_to_xy(float x_2d, float y_2d, float screenWidth, float screenHeight);
 
-	bool is_mouse_in_area(float mouse_x, float mouse_y, std::vector<Vec2f> boundingCoords);
+	bool is_mouse_in_area(float mouse_x, float mouse_y, FrameVector<Vec2f> const& boundingCoords);
 
 	std::vector<Vec2f> generate_outlines(std::vector<Vec2f> rectangle);
 
+	int simulate_headless(float seconds, std::size_t fleetSize);
+	int bench_mesh(std::size_t iterations);
+
+	Vec3f fleet_first_site();
+	float fleet_site_spacing();
+
+	void draw_fleet(GLStateCache& glState, GLuint shaderId, Vec3f lightDir,
+		MeshArena const& arena, MeshHandle const& mesh, InstanceBuffer const& instances,
+		std::vector<Vec3f> const& lightPositions, std::vector<Vec3f> const& lightColors, std::vector<Vec3f> const& vertPositions);
+	void draw_fleet_exhaust(GLStateCache& glState, GLuint exhaustShaderId, GLuint exhaustVao,
+		InstanceBuffer const& instances, float time, float pointScale);
+
+	bool has_gl_extension(char const* name);
+
 
 	struct GLFWCleanupHelper
 	{
@@ -139,8 +249,72 @@ namespace
 	};
 }
 
-int main() try
+int main( int aArgc, char* aArgv[] ) try
 {
+	//--simulate N flies the rocket for N seconds of simulated time without a
+	//window, as fast as possible. --fleet N starts in fleet mode with N rockets
+	//(with --simulate, the fleet is simulated too). --bench-mesh N times building
+	//the rocket mesh N times, with concatenate() and with a MeshBuilder. --pace picks
+	//vsync, adaptive or uncapped frames; --frame-limit FPS limits them on the CPU
+	float simulateSeconds = -1.f;
+	std::size_t fleetSize = 0;
+	std::size_t benchMeshIterations = 0;
+	PaceMode paceMode = PaceMode::vsync;
+	float frameLimit = 0.f;
+	for (int i = 1; i < aArgc; ++i) {
+		if (0 == std::strcmp(aArgv[i], "--simulate")) {
+			if (i + 1 >= aArgc)
+				throw Error("--simulate needs the number of seconds to simulate");
+			simulateSeconds = std::strtof(aArgv[++i], nullptr);
+			if (!(simulateSeconds >= 0.f))
+				throw Error("--simulate: expected a number of seconds, got '%s'", aArgv[i]);
+		}
+		else if (0 == std::strcmp(aArgv[i], "--bench-mesh")) {
+			if (i + 1 >= aArgc)
+				throw Error("--bench-mesh needs the number of iterations");
+			benchMeshIterations = std::strtoul(aArgv[++i], nullptr, 10);
+			if (0 == benchMeshIterations)
+				throw Error("--bench-mesh: expected a number of iterations, got '%s'", aArgv[i]);
+		}
+		else if (0 == std::strcmp(aArgv[i], "--fleet")) {
+			if (i + 1 >= aArgc)
+				throw Error("--fleet needs the number of rockets");
+			//strtoul() would wrap a negative count around
+			char const* const count = aArgv[++i];
+			char* end = nullptr;
+			fleetSize = std::strtoul(count, &end, 10);
+			if (std::strchr(count, '-') || end == count || '\0' != *end || 0 == fleetSize)
+				throw Error("--fleet: expected a number of rockets, got '%s'", count);
+		}
+		else if (0 == std::strcmp(aArgv[i], "--pace")) {
+			if (i + 1 >= aArgc)
+				throw Error("--pace needs a mode (vsync, adaptive or uncapped)");
+			++i;
+			if (0 == std::strcmp(aArgv[i], "vsync"))
+				paceMode = PaceMode::vsync;
+			else if (0 == std::strcmp(aArgv[i], "adaptive"))
+				paceMode = PaceMode::adaptive;
+			else if (0 == std::strcmp(aArgv[i], "uncapped"))
+				paceMode = PaceMode::uncapped;
+			else
+				throw Error("--pace: expected vsync, adaptive or uncapped, got '%s'", aArgv[i]);
+		}
+		else if (0 == std::strcmp(aArgv[i], "--frame-limit")) {
+			if (i + 1 >= aArgc)
+				throw Error("--frame-limit needs the number of frames per second");
+			frameLimit = std::strtof(aArgv[++i], nullptr);
+			if (!(frameLimit > 0.f))
+				throw Error("--frame-limit: expected a number of frames per second, got '%s'", aArgv[i]);
+			paceMode = PaceMode::limited;
+		}
+	}
+
+	if (simulateSeconds >= 0.f) {
+		return simulate_headless(simulateSeconds, fleetSize);
+	}
+	if (benchMeshIterations > 0) {
+		return bench_mesh(benchMeshIterations);
+	}
 
 	// Initialize GLFW
 	if( GLFW_TRUE != glfwInit() )
@@ -203,7 +377,14 @@ int main() try
 
 	// Set up drawing stuff
 	glfwMakeContextCurrent( window );
-	glfwSwapInterval( 1 ); // V-Sync is on.
+
+	//V-Sync is on by default. the limiter targets the display refresh unless a frame
+	//rate was given. T cycles through the modes
+	Clock::duration const refreshPeriod = display_refresh_period();
+	Clock::duration const targetFrameTime = frameLimit > 0.f
+		? std::chrono::duration_cast<Clock::duration>(Secondsf(1.f / frameLimit))
+		: refreshPeriod;
+	FramePacer framePacer(paceMode, refreshPeriod, targetFrameTime);
 
 	// Initialize GLAD
 	// This will load the OpenGL API. We mustn't make any OpenGL calls before this!
@@ -223,11 +404,15 @@ int main() try
 	// Global GL state
 	OGL_CHECKPOINT_ALWAYS();
 	//-----------------------------------------------------------------------
+	// binds, enables and uniforms go through the state cache, which skips
+	// calls that wouldn't change anything
+	GLStateCache glState;
+
 	// TODO: global GL setup goes here
 	glEnable(GL_FRAMEBUFFER_SRGB);
 	//glEnable(GL_CULL_FACE);
 	glClearColor(0.2f, 0.2f, 0.2f, 0.f);
-	glEnable(GL_DEPTH_TEST);
+	glState.enable(GL_DEPTH_TEST);
 
 
 	OGL_CHECKPOINT_ALWAYS();
@@ -239,30 +424,129 @@ int main() try
 	int iwidth, iheight;
 	glfwGetFramebufferSize( window, &iwidth, &iheight );
 
-	glViewport( 0, 0, iwidth, iheight );
+	glState.viewport( 0, 0, iwidth, iheight );
+
+	// Load shader programs. Linked programs are cached on disk, so that later
+	// starts (and reloads of unchanged shaders) skip compiling and linking.
+	// All programs are only submitted here and collected after the assets are
+	// loaded, so the driver can compile them in the background meanwhile.
+	ProgramBinaryCache shaderCache("shadercache");
+	bool const parallelShaders = ShaderProgram::enable_parallel_compile();
+	auto const shaderStart = Clock::now();
 
-	// Load shader program
 	ShaderProgram prog({
 		{ GL_VERTEX_SHADER, "assets/default.vert" },
 		{ GL_FRAGMENT_SHADER, "assets/default.frag" }
-	});
+	}, &shaderCache, ShaderProgram::Build::deferred);
 
+	// objects in the draw list read their transforms from a storage buffer
+	ShaderProgram colorShaderIndirect({
+		{ GL_VERTEX_SHADER, "assets/colorShaderIndirect.vert" },
+		{ GL_FRAGMENT_SHADER, "assets/colorShader.frag" }
+	}, &shaderCache, ShaderProgram::Build::deferred);
+
+	// repeated props (landing pads) are instanced, one transform per gl_InstanceID
+	ShaderProgram colorShaderInstanced({
+		{ GL_VERTEX_SHADER, "assets/colorShaderInstanced.vert" },
+		{ GL_FRAGMENT_SHADER, "assets/colorShader.frag" }
+	}, &shaderCache, ShaderProgram::Build::deferred);
+
+	// one model matrix uniform per draw, only used to compare against instancing
 	ShaderProgram colorShader({
 		{ GL_VERTEX_SHADER, "assets/colorShader.vert" },
 		{ GL_FRAGMENT_SHADER, "assets/colorShader.frag" }
-	});
+	}, &shaderCache, ShaderProgram::Build::deferred);
+
+	// split screen variants: the geometry shader draws every triangle into
+	// both viewports, so both views take a single pass
+	ShaderProgram progMultiview({
+		{ GL_VERTEX_SHADER, "assets/default.vert" },
+		{ GL_GEOMETRY_SHADER, "assets/multiviewTextured.geom" },
+		{ GL_FRAGMENT_SHADER, "assets/default.frag" }
+	}, &shaderCache, ShaderProgram::Build::deferred);
+
+	ShaderProgram colorShaderIndirectMultiview({
+		{ GL_VERTEX_SHADER, "assets/colorShaderIndirect.vert" },
+		{ GL_GEOMETRY_SHADER, "assets/multiview.geom" },
+		{ GL_FRAGMENT_SHADER, "assets/colorShader.frag" }
+	}, &shaderCache, ShaderProgram::Build::deferred);
+
+	ShaderProgram colorShaderInstancedMultiview({
+		{ GL_VERTEX_SHADER, "assets/colorShaderInstanced.vert" },
+		{ GL_GEOMETRY_SHADER, "assets/multiview.geom" },
+		{ GL_FRAGMENT_SHADER, "assets/colorShader.frag" }
+	}, &shaderCache, ShaderProgram::Build::deferred);
+
+	ShaderProgram colorShaderMultiview({
+		{ GL_VERTEX_SHADER, "assets/colorShader.vert" },
+		{ GL_GEOMETRY_SHADER, "assets/multiview.geom" },
+		{ GL_FRAGMENT_SHADER, "assets/colorShader.frag" }
+	}, &shaderCache, ShaderProgram::Build::deferred);
 
 	ShaderProgram particleShader({
 		{ GL_VERTEX_SHADER, "assets/particleShader.vert" },
 		{ GL_FRAGMENT_SHADER, "assets/particleShader.frag" }
-	});
+	}, &shaderCache, ShaderProgram::Build::deferred);
 
 	ShaderProgram uiShader({
 		{ GL_VERTEX_SHADER, "assets/uiShader.vert" },
 		{ GL_FRAGMENT_SHADER, "assets/uiShader.frag" }
-	});
+	}, &shaderCache, ShaderProgram::Build::deferred);
+
+	// fleet exhaust: points computed entirely in the vertex shader
+	ShaderProgram fleetExhaustShader({
+		{ GL_VERTEX_SHADER, "assets/fleetExhaust.vert" },
+		{ GL_FRAGMENT_SHADER, "assets/fleetExhaust.frag" }
+	}, &shaderCache, ShaderProgram::Build::deferred);
+
+	// depth pre-pass (Z): the same vertex shaders as the color shader draws,
+	// with a fragment shader that does nothing
+	ShaderProgram depthIndirect({
+		{ GL_VERTEX_SHADER, "assets/colorShaderIndirect.vert" },
+		{ GL_FRAGMENT_SHADER, "assets/depthOnly.frag" }
+	}, &shaderCache, ShaderProgram::Build::deferred);
+
+	ShaderProgram depthInstanced({
+		{ GL_VERTEX_SHADER, "assets/colorShaderInstanced.vert" },
+		{ GL_FRAGMENT_SHADER, "assets/depthOnly.frag" }
+	}, &shaderCache, ShaderProgram::Build::deferred);
+
+	ShaderProgram depthIndirectMultiview({
+		{ GL_VERTEX_SHADER, "assets/colorShaderIndirect.vert" },
+		{ GL_GEOMETRY_SHADER, "assets/multiview.geom" },
+		{ GL_FRAGMENT_SHADER, "assets/depthOnly.frag" }
+	}, &shaderCache, ShaderProgram::Build::deferred);
+
+	ShaderProgram depthInstancedMultiview({
+		{ GL_VERTEX_SHADER, "assets/colorShaderInstanced.vert" },
+		{ GL_GEOMETRY_SHADER, "assets/multiview.geom" },
+		{ GL_FRAGMENT_SHADER, "assets/depthOnly.frag" }
+	}, &shaderCache, ShaderProgram::Build::deferred);
+
+	// frustum culling for the draw list. If the compute shader isn't usable,
+	// culling falls back to the CPU.
+	std::optional<ShaderProgram> cullShader;
+	try
+	{
+		cullShader.emplace(std::vector<ShaderProgram::ShaderSource>{
+			{ GL_COMPUTE_SHADER, "assets/cullObjects.comp" }
+		}, &shaderCache, ShaderProgram::Build::deferred);
+	}
+	catch (std::exception const& eErr)
+	{
+		std::fprintf(stderr, "%s\nCulling draw list objects on the CPU.\n", eErr.what());
+		state.cpuCulling = true;
+	}
+
+	auto const shaderSubmitTime = std::chrono::duration_cast<Secondsf>(Clock::now() - shaderStart).count();
+
+	//data that changes every frame (view matrices, draw list, moving instances and
+	//the UI) is written to a ring buffer, so no buffer is reallocated per frame
+	StreamBuffer streamBuffer;
+
+	// projection-camera-world matrix of each view, shared by all scene shaders
+	ViewUniformBuffer viewUniforms(streamBuffer);
 
-	state.prog = &prog;
 	state.camControl.radius = 10.f;
 	state.camControl.x_move_speed = 0.f;
 	state.camControl.y_move_speed = 0.f;
@@ -274,52 +558,120 @@ int main() try
 	// Animation state
 	auto last = Clock::now();
 	// CREATE OBJECTS --------------------------------------------------------------------------------------------------------------------
+	//all static meshes share one vertex/index buffer
+	MeshArena meshArena;
+
 	//set up the the landmass 
-	auto mesh = load_wavefront_obj("assets/parlahti.obj");
 	auto tex = load_texture_2d("assets/L4343A-4k.jpeg");
-	auto mesh_vertex_count = mesh.positions.size();
-	GLuint vao = create_vao(mesh);
-
-	//set up landingpad 
-	auto landingpad = load_wavefront_obj("assets/landingpad.obj");
-	auto landingpad_vertex_count = landingpad.positions.size();
-	GLuint landingpad_vao = create_vao(landingpad);
-
-	//make spaceship
-	auto cuboid = make_cube({ 0.2f, 0.20f, 0.20f },make_translation({ 0.0f, 1.75f, 0.0f }) * make_scaling(0.5f, 3.0f, 0.5f));
-	auto pyramid = make_pyramid( { 0.2f, 0.20f, 0.20f }, make_translation({ 0.0f, 3.25, 0.0f }) * make_rotation_x(0.0f) * make_scaling(0.5f, 1.0f, 0.5f));
-	auto cylinder = make_cylinder(128, { 0.2f, 0.2f, 0.2f }, make_translation({ 0.0f, 0.0f, 0.0f }) * make_rotation_z(3.141592f / 2.f) * make_scaling(0.25f, 0.25f, 0.25f));
-	auto thruster1 = make_cylinder(128, { 0.2f, 0.2f, 0.2f }, make_translation({ 0.0f, 0.2f, 0.35f }) * make_rotation_z(3.141592f / 2.f) * make_scaling(0.5f, 0.12f, 0.12f));
-	auto thrusterCap1 = make_pyramid( { 0.2f, 0.20f, 0.20f }, make_translation({ 0.0f, 0.60f, 0.25f }) * make_rotation_x(0.0f) * make_scaling(0.5f, 1.0f, 0.5f));
-	auto thruster2 = make_cylinder(128, { 0.2f, 0.2f, 0.2f }, make_translation({ 0.0f, 0.2f, -0.35f }) * make_rotation_z(3.141592f / 2.f) * make_scaling(0.5f, 0.12f, 0.12f));
-	auto thrusterCap2 = make_pyramid( { 0.2f, 0.20f, 0.20f }, make_translation({ 0.0f, 0.60f, -0.25f }) * make_rotation_x(0.0f) * make_scaling(0.5f, 1.0f, 0.5f));
-	auto thruster3 = make_cylinder(128, { 0.2f, 0.2f, 0.2f }, make_translation({ 0.35f, 0.2f, 0.f }) * make_rotation_z(3.141592f / 2.f) * make_scaling(0.5f, 0.12f, 0.12f));
-	auto thrusterCap3 = make_pyramid( { 0.2f, 0.20f, 0.20f }, make_translation({ 0.25f, 0.60f, 0.f }) * make_rotation_x(0.0f) * make_scaling(0.5f, 1.0f, 0.5f));
-	auto thruster4 = make_cylinder(128, { 0.2f, 0.2f, 0.2f }, make_translation({ -0.35f, 0.2f, 0.f }) * make_rotation_z(3.141592f / 2.f) * make_scaling(0.5f, 0.12f, 0.12f));
-	auto thrusterCap4 = make_pyramid( { 0.2f, 0.2f, 0.2f }, make_translation({ -0.25f, 0.60f, 0.f }) * make_rotation_x(0.0f) * make_scaling(0.5f, 1.0f, 0.5f));
-
-	// concatenate
-	auto spaceship_top = concatenate(std::move(cuboid), std::move(pyramid));
-	auto spaceship_bottom = concatenate(std::move(cylinder), std::move(thruster1));
-	spaceship_bottom = concatenate(std::move(spaceship_bottom), std::move(thrusterCap1));
-	spaceship_bottom = concatenate(std::move(spaceship_bottom), std::move(thruster2));
-	spaceship_bottom = concatenate(std::move(spaceship_bottom), std::move(thrusterCap2));
-	spaceship_bottom = concatenate(std::move(spaceship_bottom), std::move(thruster3));
-	spaceship_bottom = concatenate(std::move(spaceship_bottom), std::move(thrusterCap3));
-	spaceship_bottom = concatenate(std::move(spaceship_bottom), std::move(thruster4));
-	spaceship_bottom = concatenate(std::move(spaceship_bottom), std::move(thrusterCap4));
-	auto spaceship = concatenate(std::move(spaceship_bottom), std::move(spaceship_top));
-
-	auto spaceship_vertex_count = spaceship.positions.size();
-	GLuint spaceship_vao = create_vao(spaceship);
+	MeshHandle landMassMesh = meshArena.add(load_wavefront_obj("assets/parlahti.obj"));
+
+	//set up landingpad, with levels of detail simplified from the full model
+	LodChain landingPadLods;
+	for (auto const& level : landing_pad_levels(load_wavefront_obj("assets/landingpad.obj"))) {
+		landingPadLods.add_level(meshArena.add(level.mesh), level.error);
+	}
+
+	//procedural shapes are generated once per distinct shape, and placed per object
+	MeshRegistry meshRegistry(meshArena);
+
+	//make spaceship, once per level of detail. the largest cylinder (radius 0.25) is
+	//the furthest from the round shape. the launch rocket is drawn part by part, the
+	//fleet from a merged copy per level (so it stays one instanced draw per level)
+	LodChain spaceshipLods;
+	std::vector<PlacedMesh> spaceshipParts[kMaxLodLevels_];
+	//normal matrices of the part placements, so that the rocket's own never needs a general inverse
+	std::vector<Mat44f> spaceshipPartNormals[kMaxLodLevels_];
+	for (std::size_t i = 0; i < sizeof(kSpaceshipLodSubdivs_) / sizeof(kSpaceshipLodSubdivs_[0]); ++i) {
+		std::size_t const subdivs = kSpaceshipLodSubdivs_[i];
+		float const error = 0.25f * (1.f - std::cos(kPi_ / float(subdivs)));
+		spaceshipParts[i] = spaceship_parts(meshRegistry, subdivs);
+		spaceshipLods.add_level(meshArena.add(meshRegistry.bake(spaceshipParts[i])), error);
+		for (auto const& part : spaceshipParts[i]) {
+			spaceshipPartNormals[i].emplace_back(normal_matrix(part.model2Object));
+		}
+	}
+
+	//all exhaust particles share one cube
+	MeshHandle const particleMesh = meshRegistry.cube({ 0.3f, 0.3f, 0.3f });
+
+	meshArena.upload();
+	std::printf("Procedural meshes: %zu distinct shapes for %zu requests\n",
+		meshRegistry.shape_count(), meshRegistry.request_count());
+
+	//per frame list of the objects drawn with the color shader
+	DrawList drawList(meshArena, glState, streamBuffer);
+
+	//collect the shader programs submitted above as the driver finishes them: ready()
+	//polls without waiting, and finish() is only called once a program is linked. until
+	//all are, the window shows the clear color. without parallel compilation, ready()
+	//is always true and this is the same as finishing them one by one. finish() throws
+	//on compile or link errors, same as building them right away
+	auto const shaderFinishStart = Clock::now();
+	ShaderProgram* const shaderPrograms[] = {
+		&prog, &colorShaderIndirect, &colorShaderInstanced, &colorShader,
+		&progMultiview, &colorShaderIndirectMultiview, &colorShaderInstancedMultiview, &colorShaderMultiview,
+		&particleShader, &uiShader, &fleetExhaustShader,
+		&depthIndirect, &depthInstanced, &depthIndirectMultiview, &depthInstancedMultiview
+	};
+	for (bool shadersPending = true; shadersPending; ) {
+		shadersPending = false;
+		for (auto* program : shaderPrograms) {
+			if (program->pending() && program->ready()) {
+				program->finish();
+			}
+			shadersPending = shadersPending || program->pending();
+		}
+
+		if (cullShader && cullShader->pending() && cullShader->ready()) {
+			try
+			{
+				cullShader->finish();
+			}
+			catch (std::exception const& eErr)
+			{
+				std::fprintf(stderr, "%s\nCulling draw list objects on the CPU.\n", eErr.what());
+				cullShader.reset();
+				state.cpuCulling = true;
+			}
+		}
+		shadersPending = shadersPending || (cullShader && cullShader->pending());
+
+		if (shadersPending) {
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
+	}
+
+	//cold start shader time: submitting, plus the wait that wasn't hidden behind asset loading.
+	//compare a run with an empty shadercache/ against a warm one
+	auto const shaderWaitTime = std::chrono::duration_cast<Secondsf>(Clock::now() - shaderFinishStart).count();
+	std::printf("Shader programs: %.1f ms submit + %.1f ms wait, %s (%zu from cache, %zu compiled, %zu rejected)\n",
+		shaderSubmitTime * 1000.f, shaderWaitTime * 1000.f, parallelShaders ? "parallel compile" : "serial compile",
+		shaderCache.stats().hits, shaderCache.stats().misses, shaderCache.stats().rejected);
+
+	//hot reload: files changed in assets/ are loaded in the background and swapped in
+	//at the start of the next frame
+	AssetReloader assetReloader("assets");
+	for (auto* program : shaderPrograms) {
+		assetReloader.watch_program(*program);
+	}
+	if (cullShader) {
+		assetReloader.watch_program(*cullShader);
+	}
+	assetReloader.watch_texture("assets/L4343A-4k.jpeg", tex);
+	assetReloader.watch_mesh("assets/parlahti.obj", meshArena, landMassMesh);
+	//the pad's levels of detail are simplified again on the watcher thread
+	assetReloader.watch_mesh("assets/landingpad.obj", meshArena, landingPadLods, landing_pad_levels);
 
 	//get light values for spacehip + landingpad
+	//these are world positions; the state holds them relative to the render origin
 	state.lightPositions = get_lightpositions();
 	state.lightColors = get_lightcolors();
-	state.vertPositions = get_vertpositions();
+	std::vector<Vec3f> const worldVertPositions = get_vertpositions();
+	state.vertPositions = worldVertPositions;
 	std::vector<Particle> listofParticles;
 	
-	std::vector<GLuint> particleVAOList;
 	std::vector<Vec3f> particleMovement;
 	unsigned int noOfParticles = 80;
 	
@@ -338,13 +690,12 @@ int main() try
 	for (unsigned int i = 0; i < noOfParticles; ++i) {
 		//create one particles
 		Particle particles = createParticles(make_translation(particleMovement[i])*make_scaling(0.05f, 0.05f, 0.05f));
-
-		GLuint getvao = create_vao(particles.particledraw);
-		particleVAOList.push_back(getvao);
 		listofParticles.push_back(particles);
 	
 	}
-	auto particle_vertexCount = static_cast<int>(listofParticles[0].particledraw.positions.size());
+
+	//the particles are drawn instanced, from transforms streamed every frame
+	InstanceBuffer particleInstances(glState, streamBuffer);
 
 
 	//FOR LOOK AT
@@ -365,19 +716,65 @@ int main() try
 	float yaw2 = -90.f;
 	float pitch2 = 0.f;
 
-	//so we dont do big jump initially in camera position
-	bool firstMouse = true;
-	bool firstMouse2 = true;
-
-	float animation_time = 0.f; 
-	Mat44f spaceship_flight = make_translation(Vec3f{ 0.f, 0.f, 0.f });
-
 	const int numLandingPads = 2;
 	Vec3f secondLandingpadTranslation = Vec3f{ 15.f, -0.95f, -10.f };
 	Mat44f landingPadTranslation[numLandingPads] = { make_translation(Vec3f{-20.f, -0.95f, -30.f}),
 									 make_translation(secondLandingpadTranslation) };
 	//because the spaceship is also same translation as second landing pad
-	state.vecSpaceshipTranslation = secondLandingpadTranslation;
+	state.vecSpaceshipTranslation = to_vec3d(secondLandingpadTranslation);
+
+	//the flight and its particles run in fixed steps on their own thread, independent
+	//of the frame rate. the lights on the rocket move along with it
+	LaunchThread launch(secondLandingpadTranslation, std::move(listofParticles));
+	std::vector<Vec3f> const rocketLightPositions = get_lightpositions();
+
+	//the same flight, precomputed, for looking up positions at other times
+	Trajectory launchTrajectory(secondLandingpadTranslation);
+
+	//the flight is tracked in double precision. everything is drawn relative to an
+	//origin near the camera, so that the rocket doesn't jitter far from the pads
+	RenderOrigin renderOrigin;
+
+	//fleet mode: the fleet is only created when first enabled. its rockets are
+	//drawn instanced, and their exhaust needs no vertex data (but a VAO)
+	state.fleet = fleetSize > 0;
+	state.lod = true;
+	if (0 == fleetSize) {
+		fleetSize = kDefaultFleetSize_;
+	}
+	std::optional<RocketFleet> fleet;
+	InstanceBuffer fleetInstances(glState, streamBuffer);
+	//the rockets again, sorted by level of detail
+	std::vector<Mat44f> fleetLodTransforms[kMaxLodLevels_];
+	InstanceBuffer fleetLodInstances[kMaxLodLevels_] = {
+		InstanceBuffer(glState, streamBuffer), InstanceBuffer(glState, streamBuffer), InstanceBuffer(glState, streamBuffer),
+		InstanceBuffer(glState, streamBuffer), InstanceBuffer(glState, streamBuffer)
+	};
+	float fleetTime = 0.f;
+	double fleetUpdateSeconds = 0.0;
+	std::size_t fleetUpdates = 0;
+
+	GLuint exhaustVao = 0;
+	glGenVertexArrays(1, &exhaustVao);
+
+	//the pads are static, so their transforms are only uploaded when the set of pads changes
+	//or the render origin moves. the world space list only changes with the set of pads
+	std::vector<Mat44f> worldLandingPads;
+	std::vector<Mat44f> landingPads;
+	InstanceBuffer landingPadInstances(glState);
+	state.padsChanged = true;
+
+	//the pads by level of detail. sorted again only when the views or the pads change
+	std::vector<Mat44f> padLodTransforms[kMaxLodLevels_];
+	InstanceBuffer padLodInstances[kMaxLodLevels_] = {
+		InstanceBuffer(glState), InstanceBuffer(glState), InstanceBuffer(glState), InstanceBuffer(glState), InstanceBuffer(glState)
+	};
+	Mat44f padLodViews[2] = { kIdentity44f, kIdentity44f };
+	std::size_t padLodViewCount = 0;
+	std::size_t spaceshipLod = 0;
+
+	//scratch memory for a single frame, reset at the start of every frame
+	FrameArena frameArena;
 
 	//MAKE RECTANGLE FOR UI
 	std::vector<Vec2f> buttonReset{};
@@ -391,7 +788,6 @@ int main() try
 
 	std::vector<Vec2f> buttonResetOutlines = generate_outlines(buttonReset);
 
-	std::vector<Vec2f> resetButtonBoundingBox{};
 
 	std::vector<Vec2f> buttonLaunch{};
 	buttonLaunch.push_back(Vec2f{ -0.3f, -0.7f }); //tl
@@ -404,15 +800,11 @@ int main() try
 
 	std::vector<Vec2f> outlines = generate_outlines(buttonLaunch);
 
-	std::vector<Vec2f> launchButtonBoundingBox{};
-	//we need to put this in main loop eventually to handle change of screen size
+	auto launchButtonOutlineVao = create_rectangle_vao(glState, frameArena, outlines, Vec4f{0.f, 1.f, 0.f, 1.f});
+	auto resetButtonOutlineVao = create_rectangle_vao(glState, frameArena, buttonResetOutlines, Vec4f{0.f, 1.f, 0.f, 1.f});
 
-
-	auto launchButtonOutlineVao = create_rectangle_vao(outlines, Vec4f{0.f, 1.f, 0.f, 1.f});
-	auto launchButtonVao = create_rectangle_vao(buttonLaunch, Vec4f{1.f, 0.f, 0.f, 0.5f});
-
-	auto resetButtonOutlineVao = create_rectangle_vao(buttonResetOutlines, Vec4f{0.f, 1.f, 0.f, 1.f});
-	auto resetButtonVao = create_rectangle_vao(buttonReset, Vec4f{0.f, 0.f, 1.f, 0.5f});
+	//the buttons change color with the mouse, so they are streamed every frame
+	GLuint const buttonVao = create_stream_rectangle_vao(glState);
 
 	// create query struct
 	struct QueryPerformance {
@@ -426,49 +818,161 @@ int main() try
 	};
 
 	//create query objects
-	QueryPerformance FullRender, basicRendering, instancing, customModel, view1, view2;
-
-	// initialise query for full rendering.
-	GLuint startFrameQuery, endFrameQuery;
-	glGenQueries(1, &startFrameQuery);
-	glGenQueries(1, &endFrameQuery);
-
-	//Initialize timer query for rendering basics.
-	GLuint startBasicQuery, endBasicQuery;
-	glGenQueries(1, &startBasicQuery);
-	glGenQueries(1, &endBasicQuery);
-
-	// Initialize timer query for Instancing
-	GLuint startInstancingQuery, endInstancingQuery;
-	glGenQueries(1, &startInstancingQuery);
-	glGenQueries(1, &endInstancingQuery);
-
-	// Initialize timer query for custom model
-	GLuint startCustomModelQuery, endCustomModelQuery;
-	glGenQueries(1, &startCustomModelQuery);
-	glGenQueries(1, &endCustomModelQuery);
-
-	// Initialize timer query for viewports
-	GLuint startView1Query, endView1Query, startView2Query, endView2Query;
-	glGenQueries(1, &startView1Query);
-	glGenQueries(1, &endView1Query);
-	glGenQueries(1, &startView2Query);
-	glGenQueries(1, &endView2Query);
-	int view1Time = 0;
+	QueryPerformance FullRender, basicRendering, instancing, sceneObjects, view1, view2, fleetRender;
+	//which of the above each kind of queued draw counts towards (particles aren't timed)
+	QueryPerformance* const drawTimers[std::size_t(SceneDraw_::count)] = {
+		&basicRendering, &instancing, &sceneObjects, &fleetRender, nullptr, &fleetRender
+	};
+
+	// Initialize the GPU queries, one set per frame in flight.
+	// The full frame and the views are timed with timestamps. view1 times the scene
+	// with one view, view2 with both views (split screen).
+	// The queued draws are sorted by depth, so e.g. the levels of detail of the landing
+	// pads need not come one after another. Each draw gets its own query, and the
+	// results are added up per kind: the land mass (basic rendering), the landing pads
+	// (instancing), the draw list (spaceship) and the fleet (rockets and exhaust)
+	struct FrameQuerySet {
+		GLuint startFrame = 0, endFrame = 0;
+		GLuint startViews = 0, endViews = 0;
+		bool issued = false;
+		bool splitscreen = false;
+
+		GLuint timers[kMaxTimedDraws_];
+		SceneDraw_ kinds[kMaxTimedDraws_];
+		std::size_t count = 0;
+
+		GLuint fragments = 0;
+		bool fragmentsIssued = false;
+		bool depthPrepass = false;
+	};
+	FrameQuerySet frameQuerySets[kQueryFrames_];
+	for (auto& querySet : frameQuerySets) {
+		glGenQueries(1, &querySet.startFrame);
+		glGenQueries(1, &querySet.endFrame);
+		glGenQueries(1, &querySet.startViews);
+		glGenQueries(1, &querySet.endViews);
+		glGenQueries(GLsizei(kMaxTimedDraws_), querySet.timers);
+	}
+	std::size_t queryFrame = 0;
+
+	// Fragment shader invocations of the scene, with and without the depth pre-pass.
+	// Pipeline statistics are core in OpenGL 4.6 and an extension before
+	bool const fragmentQueries = GLAD_GL_VERSION_4_6 || has_gl_extension("GL_ARB_pipeline_statistics_query");
+	if (fragmentQueries) {
+		for (auto& querySet : frameQuerySets) {
+			glGenQueries(1, &querySet.fragments);
+		}
+	}
+	GLuint64 fragmentInvocations[2] = { 0, 0 }; //without, with the pre-pass
+	std::size_t fragmentFrames[2] = { 0, 0 };
+	std::size_t lateFrameQueries = 0;
+
+	//add the results of a set of queries to the timers and counters. if the GPU hasn't
+	//got to them yet, they are dropped rather than waited for
+	auto const collect_frame_queries = [&](FrameQuerySet& querySet) {
+		if (!querySet.issued) {
+			return;
+		}
+
+		auto const available = [](GLuint query) {
+			GLuint ready = GL_FALSE;
+			glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &ready);
+			return GL_FALSE != ready;
+		};
+		//the end of the frame comes last, but the draw queries are checked as well, in
+		//case the driver makes results available out of order
+		bool ready = available(querySet.endFrame) && available(querySet.startFrame) &&
+			available(querySet.endViews) && available(querySet.startViews);
+		for (std::size_t i = 0; i < querySet.count && ready; ++i) {
+			ready = available(querySet.timers[i]);
+		}
+		if (ready && querySet.fragmentsIssued) {
+			ready = available(querySet.fragments);
+		}
+
+		if (!ready) {
+			++lateFrameQueries;
+		}
+		else {
+			GLuint64 startTime = 0, endTime = 0;
+			glGetQueryObjectui64v(querySet.startFrame, GL_QUERY_RESULT, &startTime);
+			glGetQueryObjectui64v(querySet.endFrame, GL_QUERY_RESULT, &endTime);
+			FullRender.duration = endTime - startTime;
+			FullRender.resultReady = true;
+
+			glGetQueryObjectui64v(querySet.startViews, GL_QUERY_RESULT, &startTime);
+			glGetQueryObjectui64v(querySet.endViews, GL_QUERY_RESULT, &endTime);
+			QueryPerformance& viewsTimer = querySet.splitscreen ? view2 : view1;
+			viewsTimer.duration = endTime - startTime;
+			viewsTimer.resultReady = true;
+
+			//kinds that weren't drawn keep their last result
+			for (std::size_t i = 0; i < querySet.count; ++i) {
+				drawTimers[std::size_t(querySet.kinds[i])]->duration = 0;
+			}
+			for (std::size_t i = 0; i < querySet.count; ++i) {
+				GLuint64 elapsed = 0;
+				glGetQueryObjectui64v(querySet.timers[i], GL_QUERY_RESULT, &elapsed);
+				QueryPerformance& timer = *drawTimers[std::size_t(querySet.kinds[i])];
+				timer.duration += elapsed;
+				timer.resultReady = true;
+			}
+
+			if (querySet.fragmentsIssued) {
+				GLuint64 invocations = 0;
+				glGetQueryObjectui64v(querySet.fragments, GL_QUERY_RESULT, &invocations);
+				fragmentInvocations[querySet.depthPrepass ? 1 : 0] += invocations;
+				++fragmentFrames[querySet.depthPrepass ? 1 : 0];
+			}
+		}
+
+		querySet.issued = false;
+		querySet.count = 0;
+		querySet.fragmentsIssued = false;
+	};
+
+	//opaque draws front to back, then the transparent ones back to front
+	RenderQueue renderQueue;
+
+	std::size_t frameCount = 0;
 
 	//start frame to frame variable.
 	auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - last);
 
 	while( !glfwWindowShouldClose( window ) )
 	{
-		// Start full frame query
-		glQueryCounter(startFrameQuery, GL_TIMESTAMP);
+		//scratch memory from the previous frame is no longer in use. the stream buffer
+		//waits until the GPU has read the region it is going to overwrite
+		frameArena.reset();
+		streamBuffer.begin_frame();
+
+		//in debug builds, check that frames which only redraw do not allocate. frames
+		//that react to input or reload assets may, e.g. to create the fleet. only the
+		//render thread's allocations are counted
+		std::size_t const frameHeapAllocations = heap_allocation_count();
+		std::size_t const frameInputEvents = state.inputEvents;
+		// Start full frame query. this frame's queries are read two frames later
+		FrameQuerySet& frameQueries = frameQuerySets[queryFrame % kQueryFrames_];
+		frameQueries.issued = true;
+		glQueryCounter(frameQueries.startFrame, GL_TIMESTAMP);
 
 		//start timer.
 		auto start = std::chrono::high_resolution_clock::now();
 
 		// Let GLFW process events
 		glfwPollEvents();
+
+		//swap in assets that changed on disk (or all shaders after R). They were
+		//already read on the watcher thread
+		if (state.reloadShaders) {
+			assetReloader.request_shaders();
+			state.reloadShaders = false;
+		}
+		std::size_t const assetsReloaded = assetReloader.apply(glState);
+		if (assetsReloaded > 0) {
+			//a reloaded pad comes with new level of detail errors
+			padLodViewCount = 0;
+		}
 		
 		// Check if window was resized.
 		float fbwidth, fbheight;
@@ -490,13 +994,8 @@ int main() try
 				} while( 0 == nwidth || 0 == nheight );
 			}
 
-			if (state.splitscreen) {
-				//the other view port that makes up the splitscreen is at the bottom of the main loop 
-				glViewport( 0, 0, static_cast<GLsizei>(nwidth / 2.f), static_cast<GLsizei>(nheight));
-			}
-			else {
-				glViewport( 0, 0, nwidth, nheight );
-			}
+			//the split screen viewports are set up together with the views below
+			glState.viewport( 0, 0, nwidth, nheight );
 		}
 
 		//we need to put this in main loop eventually to handle change of screen size
@@ -505,346 +1004,508 @@ int main() try
 		Vec2f bl = translate_2d_to_xy(buttonReset[1].x, buttonReset[1].y, fbwidth, fbheight);
 		Vec2f br = translate_2d_to_xy(buttonReset[2].x, buttonReset[2].y, fbwidth, fbheight);
 
-		resetButtonBoundingBox.clear();
-		resetButtonBoundingBox.push_back(tl);
-		resetButtonBoundingBox.push_back(tr);
-		resetButtonBoundingBox.push_back(bl);
-		resetButtonBoundingBox.push_back(br);
+		FrameVector<Vec2f> const resetButtonBoundingBox({ tl, tr, bl, br }, ArenaAllocator<Vec2f>(frameArena));
 
 		tl = translate_2d_to_xy(buttonLaunch[0].x, buttonLaunch[0].y, fbwidth, fbheight);
 		tr = translate_2d_to_xy(buttonLaunch[4].x, buttonLaunch[4].y, fbwidth, fbheight);
 		bl = translate_2d_to_xy(buttonLaunch[1].x, buttonLaunch[1].y, fbwidth, fbheight);
 		br = translate_2d_to_xy(buttonLaunch[2].x, buttonLaunch[2].y, fbwidth, fbheight);
 
-		launchButtonBoundingBox.clear();
-		launchButtonBoundingBox.push_back(tl);
-		launchButtonBoundingBox.push_back(tr);
-		launchButtonBoundingBox.push_back(bl);
-		launchButtonBoundingBox.push_back(br);
+		FrameVector<Vec2f> const launchButtonBoundingBox({ tl, tr, bl, br }, ArenaAllocator<Vec2f>(frameArena));
 
 		auto const now = Clock::now();
 		//delta time means speed can be framerate independant
 		float dt = std::chrono::duration_cast<Secondsf>(now - last).count();
 		last = now;
 
-		float xDiff = state.camControl.currentX - state.camControl.lastX;
-		float yDiff = state.camControl.lastY - state.camControl.currentY;
+		//ADVANCE THE LAUNCH----------------------------------------------------------------------
+		//the rocket sits on its pad until launched. the launch thread steps the flight and
+		//the particles; here we only pick up its latest frame and blend its last two steps
+		launch.set_active(state.camControl.animationActive);
+		LaunchFrame const& launchFrame = launch.latest();
 
+		LaunchState const launchState = interpolate(launchFrame, now);
+		Vec3d const launchOffset = launchState.position - to_vec3d(launch.launch_position());
+		state.vecSpaceshipTranslation = launchState.position;
 
-		state.camControl.lastX = state.camControl.currentX;
-		state.camControl.lastY = state.camControl.currentY;
+		//where the tracking cameras look: a bit ahead of the rocket, so they turn into
+		//the flight instead of lagging behind it
+		Vec3d cameraTarget = launchState.position;
+		if (state.camControl.animationActive) {
+			Vec3f ahead = to_vec3f(launchTrajectory.sample(launchState.time + kCameraLookAhead_).position - launchState.position);
+			float const aheadLength = length(ahead);
+			if (aheadLength > kCameraMaxLookAhead_) {
+				ahead = ahead * (kCameraMaxLookAhead_ / aheadLength);
+			}
+			cameraTarget = launchState.position + to_vec3d(ahead);
+		}
 
 		bool inLaunchBtnArea = is_mouse_in_area(state.camControl.currentX, state.camControl.currentY, launchButtonBoundingBox);
 		bool inResetBtnArea = is_mouse_in_area(state.camControl.currentX, state.camControl.currentY, resetButtonBoundingBox);
 
-		//two camera values due to splitscreen 
+		//two camera values due to splitscreen. the keys move the camera here, along where
+		//it looked last frame; where it looks now is sampled late, before the views are set up
 		if (!state.switchscreen) {
-			auto cameraVals = get_camera_values(state, movementSpeed, dt, cameraPos, cameraFront, cameraUp, xDiff, yDiff, yaw, pitch, firstMouse);
+			auto cameraVals = get_camera_values(state, movementSpeed, dt, cameraPos, cameraFront, cameraUp);
 			movementSpeed = cameraVals.movementSpeed;
-			cameraFront = cameraVals.cameraFront;
-			cameraUp = cameraVals.cameraUp;
 			cameraPos = cameraVals.cameraPos;
-			yaw = cameraVals.yaw;
-			pitch = cameraVals.pitch;
-			firstMouse = cameraVals.firstMouse;
 		}
 		else {
-			auto cameraVals = get_camera_values(state, movementSpeed2, dt, cameraPos2, cameraFront2, cameraUp2, xDiff, yDiff, yaw2, pitch2, firstMouse2);
+			auto cameraVals = get_camera_values(state, movementSpeed2, dt, cameraPos2, cameraFront2, cameraUp2);
 			movementSpeed2 = cameraVals.movementSpeed;
-			cameraFront2 = cameraVals.cameraFront;
-			cameraUp2 = cameraVals.cameraUp;
 			cameraPos2 = cameraVals.cameraPos;
-			yaw2 = cameraVals.yaw;
-			pitch2 = cameraVals.pitch;
-			firstMouse2 = cameraVals.firstMouse;
 		}
 
-		//the matrix that governs where we are looking. replaces the world2camera matrix from exercises
-		Mat44f LookAt = lookAt(cameraPos, cameraPos + cameraFront);
-
-		float viewportProjectionChange = state.splitscreen ? 2.f : 1.f;
-		Mat44f projection = make_perspective_projection(60.f * 3.1415926f / 180.f,
-			(fbwidth/viewportProjectionChange) / float(fbheight),
-			0.1f, 100.0f
-		);
-
+		//the eye of the first view decides where the render origin goes. when it moves,
+		//the static pads are rebased below
+		bool padsRebased = false;
+		Vec3d eye = to_vec3d(cameraPos);
 		if (state.cameraMode == State_::cameraTracking::cameraTrackGround) {
-			Vec3f groundCameraPos = { -10.f, 0.1f, -20.f };
-			LookAt = lookAt(groundCameraPos, state.vecSpaceshipTranslation);
+			eye = kGroundCameraPos_;
 		}
 		else if (state.cameraMode == State_::cameraTracking::cameraTrackFollow) {
-			Vec3f followCameraPos = state.vecSpaceshipTranslation;
-			followCameraPos.y += 3.f;
-			followCameraPos.z += 30.f;
-			LookAt = lookAt(followCameraPos, state.vecSpaceshipTranslation);
+			eye = state.vecSpaceshipTranslation + kFollowCameraOffset_;
+		}
+		if (renderOrigin.update(eye)) {
+			padsRebased = true;
 		}
 
-		Mat44f projCameraWorld = projection * LookAt;
-
-
-		// Draw scene
-		OGL_CHECKPOINT_DEBUG();
-		//---------------------------------------------------------------------------------------------------
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // combingig both tells open gl to clear the color and depth buffer in one go
-
-		//used by all drawn obejcts
-		Mat33f normalMatrix = mat44_to_mat33(transpose(invert(kIdentity44f)));
-
-		//query for viewport 1
-		glQueryCounter(startView1Query, GL_TIMESTAMP);
-		//SETUP FOR THE LANDMASS--------------------------------------------------------------------
-
-		//query for basic rendering
-		glQueryCounter(startBasicQuery, GL_TIMESTAMP);
+		//from here on, positions are relative to the render origin
+		for (std::size_t i = 0; i < rocketLightPositions.size(); ++i) {
+			state.lightPositions[i] = renderOrigin.to_local(to_vec3d(rocketLightPositions[i]) + launchOffset);
+		}
+		for (std::size_t i = 0; i < worldVertPositions.size(); ++i) {
+			state.vertPositions[i] = renderOrigin.to_local(worldVertPositions[i]);
+		}
+		Vec3f const localCameraTarget = renderOrigin.to_local(cameraTarget);
 
-		Vec3f lightDir = normalize(Vec3f{ 0.f, 1.f, -1.f });
-		draw_land_mass(prog.programId(), projCameraWorld, normalMatrix, lightDir, tex, vao, static_cast<int>(mesh_vertex_count));
+		//SETUP FOR THE SPACESHIP-----------------------------------------------------------------
+		//in flight, the rocket is drawn between the last two simulation steps
+		Transform spaceship{ kIdentityQuatf, renderOrigin.to_local(secondLandingpadTranslation), 1.f };
+		if (state.camControl.animationActive) {
+			spaceship = launch_transform(launchState, renderOrigin.origin());
+		}
+		Mat44f const spaceship_translation = to_mat44(spaceship);
+
+		//UPDATE THE LANDING PADS------------------------------------------------------------------
+		//P toggles the spaceport, which adds a large grid of pads. an origin move only rebases
+		//the pads into the existing storage, so that it doesn't allocate
+		if (state.padsChanged) {
+			worldLandingPads.assign(landingPadTranslation, landingPadTranslation + numLandingPads);
+			if (state.spaceport) {
+				add_spaceport_pads(worldLandingPads);
+			}
+			landingPads.resize(worldLandingPads.size());
+			for (std::size_t i = 0; i < landingPadLods.level_count(); ++i) {
+				padLodTransforms[i].reserve(landingPads.size());
+				padLodInstances[i].reserve(landingPads.size());
+			}
+			state.padsChanged = false;
+			padsRebased = true;
+		}
+		if (padsRebased) {
+			renderOrigin.to_local(worldLandingPads.data(), worldLandingPads.size(), landingPads.data());
+			landingPadInstances.assign(landingPads);
+			padLodViewCount = 0;
+		}
 
-		glQueryCounter(endBasicQuery, GL_TIMESTAMP);
+		//UPDATE THE FLEET-------------------------------------------------------------------------
+		if (state.fleet) {
+			if (!fleet) {
+				fleet.emplace(launchTrajectory, fleetSize, fleet_first_site(), fleet_site_spacing());
+				//any number of rockets can end up at one level of detail
+				for (std::size_t i = 0; i < spaceshipLods.level_count(); ++i) {
+					fleetLodTransforms[i].reserve(fleet->size());
+					fleetLodInstances[i].reserve(fleet->size());
+				}
+				std::fprintf(stderr, "Fleet of %zu rockets, updated on %zu threads.\n", fleet->size(), fleet->thread_count());
+			}
 
-		// Retrieve results for the frame timing
-		GLuint64 startBasicTime, endBasicTime;
-		glGetQueryObjectui64v(startBasicQuery, GL_QUERY_RESULT, &startBasicTime);
-		glGetQueryObjectui64v(endBasicQuery, GL_QUERY_RESULT, &endBasicTime);
+			fleetTime += dt;
+			auto const fleetStart = Clock::now();
+			fleet->update(fleetTime, renderOrigin.origin());
+			fleetUpdateSeconds += std::chrono::duration_cast<Secondsf>(Clock::now() - fleetStart).count();
+			++fleetUpdates;
 
-		// Calculate the frame rendering time
-		GLuint64 basicDuration = endBasicTime - startBasicTime;
+			fleetInstances.assign_rigid(fleet->transforms());
+		}
 
-		// Output the duration or store it for later use
-		basicRendering.duration = basicDuration;
-		basicRendering.resultReady = true;
+		//SAMPLE THE MOUSE LOOK-------------------------------------------------------------------
+		//as late as possible, so the views use the newest cursor position rather than the one
+		//from the start of the frame. the mouse only turns the camera while it is active
+		CursorSample cameraInput{};
+		if (state.camControl.cameraActive) {
+			cameraInput = state.input.sample(window);
+			if (!state.switchscreen) {
+				auto const look = get_camera_look(cameraInput.dx, -cameraInput.dy, yaw, pitch);
+				cameraFront = look.cameraFront;
+				yaw = look.yaw;
+				pitch = look.pitch;
+			}
+			else {
+				auto const look = get_camera_look(cameraInput.dx, -cameraInput.dy, yaw2, pitch2);
+				cameraFront2 = look.cameraFront;
+				yaw2 = look.yaw;
+				pitch2 = look.pitch;
+			}
+		}
+		else {
+			state.input.discard(window);
+		}
 
-		//SETUP FOR THE LANDING PAD-----------------------------------------------------------------
+		//the matrix that governs where we are looking. replaces the world2camera matrix from exercises
+		Vec3f const localEye = renderOrigin.to_local(eye);
+		Mat44f LookAt = lookAt(localEye, localEye + cameraFront);
+		if (state.cameraMode != State_::cameraTracking::cameraNormal) {
+			LookAt = lookAt(localEye, localCameraTarget);
+		}
 
-		//query for instancing.
-		glQueryCounter(startInstancingQuery, GL_TIMESTAMP);
+		float viewportProjectionChange = state.splitscreen ? 2.f : 1.f;
+		Mat44f projection = make_perspective_projection(60.f * 3.1415926f / 180.f,
+			(fbwidth/viewportProjectionChange) / float(fbheight),
+			0.1f, 100.0f
+		);
 
-		draw_landing_pad(colorShader.programId(), projection, LookAt, landingPadTranslation, numLandingPads, normalMatrix, lightDir, landingpad_vao, static_cast<int>(landingpad_vertex_count),
-			state.lightPositions, state.lightColors, state.vertPositions);
+		Mat44f projCameraWorld = projection * LookAt;
 
-		// End timing after instanced rendering
-		glQueryCounter(endInstancingQuery, GL_TIMESTAMP);
+		//SETUP THE VIEWS-------------------------------------------------------------------------
+		//split screen draws both views in a single pass. The multiview programs emit every
+		//triangle once per view, into viewport 0 (left half) and viewport 1 (right half)
+		Mat44f projCameraWorld2 = projCameraWorld;
+		if (state.splitscreen) {
+			Vec3f const localCameraPos2 = renderOrigin.to_local(cameraPos2);
+			Mat44f LookAt2 = lookAt(localCameraPos2, localCameraPos2 + cameraFront2);
 
-		// Retrieve results for the frame timing
-		GLuint64 startInstancingTime, endInstancingTime;
-		glGetQueryObjectui64v(startInstancingQuery, GL_QUERY_RESULT, &startInstancingTime);
-		glGetQueryObjectui64v(endInstancingQuery, GL_QUERY_RESULT, &endInstancingTime);
+			if (state.cameraMode2 == State_::cameraTracking::cameraTrackGround) {
+				LookAt2 = lookAt(renderOrigin.to_local(kGroundCameraPos_), localCameraTarget);
+			}
+			else if (state.cameraMode2 == State_::cameraTracking::cameraTrackFollow) {
+				LookAt2 = lookAt(renderOrigin.to_local(state.vecSpaceshipTranslation + kFollowCameraOffset_), localCameraTarget);
+			}
 
-		GLuint64 durationInstancing = endInstancingTime - startInstancingTime;
+			projCameraWorld2 = projection * LookAt2;
 
-		//output for Instancing
-		instancing.duration = durationInstancing;
-		instancing.resultReady = true;
+			glState.viewport_indexed(0, 0.f, 0.f, fbwidth / 2.f, fbheight);
+			glState.viewport_indexed(1, fbwidth / 2.f, 0.f, fbwidth / 2.f, fbheight);
+		}
 
-		// end of view port 1
-		GLuint64 startView1Time, endView1Time;
+		viewUniforms.set(0, projCameraWorld);
+		viewUniforms.set(1, projCameraWorld2);
+		viewUniforms.upload();
+
+		Mat44f const views[] = { projCameraWorld, projCameraWorld2 };
+		std::size_t const viewCount = state.splitscreen ? 2 : 1;
+
+		//SELECT THE LEVELS OF DETAIL--------------------------------------------------------------
+		//pixels per unit of size at distance 1. each object gets the coarsest level whose
+		//error stays below a pixel in the view where it is largest
+		float const pixelScale = projection(1, 1) * fbheight * 0.5f;
+
+		spaceshipLod = state.lod ? select_lod(spaceshipLods, spaceship_translation, views, viewCount, pixelScale) : 0;
+
+		if (state.lod && !state.padsPerDrawLoop) {
+			bool const viewsChanged = viewCount != padLodViewCount ||
+				0 != std::memcmp(views, padLodViews, viewCount * sizeof(Mat44f));
+			if (viewsChanged) {
+				select_instance_lods(landingPadLods, landingPads, views, viewCount, pixelScale, padLodTransforms);
+				for (std::size_t i = 0; i < landingPadLods.level_count(); ++i) {
+					//front to back within each draw as well, for early-Z
+					sort_front_to_back(padLodTransforms[i], LookAt);
+					padLodInstances[i].assign(padLodTransforms[i]);
+				}
+				std::copy(views, views + viewCount, padLodViews);
+				padLodViewCount = viewCount;
+			}
+		}
+		else {
+			padLodViewCount = 0;
+		}
 
-		glGetQueryObjectui64v(startView1Query, GL_QUERY_RESULT, &startView1Time);
-		glGetQueryObjectui64v(endView1Query, GL_QUERY_RESULT, &endView1Time);
+		if (state.fleet && state.lod) {
+			select_instance_lods(spaceshipLods, fleet->transforms(), views, viewCount, pixelScale, fleetLodTransforms);
+			for (std::size_t i = 0; i < spaceshipLods.level_count(); ++i) {
+				fleetLodInstances[i].assign_rigid(fleetLodTransforms[i]);
+			}
+		}
 
-		//output for viewports
-		view1Time = startView1Time - endView1Time;
-		view1Time = std::abs((view1Time / 10000));
-		GLuint64 durationView1;
-		durationView1 = startView1Time - endView1Time;
-		view1.resultReady = true;
-		
-		//SETUP FOR THE SPACESHIP-----------------------------------------------------------------
-		Mat44f spaceship_translation = landingPadTranslation[1];
-		
-		// Define the duration of one loop of the animation in seconds.
-		const float loop_duration = 10.0f; // Adjust this value as needed.
+		GLuint const landMassProgram = state.splitscreen ? progMultiview.programId() : prog.programId();
+		GLuint const padsProgram = state.splitscreen ? colorShaderInstancedMultiview.programId() : colorShaderInstanced.programId();
+		GLuint const padsLoopProgram = state.splitscreen ? colorShaderMultiview.programId() : colorShader.programId();
+		GLuint const sceneObjectsProgram = state.splitscreen ? colorShaderIndirectMultiview.programId() : colorShaderIndirect.programId();
+		GLuint const depthPadsProgram = state.splitscreen ? depthInstancedMultiview.programId() : depthInstanced.programId();
+		GLuint const depthSceneObjectsProgram = state.splitscreen ? depthIndirectMultiview.programId() : depthIndirect.programId();
+
+		//FILL THE DRAW LIST-----------------------------------------------------------------------
+		//the objects are the same for both views, culling keeps what either view sees
+		drawList.clear();
+		Mat44f const spaceshipNormals = normal_matrix(spaceship);
+		for (std::size_t i = 0; i < spaceshipParts[spaceshipLod].size(); ++i) {
+			auto const& part = spaceshipParts[spaceshipLod][i];
+			drawList.add(part.mesh, spaceship_translation * part.model2Object, spaceshipNormals * spaceshipPartNormals[spaceshipLod][i]);
+		}
+		drawList.upload();
 
-		if (state.camControl.animationActive) {
-			runParticles(listofParticles , 0);
-		
-			
-			// Increment the animation time.
-			animation_time += dt;
-			// between the range 0 and 1.
-			float normalized_time = fmod(animation_time, loop_duration) / loop_duration;
-			// acceleration is controlled by the eased time.
-			float eased_time = normalized_time * normalized_time * normalized_time * normalized_time;
-			// as time goes on speed increases.
-			float scaled_eased_time = eased_time * loop_duration;
-			// Use eased time for calculations.
-			float x = scaled_eased_time;
-			float y = (atan(scaled_eased_time * 500) / 15);
-
-			// Calculate the translation for the spaceship's flight movement.
-			Mat44f spaceshipFlightMovement = make_translation(Vec3f{ x, y, 0.f });
-			state.vecSpaceshipTranslation.x += x;
-			state.vecSpaceshipTranslation.y += y;
-			spaceship_flight = spaceship_flight * spaceshipFlightMovement;
-			spaceship_translation = spaceship_translation * spaceship_flight;
-
-			// Calculate the rotation angle for the spaceship.
-			float angle = atan2(y, x) + (271.7f * kPi_ / 180.f);
-			
-			Mat44f spaceshipRotation = make_rotation_z(angle);
-			spaceship_translation = spaceship_translation * spaceshipRotation;
-			
-			Mat44f lightPosition1 = make_translation(state.lightPositions[0]);
+		GLuint cullProgram = (cullShader && !state.cpuCulling) ? cullShader->programId() : 0;
 
-			Mat44f lightPosition2 = make_translation(state.lightPositions[1]);
-			Mat44f lightPosition3 = make_translation(state.lightPositions[2]);
-			
-			lightPosition1 = spaceshipFlightMovement * lightPosition1;
-			lightPosition2 = spaceshipFlightMovement * lightPosition2;
-			lightPosition3 = spaceshipFlightMovement * lightPosition3;
+		// Draw scene
+		OGL_CHECKPOINT_DEBUG();
+		//---------------------------------------------------------------------------------------------------
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // combingig both tells open gl to clear the color and depth buffer in one go
 
-			state.lightPositions[0] = {lightPosition1(0,3), lightPosition1(1,3), lightPosition1(2,3)};
-			state.lightPositions[1] = { lightPosition2(0,3), lightPosition2(1,3), lightPosition2(2,3) };
-			state.lightPositions[2] = { lightPosition3(0,3), lightPosition3(1,3), lightPosition3(2,3) };
-		
-			draw_particles(particleShader.programId(), projection, LookAt, spaceship_translation * make_translation({0.0f,-0.1f,0.f}), normalMatrix,
-				listofParticles, particleVAOList, particle_vertexCount, particleMovement);
-			
+		//used by the landmass and the pads drawn one by one; those are at most translated
+		Mat33f const normalMatrix = kIdentity33f;
 
+		//BUILD THE RENDER QUEUE-------------------------------------------------------------------
+		//depths are taken from the first view. an instanced draw counts at its nearest
+		//instance; the land mass is under everything else and goes last
+		Vec3f lightDir = normalize(Vec3f{ 0.f, 1.f, -1.f });
+		renderQueue.clear();
+		renderQueue.add(RenderPass::opaque, RenderQueue::kBackground, std::uint32_t(SceneDraw_::landMass));
+
+		if (state.lod && !state.padsPerDrawLoop) {
+			for (std::size_t i = 0; i < landingPadLods.level_count(); ++i) {
+				if (!padLodTransforms[i].empty()) {
+					renderQueue.add(RenderPass::opaque, nearest_view_depth(LookAt, padLodTransforms[i].data(), padLodTransforms[i].size()),
+						std::uint32_t(SceneDraw_::landingPads), std::uint32_t(i));
+				}
+			}
 		}
-		else if (!state.camControl.animationActive) {
-			animation_time = 0.f;
-			spaceship_flight = make_translation(Vec3f{ 0.f, 0.f, 0.f });
+		else {
+			renderQueue.add(RenderPass::opaque, nearest_view_depth(LookAt, landingPads.data(), landingPads.size()),
+				std::uint32_t(SceneDraw_::landingPads));
 		}
 
-		// DRAW SPACESHIP TO SHADERS
-		// query for custom model
-		glQueryCounter(startCustomModelQuery, GL_TIMESTAMP);
-		draw_spaceship(colorShader.programId(), projection, LookAt, spaceship_translation, normalMatrix,lightDir, spaceship_vao, static_cast<int>(spaceship_vertex_count),
-			state.lightPositions, state.lightColors, state.vertPositions);
+		float const spaceshipDepth = view_depth(LookAt, spaceship.translation);
+		renderQueue.add(RenderPass::opaque, spaceshipDepth, std::uint32_t(SceneDraw_::spaceship));
 
-		// End timing after custom model rendering
-		glQueryCounter(endCustomModelQuery, GL_TIMESTAMP);
-
-		// Retrieve results for the frame timing
-		GLuint64 startCustomModelTime, endCustomModelTime;
-		glGetQueryObjectui64v(startCustomModelQuery, GL_QUERY_RESULT, &startCustomModelTime);
-		glGetQueryObjectui64v(endCustomModelQuery, GL_QUERY_RESULT, &endCustomModelTime);
-
-		GLuint64 durationCustomModel = endCustomModelTime - startCustomModelTime;
-		//output for custom model
-		customModel.duration = durationCustomModel;
-		customModel.resultReady = true;
-
-		//reset state
-		glBindVertexArray(0);
-		glUseProgram(0);
+		if (state.fleet) {
+			float const fleetDepth = nearest_view_depth(LookAt, fleet->transforms().data(), fleet->size());
+			if (state.lod) {
+				for (std::size_t i = 0; i < spaceshipLods.level_count(); ++i) {
+					if (!fleetLodTransforms[i].empty()) {
+						renderQueue.add(RenderPass::opaque, nearest_view_depth(LookAt, fleetLodTransforms[i].data(), fleetLodTransforms[i].size()),
+							std::uint32_t(SceneDraw_::fleet), std::uint32_t(i));
+					}
+				}
+			}
+			else {
+				renderQueue.add(RenderPass::opaque, fleetDepth, std::uint32_t(SceneDraw_::fleet));
+			}
+			renderQueue.add(RenderPass::transparent, fleetDepth, std::uint32_t(SceneDraw_::fleetExhaust));
+		}
 
-		OGL_CHECKPOINT_DEBUG();
+		if (state.camControl.animationActive) {
+			renderQueue.add(RenderPass::transparent, spaceshipDepth, std::uint32_t(SceneDraw_::particles));
+		}
 
-		//VIEWPORT 2-------------------------------------------------------------------------------------------------------------------
-		if (state.splitscreen) {
-			//query for viewport 2
-			glQueryCounter(startView2Query, GL_TIMESTAMP);
+		renderQueue.sort();
 
-			LookAt = lookAt(cameraPos2, cameraPos2 + cameraFront2);
+		//culling writes the draw list's commands, so it goes before both passes
+		drawList.cull(views, viewCount, cullProgram);
 
-			if (state.cameraMode2 == State_::cameraTracking::cameraTrackGround) {
-				Vec3f groundCameraPos = { -10.f, 0.1f, -20.f };
-				LookAt = lookAt(groundCameraPos, state.vecSpaceshipTranslation);
-			}
-			else if (state.cameraMode2 == State_::cameraTracking::cameraTrackFollow) {
-				Vec3f followCameraPos = state.vecSpaceshipTranslation;
-				followCameraPos.y += 3.f;
-				followCameraPos.z += 30.f;
-				LookAt = lookAt(followCameraPos, state.vecSpaceshipTranslation);
+		//each queued draw gets its own timer query (up to kMaxTimedDraws_); the results are
+		//added up per kind two frames later
+		auto const timed_draw = [&](SceneDraw_ kind, auto const& draw) {
+			if (frameQueries.count == kMaxTimedDraws_ || !drawTimers[std::size_t(kind)]) {
+				draw();
+				return;
 			}
+			frameQueries.kinds[frameQueries.count] = kind;
+			glBeginQuery(GL_TIME_ELAPSED, frameQueries.timers[frameQueries.count++]);
+			draw();
+			glEndQuery(GL_TIME_ELAPSED);
+		};
 
-			projCameraWorld = projection * LookAt;
+		auto const draw_color = [&](RenderItem const& item) {
+			switch (SceneDraw_(item.id)) {
+			case SceneDraw_::landMass:
+				draw_land_mass(glState, landMassProgram, renderOrigin.to_local(kIdentity44f), normalMatrix, lightDir, tex, meshArena.vao(), landMassMesh);
+				break;
+			case SceneDraw_::landingPads:
+				if (state.padsPerDrawLoop) {
+					draw_landing_pads_loop(glState, padsLoopProgram, lightDir, normalMatrix, meshArena, landingPadLods.level(0), landingPads,
+						state.lightPositions, state.lightColors, state.vertPositions);
+				}
+				else {
+					//one instanced draw per level of detail
+					draw_landing_pads(glState, padsProgram, lightDir, meshArena, landingPadLods.level(item.arg),
+						state.lod ? padLodInstances[item.arg] : landingPadInstances,
+						state.lightPositions, state.lightColors, state.vertPositions);
+				}
+				break;
+			case SceneDraw_::spaceship:
+				draw_scene_objects(glState, sceneObjectsProgram, lightDir, drawList,
+					state.lightPositions, state.lightColors, state.vertPositions);
+				break;
+			case SceneDraw_::fleet:
+				//without levels of detail, all rockets are drawn at full detail
+				draw_fleet(glState, padsProgram, lightDir, meshArena, spaceshipLods.level(item.arg),
+					state.lod ? fleetLodInstances[item.arg] : fleetInstances,
+					state.lightPositions, state.lightColors, state.vertPositions);
+				break;
+			case SceneDraw_::particles:
+				//particles are only drawn in the first view (viewport 0)
+				draw_particles(glState, particleShader.programId(), projection, LookAt, spaceship_translation * make_translation({0.0f,-0.1f,0.f}),
+					launchFrame.particles, meshArena, particleMesh, frameArena, particleInstances);
+				break;
+			case SceneDraw_::fleetExhaust:
+				draw_fleet_exhaust(glState, fleetExhaustShader.programId(), exhaustVao, fleetInstances, fleetTime, pixelScale);
+				break;
+			case SceneDraw_::count:
+				break;
+			}
+		};
 
-			glViewport( static_cast<GLsizei>(fbwidth/2), 0, static_cast<GLsizei>(fbwidth/ 2.f), static_cast<GLsizei>(fbheight));
+		//depth only, with the same vertex shaders as draw_color(). the land mass is left out
+		//(nothing is behind it), as are the pads drawn one by one
+		auto const draw_depth = [&](RenderItem const& item) {
+			switch (SceneDraw_(item.id)) {
+			case SceneDraw_::landingPads:
+				glState.use_program(depthPadsProgram);
+				(state.lod ? padLodInstances[item.arg] : landingPadInstances).draw(meshArena, landingPadLods.level(item.arg));
+				break;
+			case SceneDraw_::spaceship:
+				glState.use_program(depthSceneObjectsProgram);
+				drawList.draw();
+				break;
+			case SceneDraw_::fleet:
+				glState.use_program(depthPadsProgram);
+				(state.lod ? fleetLodInstances[item.arg] : fleetInstances).draw(meshArena, spaceshipLods.level(item.arg));
+				break;
+			default:
+				break;
+			}
+		};
+		auto const in_depth_prepass = [&](RenderItem const& item) {
+			SceneDraw_ const kind = SceneDraw_(item.id);
+			return SceneDraw_::spaceship == kind || SceneDraw_::fleet == kind ||
+				(SceneDraw_::landingPads == kind && !state.padsPerDrawLoop);
+		};
 
-			//SETUP FOR THE LANDMASS--------------------------------------------------------------------
-			draw_land_mass(prog.programId(), projCameraWorld, normalMatrix, lightDir, tex, vao, static_cast<int>(mesh_vertex_count));
-			// DRAW OTHER ITEMS----------------------------------------------------------------------------
+		//query for the views, one view or both views depending on the split screen. it covers
+		//the depth pre-pass and the opaque draws
+		frameQueries.splitscreen = state.splitscreen;
+		glQueryCounter(frameQueries.startViews, GL_TIMESTAMP);
+
+		//DEPTH PRE-PASS---------------------------------------------------------------------------
+		//Z: lay down the depth of the opaque objects first, so the multi-light color shader
+		//below only runs for the fragments that end up visible
+		if (state.depthPrepass) {
+			glState.color_mask(GL_FALSE);
+			for (auto const& item : renderQueue) {
+				if (RenderPass::opaque == item.pass && in_depth_prepass(item)) {
+					timed_draw(SceneDraw_(item.id), [&] { draw_depth(item); });
+				}
+			}
+			glState.color_mask(GL_TRUE);
+			glState.depth_func(GL_LEQUAL);
+		}
 
-			draw_landing_pad(colorShader.programId(), projection, LookAt, landingPadTranslation, numLandingPads, normalMatrix, lightDir, landingpad_vao, static_cast<int>(landingpad_vertex_count),
-				state.lightPositions, state.lightColors, state.vertPositions);
+		//the fragment shader invocations of the color draws, i.e. without the pre-pass
+		if (fragmentQueries) {
+			glBeginQuery(GL_FRAGMENT_SHADER_INVOCATIONS, frameQueries.fragments);
+			frameQueries.fragmentsIssued = true;
+			frameQueries.depthPrepass = state.depthPrepass;
+		}
 
-			draw_spaceship(colorShader.programId(), projection, LookAt, spaceship_translation, normalMatrix, lightDir, spaceship_vao, static_cast<int>(spaceship_vertex_count),
-				state.lightPositions, state.lightColors, state.vertPositions);
+		//DRAW THE OPAQUE OBJECTS------------------------------------------------------------------
+		RenderItem const* item = renderQueue.begin();
+		for (; item != renderQueue.end() && RenderPass::opaque == item->pass; ++item) {
+			timed_draw(SceneDraw_(item->id), [&] { draw_color(*item); });
+		}
+		glState.depth_func(GL_LESS);
 
-			// end the time for view port 2
-			glQueryCounter(endView2Query, GL_TIMESTAMP);
+		// end of the views
+		glQueryCounter(frameQueries.endViews, GL_TIMESTAMP);
 
-			// Retrieve results for the frame timing
-			GLuint64  startView2Time, endView2Time;
-			glGetQueryObjectui64v(startView2Query, GL_QUERY_RESULT, &startView2Time);
-			glGetQueryObjectui64v(endView2Query, GL_QUERY_RESULT, &endView2Time);
-			GLuint64 durationView2 = (endView2Time - startView2Time);
+		//DRAW THE TRANSPARENT OBJECTS-------------------------------------------------------------
+		for (; item != renderQueue.end(); ++item) {
+			timed_draw(SceneDraw_(item->id), [&] { draw_color(*item); });
+		}
 
-			//output for viewports
-			view2.duration = durationView2;
-			view2.resultReady = true;
+		if (fragmentQueries) {
+			glEndQuery(GL_FRAGMENT_SHADER_INVOCATIONS);
 		}
 
-		// End frame query
-		glQueryCounter(endFrameQuery, GL_TIMESTAMP);
-		GLuint64 startFrameTime, endFrameTime;
-		glGetQueryObjectui64v(startFrameQuery, GL_QUERY_RESULT, &startFrameTime);
-		glGetQueryObjectui64v(endFrameQuery, GL_QUERY_RESULT, &endFrameTime);
+		OGL_CHECKPOINT_DEBUG();
 
-		// Calculate the frame rendering time
-		GLuint64 frameDuration = endFrameTime - startFrameTime;
+		// End frame query
+		glQueryCounter(frameQueries.endFrame, GL_TIMESTAMP);
 
-		// Output the duration or store it for later 
-		FullRender.duration = frameDuration;
-		FullRender.resultReady = true;
+		//the queries of two frames ago; their set is reused in the next frame
+		++queryFrame;
+		collect_frame_queries(frameQuerySets[queryFrame % kQueryFrames_]);
 
 		//end frame to frame timer
 		auto end = std::chrono::high_resolution_clock::now();
 		duration = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - last);
 
-		glViewport(0, 0, static_cast<GLsizei>(fbwidth), static_cast<GLsizei>(fbheight));
-		glUseProgram(uiShader.programId());
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glState.viewport(0, 0, static_cast<GLsizei>(fbwidth), static_cast<GLsizei>(fbheight));
+		glState.use_program(uiShader.programId());
+		glState.enable(GL_BLEND);
+		glState.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+		Vec4f resetButtonColor{ 0.f, 0.f, 1.f, 0.5f };
 		if (inResetBtnArea) {
-			resetButtonVao = create_rectangle_vao(buttonReset, Vec4f{ 0.f, 0.3f, 1.f, 0.5f});
-		}
-		else {
-			resetButtonVao = create_rectangle_vao(buttonReset, Vec4f{ 0.f, 0.f, 1.f, 0.5f});
+			resetButtonColor = Vec4f{ 0.f, 0.3f, 1.f, 0.5f };
 		}
 
+		Vec4f launchButtonColor{ 1.f, 0.f, 0.f, 0.5f };
 		if (inLaunchBtnArea) {
-			launchButtonVao = create_rectangle_vao(buttonLaunch, Vec4f{1.f, 0.3f, 0.f, 0.5f});
-		}
-		else {
-			launchButtonVao = create_rectangle_vao(buttonLaunch, Vec4f{1.f, 0.f, 0.f, 0.5f});
+			launchButtonColor = Vec4f{ 1.f, 0.3f, 0.f, 0.5f };
 		}
 		
 		if (state.mouseLeftPressed) {
 			bool clickedLaunchButton = is_mouse_in_area(state.mousePressedX, state.mousePressedY, launchButtonBoundingBox);
 			if (clickedLaunchButton) {
-				launchButtonVao = create_rectangle_vao(buttonLaunch, Vec4f{1.f, 1.f, 0.f, 0.5f});
+				launchButtonColor = Vec4f{ 1.f, 1.f, 0.f, 0.5f };
 				state.camControl.animationActive = true;
 			}
 			bool clickedResetButton = is_mouse_in_area(state.mousePressedX, state.mousePressedY, resetButtonBoundingBox);
 			if (clickedResetButton) {
-				resetButtonVao = create_rectangle_vao(buttonReset, Vec4f{0.f, 1.f, 1.f, 0.5f});
+				resetButtonColor = Vec4f{ 0.f, 1.f, 1.f, 0.5f };
 				state.camControl.animationActive = false;
-				state.vecSpaceshipTranslation = secondLandingpadTranslation;
-				state.lightPositions = get_lightpositions();
 			}
 		}
 
+		draw_stream_rectangle(glState, streamBuffer, frameArena, buttonVao, buttonLaunch, launchButtonColor);
+		draw_stream_rectangle(glState, streamBuffer, frameArena, buttonVao, buttonReset, resetButtonColor);
+		glState.disable(GL_BLEND);
 
-		glBindVertexArray(launchButtonVao);
-		glDrawArrays(GL_TRIANGLES, 0, 6);
-		glBindVertexArray(resetButtonVao);
-		glDrawArrays(GL_TRIANGLES, 0, 6);
-		glDisable(GL_BLEND);
-
-		glDisable(GL_DEPTH_TEST);
-		glBindVertexArray(launchButtonOutlineVao);
+		glState.disable(GL_DEPTH_TEST);
+		glState.bind_vertex_array(launchButtonOutlineVao);
 		glDrawArrays(GL_LINES, 0, 8);
-		glBindVertexArray(resetButtonOutlineVao);
+		glState.bind_vertex_array(resetButtonOutlineVao);
 		glDrawArrays(GL_LINES, 0, 8);
-		glEnable(GL_DEPTH_TEST);
+		glState.enable(GL_DEPTH_TEST);
+
+		//the GPU is done with this frame's streamed data once it gets past here
+		streamBuffer.end_frame();
+
+		//switch the pacing between frames, so each mode only measures its own
+		if (state.cyclePaceMode) {
+			framePacer.set_mode(next_mode(framePacer.mode()));
+			state.cyclePaceMode = false;
+			std::fprintf(stderr, "Frame pacing: %s.\n", to_string(framePacer.mode()));
+		}
 
 		// Display results
+		framePacer.wait();
+		state.input.submitted(cameraInput, Clock::now());
 		glfwSwapBuffers( window );
+		framePacer.presented();
+
+		glState.end_frame();
+
+		if (kHeapAllocationsCounted) {
+			bool const steadyFrame = ++frameCount > kWarmupFrames_ &&
+				frameInputEvents == state.inputEvents && 0 == assetsReloaded;
+			std::size_t const allocations = heap_allocation_count() - frameHeapAllocations;
+			if (steadyFrame && allocations > 0) {
+				std::fprintf(stderr, "Frame %zu: %zu heap allocations in a steady frame\n", frameCount, allocations);
+				assert(0 == allocations);
+			}
+		}
 	}
 
 	// Output performance results
@@ -854,15 +1515,92 @@ int main() try
 	std::cout << "Full Render" << "\t\t" << FullRender.duration << "\n";
 	std::cout << "Basic Rendering: " << "\t" << basicRendering.duration << "\n";
 	std::cout << "Instancing: " << "\t\t" << instancing.duration << "\n";
-	std::cout << "Custom Model" << "\t\t" << customModel.duration << "\n";
-	std::cout << "One View" << "\t\t" << view1Time << "\n";
-	std::cout << "Both Views: " << "\t\t" << view2.duration << "\n\n";
+	std::cout << "Scene Objects" << "\t\t" << sceneObjects.duration << "\n";
+	std::cout << "One View" << "\t\t" << view1.duration << "\n";
+	std::cout << "Both Views: " << "\t\t" << view2.duration << "\n";
+	//what the second view adds on top of the first, when both were measured
+	if (view1.resultReady && view2.resultReady && view2.duration > view1.duration) {
+		std::cout << "Second View: " << "\t\t" << (view2.duration - view1.duration) << "\n";
+	}
+	std::cout << "(" << landingPads.size() << " landing pads, " << (state.padsPerDrawLoop ? "one draw per pad" : "instanced")
+		<< ", levels of detail " << (state.lod ? "on" : "off") << ", GPU timings from two frames before, "
+		<< lateFrameQueries << " frames not ready in time)\n\n";
+
+	//fleet stress test: CPU update, and GPU time for the rockets and their exhaust
+	if (fleet && fleetUpdates > 0) {
+		std::cout << "Fleet Performance Table:\n";
+		std::cout << "Section\t\t\tDuration (ns)\n";
+		std::cout << "-------------------------------------\n";
+		std::cout << "Update (CPU, avg)" << "\t" << static_cast<std::uint64_t>(fleetUpdateSeconds / fleetUpdates * 1e9) << "\n";
+		std::cout << "Render (GPU)" << "\t\t" << fleetRender.duration << "\n";
+		std::cout << "(" << fleet->size() << " rockets, " << fleet->thread_count() << " update threads, "
+			<< fleet->size() * kFleetExhaustParticles_ << " exhaust particles)\n\n";
+	}
 
 	//output frame to frame results
 	std::cout << "Frame to Frame Performance Table:\n";
 	std::cout << "Section\t\t\tDuration (ns)\n";
 	std::cout << "-------------------------------------\n";
-	std::cout << "Multiple Frames" << "\t\t" << duration.count() << "\n";
+	std::cout << "Multiple Frames" << "\t\t" << duration.count() << "\n\n";
+
+	//frame times as presented, and how often a frame came a refresh (or more) late.
+	//only covers the frames since the last change of the pacing mode
+	FrameStats const& frameStats = framePacer.stats();
+	auto const to_ns = [](double aSeconds) { return static_cast<std::uint64_t>(aSeconds * 1e9); };
+	std::cout << "Frame Pacing (" << to_string(framePacer.mode()) << "):\n";
+	std::cout << "Section\t\t\tDuration (ns)\n";
+	std::cout << "-------------------------------------\n";
+	std::cout << "Mean" << "\t\t\t" << to_ns(frameStats.meanSeconds) << "\n";
+	std::cout << "Std. Deviation" << "\t\t" << to_ns(std::sqrt(frameStats.varianceSeconds2)) << "\n";
+	std::cout << "Min" << "\t\t\t" << to_ns(frameStats.minSeconds) << "\n";
+	std::cout << "Max" << "\t\t\t" << to_ns(frameStats.maxSeconds) << "\n";
+	std::cout << "(" << frameStats.frames << " frames, " << frameStats.missedDeadlines << " missed deadlines, period "
+		<< std::chrono::duration_cast<std::chrono::nanoseconds>(framePacer.frame_period()).count() << " ns)\n\n";
+
+	//from the cursor moving to the frame that shows it being submitted, and from the late
+	//sample of the mouse look to the submission
+	InputLatency const& inputLatency = state.input.latency();
+	std::cout << "Input Latency (mouse look):\n";
+	std::cout << "Section\t\t\tDuration (ns)\n";
+	std::cout << "-------------------------------------\n";
+	std::cout << "Event to Submit" << "\t\t" << to_ns(inputLatency.meanEventSeconds) << "\n";
+	std::cout << "Event to Submit, Max" << "\t" << to_ns(inputLatency.maxEventSeconds) << "\n";
+	std::cout << "Sample to Submit" << "\t" << to_ns(inputLatency.meanSampleSeconds) << "\n";
+	std::cout << "(" << inputLatency.frames << " frames with mouse look)\n\n";
+
+	//fragment shader invocations of the color draws per frame, with and without the depth
+	//pre-pass (Z). needs pipeline statistics queries (OpenGL 4.6 or the ARB extension)
+	if (fragmentQueries) {
+		auto const per_frame = [&](std::size_t aPrepass) -> GLuint64 {
+			return fragmentFrames[aPrepass] > 0 ? fragmentInvocations[aPrepass] / fragmentFrames[aPrepass] : 0;
+		};
+		std::cout << "Fragment Shader Invocations:\n";
+		std::cout << "Section\t\t\tPer Frame\n";
+		std::cout << "-------------------------------------\n";
+		std::cout << "Without Pre-Pass" << "\t" << per_frame(0) << "\n";
+		std::cout << "With Pre-Pass" << "\t\t" << per_frame(1) << "\n";
+		if (fragmentFrames[0] > 0 && fragmentFrames[1] > 0 && per_frame(0) > per_frame(1)) {
+			std::cout << "Saved" << "\t\t\t" << (per_frame(0) - per_frame(1)) << "\n";
+		}
+		std::cout << "(" << fragmentFrames[0] << " frames without, " << fragmentFrames[1] << " frames with the pre-pass)\n\n";
+	}
+
+	//output how many GL state changes the cache let through
+	std::size_t const cachedFrames = std::max<std::size_t>(glState.frame_count(), 1);
+	std::cout << "GL State Calls Per Frame:\n";
+	std::cout << "Section\t\t\tIssued\tElided\n";
+	std::cout << "-------------------------------------\n";
+	std::cout << "Last Frame" << "\t\t" << glState.last_frame().issued << "\t" << glState.last_frame().elided << "\n";
+	std::cout << "Average" << "\t\t\t" << glState.total().issued / cachedFrames << "\t" << glState.total().elided / cachedFrames << "\n";
+
+	//streamed data of the last frame, and how often the CPU had to wait for the GPU
+	//before reusing a region of the stream buffer
+	std::cout << "\nStream Buffer (" << (streamBuffer.persistent() ? "persistent" : "glBufferSubData") << "):\n";
+	std::cout << "Section\t\t\tBytes\n";
+	std::cout << "-------------------------------------\n";
+	std::cout << "Last Frame" << "\t\t" << streamBuffer.frame_bytes() << "\n";
+	std::cout << "Region" << "\t\t\t" << streamBuffer.region_size() << "\n";
+	std::cout << "(" << streamBuffer.stall_count() << " waits for the GPU)\n";
 
 
 
@@ -897,23 +1635,13 @@ namespace
 
 		if (auto* state = static_cast<State_*>(glfwGetWindowUserPointer(aWindow)))
 		{
-			// R-key reloads shaders.
+			++state->inputEvents;
+
+			// R-key reloads shaders. The sources are read by the asset reloader in
+			// the background and swapped in at the start of a later frame
 			if (GLFW_KEY_R == aKey && GLFW_PRESS == aAction)
 			{
-				if (state->prog)
-				{
-					try
-					{
-						state->prog->reload();
-						std::fprintf(stderr, "Shaders reloaded and recompiled.\n");
-					}
-					catch (std::exception const& eErr)
-					{
-						std::fprintf(stderr, "Error when reloading shader:\n");
-						std::fprintf(stderr, "%s\n", eErr.what());
-						std::fprintf(stderr, "Keeping old shader.\n");
-					}
-				}
+				state->reloadShaders = true;
 			}
 
 			//F starts animation
@@ -921,12 +1649,42 @@ namespace
 				state->camControl.animationActive = true;
 			}
 			//R resets animation, bringing spaceship to starting point and stopping it
+			//(the launch simulation resets itself while the animation is stopped)
 			else if (GLFW_KEY_R == aKey && GLFW_PRESS == aAction) {
 				state->camControl.animationActive = false;
-				state->lightPositions = get_lightpositions();
-				//same as second landing pad location, should try not to hardcode
-				state->vecSpaceshipTranslation = { 15.f, -0.95f, -10.f };
-
+			}
+			//G switches draw list culling between the compute shader and the CPU
+			else if (GLFW_KEY_G == aKey && GLFW_PRESS == aAction) {
+				state->cpuCulling = !state->cpuCulling;
+				std::fprintf(stderr, "Draw list culling on the %s.\n", state->cpuCulling ? "CPU" : "GPU");
+			}
+			//P toggles the spaceport (thousands of extra landing pads)
+			else if (GLFW_KEY_P == aKey && GLFW_PRESS == aAction) {
+				state->spaceport = !state->spaceport;
+				state->padsChanged = true;
+			}
+			//I switches the landing pads between instancing and one draw call per pad
+			else if (GLFW_KEY_I == aKey && GLFW_PRESS == aAction) {
+				state->padsPerDrawLoop = !state->padsPerDrawLoop;
+				std::fprintf(stderr, "Landing pads drawn %s.\n", state->padsPerDrawLoop ? "with one draw call per pad" : "instanced");
+			}
+			//L toggles the fleet of rockets
+			else if (GLFW_KEY_L == aKey && GLFW_PRESS == aAction) {
+				state->fleet = !state->fleet;
+			}
+			//O switches levels of detail off (everything at full detail) and back on
+			else if (GLFW_KEY_O == aKey && GLFW_PRESS == aAction) {
+				state->lod = !state->lod;
+				std::fprintf(stderr, "Levels of detail %s.\n", state->lod ? "on" : "off");
+			}
+			//T cycles the frame pacing: vsync, adaptive vsync, uncapped, limited
+			else if (GLFW_KEY_T == aKey && GLFW_PRESS == aAction) {
+				state->cyclePaceMode = true;
+			}
+			//Z toggles the depth pre-pass in front of the color pass
+			else if (GLFW_KEY_Z == aKey && GLFW_PRESS == aAction) {
+				state->depthPrepass = !state->depthPrepass;
+				std::fprintf(stderr, "Depth pre-pass %s.\n", state->depthPrepass ? "on" : "off");
 			}
 			//V splitscreens the view
 			else if (GLFW_KEY_V == aKey && GLFW_PRESS == aAction) {
@@ -1057,6 +1815,8 @@ namespace
 
 	void glfw_callback_mouseclick_(GLFWwindow* aWindow, int button, int action, int ) {
 		if (auto* state = static_cast<State_*>(glfwGetWindowUserPointer(aWindow))) {
+			++state->inputEvents;
+
 			if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
 				state->mouseLeftPressed = true;
 				double xpos{}, ypos{};
@@ -1076,22 +1836,9 @@ namespace
 	{
 		if (auto* state = static_cast<State_*>(glfwGetWindowUserPointer(aWindow)))
 		{
-			if (state->camControl.cameraActive)
-			{
-				auto const dx = float(aX - state->camControl.lastX);
-				auto const dy = float(aY - state->camControl.lastY);
-
-				state->camControl.phi += dx * kMouseSensitivity_;
-
-				state->camControl.theta += dy * kMouseSensitivity_;
-				if (state->camControl.theta > kPi_ / 2.f)
-					state->camControl.theta = kPi_ / 2.f;
-				else if (state->camControl.theta < -kPi_ / 2.f)
-					state->camControl.theta = -kPi_ / 2.f;
-			}
-
-			state->camControl.lastX = state->camControl.currentX;
-			state->camControl.lastY = state->camControl.currentY;
+			//the camera takes the movement from the sampler, late in the frame. the
+			//current position is for the buttons
+			state->input.cursor_moved(aX, aY, Clock::now());
 
 			state->camControl.currentX = float(aX);
 			state->camControl.currentY = float(aY);
@@ -1131,117 +1878,54 @@ namespace
 		return rotationMatrix * cameraPositionMatrix;
 	}
 
-	void draw_land_mass(GLuint shaderId, Mat44f projCameraWorld, Mat33f normalMatrix, Vec3f lightDir, GLuint tex, GLuint vao, int vertexCount) {
-		glUseProgram(shaderId);
+	void draw_land_mass(GLStateCache& glState, GLuint shaderId, Mat44f model2World, Mat33f normalMatrix, Vec3f lightDir, GLuint tex, GLuint vao, MeshHandle const& mesh) {
+		glState.use_program(shaderId);
 
-		//vertex shader parameters
-		glUniformMatrix4fv(0, 1, GL_TRUE, projCameraWorld.v);
-		glUniformMatrix3fv(1, 1, GL_TRUE, normalMatrix.v);
+		//vertex shader parameters, the view matrices come from the view uniform buffer
+		glState.uniform_matrix4fv(5, 1, GL_TRUE, model2World.v);
+		glState.uniform_matrix3fv(1, 1, GL_TRUE, normalMatrix.v);
 
 		//fragment shader parameters
-		glUniform3fv(2, 1, &lightDir.x);
-		glUniform3f(3, 0.9f, 0.9f, 0.6f);
-		glUniform3f(4, 0.05f, 0.05f, 0.05f);
+		glState.uniform3fv(2, 1, &lightDir.x);
+		glState.uniform3f(3, 0.9f, 0.9f, 0.6f);
+		glState.uniform3f(4, 0.05f, 0.05f, 0.05f);
 
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex);
+		glState.bind_texture(0, GL_TEXTURE_2D, tex);
 
-		glBindVertexArray(vao);
-		glDrawArrays(GL_TRIANGLES, 0, vertexCount); 
+		//the land mass lives in the mesh arena together with the other static meshes
+		glState.bind_vertex_array(vao);
+		glDrawElementsBaseVertex(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT,
+			reinterpret_cast<void const*>(mesh.firstIndex * sizeof(GLuint)), mesh.baseVertex);
 	}
 
-	void draw_particles(GLuint shaderId, Mat44f projection, Mat44f lookAt, Mat44f translation, Mat33f normalMatrix,
-		std::vector<Particle> listofParticles, std::vector<GLuint> vao, int vertexCount, std::vector<Vec3f> particleMovement)
+	void draw_particles(GLStateCache& glState, GLuint shaderId, Mat44f projection, Mat44f lookAt, Mat44f translation,
+		std::vector<Mat44f> const& particlePlacements, MeshArena const& arena, MeshHandle const& mesh,
+		FrameArena& frameArena, InstanceBuffer& instances)
 	{
-		
-		//Vec3f movement = particleMovement * translation.v;
 		//additive blending
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-
-
-		glUseProgram(shaderId);
-
-		
-
-		for (unsigned int i = 0; i < listofParticles.size(); ++i)
-		{
-			if (listofParticles[i].lifespan > 0.0f)
-			{
-				
-				glUniformMatrix4fv(0, 1, GL_TRUE, projection.v);
-				glUniformMatrix4fv(1, 1, GL_TRUE, lookAt.v);
-				glUniformMatrix4fv(5, 1, GL_TRUE, translation.v); //* particleMovement[i]);
-				glUniformMatrix3fv(6, 1, GL_TRUE, normalMatrix.v);
-
-				//fragment shader
-				glBindVertexArray(vao[i]);
-				glDrawArrays(GL_TRIANGLES, 0, vertexCount);
-
-			}
-
-
-		}
-		//revert back to normal
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-
-	}
-
-	void draw_landing_pad(GLuint shaderId, Mat44f projection, Mat44f lookAt, Mat44f translations[], int numTranslations, 
-		Mat33f normalMatrix, Vec3f lightDir, GLuint vao, int vertexCount,
-		std::vector<Vec3f> lightPositions, std::vector<Vec3f> lightColors, std::vector<Vec3f> vertPositions) {
-
-		// Convert the vector to a plain array
-		GLfloat* lightPositionsArray = new GLfloat[lightPositions.size() * 3];
-		for (size_t i = 0; i < lightPositions.size(); ++i) {
-			lightPositionsArray[i * 3] = lightPositions[i].x;
-			lightPositionsArray[i * 3 + 1] = lightPositions[i].y;
-			lightPositionsArray[i * 3 + 2] = lightPositions[i].z;
-		}
-
-		GLfloat* lightColorsArray = new GLfloat[lightColors.size() * 3];
-		for (size_t i = 0; i < lightColors.size(); ++i) {
-			lightColorsArray[i * 3] = lightColors[i].x;
-			lightColorsArray[i * 3 + 1] = lightColors[i].y;
-			lightColorsArray[i * 3 + 2] = lightColors[i].z;
-		}
-
-		GLfloat* vertPositionsArray = new GLfloat[vertPositions.size() * 3];
-		for (size_t i = 0; i < vertPositions.size(); ++i) {
-			vertPositionsArray[i * 3] = vertPositions[i].x;
-			vertPositionsArray[i * 3 + 1] = vertPositions[i].y;
-			vertPositionsArray[i * 3 + 2] = vertPositions[i].z;
+		glState.blend_func(GL_SRC_ALPHA, GL_ONE);
+
+		glState.use_program(shaderId);
+		glState.uniform_matrix4fv(0, 1, GL_TRUE, projection.v);
+		glState.uniform_matrix4fv(1, 1, GL_TRUE, lookAt.v);
+
+		//the live particles (the launch thread only passes those on) in one instanced
+		//draw, with their transforms streamed every frame. they are only scaled
+		//uniformly, so the transform doubles as normal matrix
+		FrameVector<Mat44f> model2World(ArenaAllocator<Mat44f>{ frameArena });
+		model2World.reserve(particlePlacements.size());
+		for (auto const& placement : particlePlacements) {
+			model2World.emplace_back(translation * placement);
 		}
 
-		glUseProgram(shaderId);
+		instances.assign_rigid(model2World.data(), model2World.size());
+		instances.draw(arena, mesh);
 
-		//vertex shader parameters
-		glUniformMatrix4fv(0, 1, GL_TRUE, projection.v);
-		glUniformMatrix4fv(1, 1, GL_TRUE, lookAt.v);
-		glUniformMatrix3fv(6, 1, GL_TRUE, normalMatrix.v);
-
-		//fragment shader parameters
-		glUniform3fv(2, 1, &lightDir.x);
-		glUniform3f(3, 0.9f, 0.9f, 0.6f);
-		glUniform3f(4, 0.05f, 0.05f, 0.05f);
-		glUniform3f(7, 3.0f, 3.0f, 3.0f);
-		glUniform3fv(8, static_cast<GLsizei>(lightPositions.size()), lightPositionsArray);
-		glUniform3fv(11, static_cast<GLsizei>(lightColors.size()), lightColorsArray);
-		glUniform3fv(15, static_cast<GLsizei>(vertPositions.size()), vertPositionsArray);
-
-		glBindVertexArray(vao);
-		for (int i = 0; i < numTranslations; i++) {
-			//change translation
-			glUniformMatrix4fv(5, 1, GL_TRUE, translations[i].v);
-			glDrawArrays(GL_TRIANGLES, 0, vertexCount); 
-		} 
-
-		delete[] lightColorsArray;
-		delete[] lightPositionsArray;
-		delete[] vertPositionsArray;
+		//revert back to normal
+		glState.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	}
 
-	GLuint create_rectangle_vao(std::vector<Vec2f> kPositions, Vec4f color) {
+	GLuint create_rectangle_vao(GLStateCache& glState, FrameArena& arena, std::vector<Vec2f> const& kPositions, Vec4f color) {
 
 		GLuint positionVBO;
 		glGenBuffers(1, &positionVBO); //generate the buffer pointer and give its value to positionVBO
@@ -1249,7 +1933,8 @@ namespace
 		glBufferData(GL_ARRAY_BUFFER, kPositions.size() * sizeof(Vec2f), kPositions.data(), GL_STATIC_DRAW); // we then add data to it
 
 
-		std::vector<Vec4f> kColors(kPositions.size(), color);
+		//the colors are only needed until they are uploaded
+		FrameVector<Vec4f> kColors(kPositions.size(), color, ArenaAllocator<Vec4f>(arena));
 
 		GLuint colorVBO;
 		glGenBuffers(1, &colorVBO); //generate the buffer pointer and give its value to positionVBO
@@ -1258,7 +1943,7 @@ namespace
 
 		GLuint vao;
 		glGenVertexArrays(1, &vao);
-		glBindVertexArray(vao);
+		glState.bind_vertex_array(vao);
 
 		glBindBuffer(GL_ARRAY_BUFFER, positionVBO);
 		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE,0, 0 );
@@ -1271,87 +1956,164 @@ namespace
 		return vao;
 	}
 
-	void draw_spaceship(GLuint shaderId, Mat44f projection, Mat44f lookAt, Mat44f translation, Mat33f normalMatrix, Vec3f lightDir, GLuint vao, int vertexCount,
-		std::vector<Vec3f> lightPositions, std::vector<Vec3f> lightColors, std::vector<Vec3f> vertPositions) {
-		glUseProgram(shaderId);
+	GLuint create_stream_rectangle_vao(GLStateCache& glState) {
+		//same attributes as create_rectangle_vao(), but the buffers are only bound
+		//when drawing (binding 0 for positions, 1 for colors)
+		GLuint vao;
+		glGenVertexArrays(1, &vao);
+		glState.bind_vertex_array(vao);
 
-		GLfloat* lightPositionsArray = new GLfloat[lightPositions.size() * 3];
-		for (size_t i = 0; i < lightPositions.size(); ++i) {
-			lightPositionsArray[i * 3] = lightPositions[i].x;
-			lightPositionsArray[i * 3 + 1] = lightPositions[i].y;
-			lightPositionsArray[i * 3 + 2] = lightPositions[i].z;
-		}
+		glVertexAttribFormat(0, 2, GL_FLOAT, GL_FALSE, 0);
+		glVertexAttribBinding(0, 0);
+		glEnableVertexAttribArray(0);
+
+		glVertexAttribFormat(1, 4, GL_FLOAT, GL_FALSE, 0);
+		glVertexAttribBinding(1, 1);
+		glEnableVertexAttribArray(1);
+
+		return vao;
+	}
+
+	void draw_stream_rectangle(GLStateCache& glState, StreamBuffer& stream, FrameArena& arena, GLuint vao,
+		std::vector<Vec2f> const& positions, Vec4f color) {
+		FrameVector<Vec4f> colors(positions.size(), color, ArenaAllocator<Vec4f>(arena));
+
+		auto const positionData = stream.write(positions.data(), positions.size() * sizeof(Vec2f), alignof(Vec2f));
+		auto const colorData = stream.write(colors.data(), colors.size() * sizeof(Vec4f), alignof(Vec4f));
+
+		glState.bind_vertex_array(vao);
+		glBindVertexBuffer(0, positionData.buffer, positionData.offset, sizeof(Vec2f));
+		glBindVertexBuffer(1, colorData.buffer, colorData.offset, sizeof(Vec4f));
+		glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(positions.size()));
+	}
+
+	void set_color_shader_uniforms(GLStateCache& glState, Vec3f lightDir,
+		std::vector<Vec3f> const& lightPositions, std::vector<Vec3f> const& lightColors, std::vector<Vec3f> const& vertPositions) {
+		//the view matrices come from the view uniform buffer, so only the
+		//fragment shader parameters are left
+		//Vec3f is three tightly packed floats, so the vectors can be passed directly
+		glState.uniform3fv(2, 1, &lightDir.x);
+		glState.uniform3f(3, 0.9f, 0.9f, 0.6f);
+		glState.uniform3f(4, 0.05f, 0.05f, 0.05f);
+		glState.uniform3f(7, 3.0f, 3.0f, 3.0f);
+		glState.uniform3fv(8, static_cast<GLsizei>(lightPositions.size()), &lightPositions[0].x);
+		glState.uniform3fv(11, static_cast<GLsizei>(lightColors.size()), &lightColors[0].x);
+		glState.uniform3fv(15, static_cast<GLsizei>(vertPositions.size()), &vertPositions[0].x);
+	}
+
+	void draw_scene_objects(GLStateCache& glState, GLuint shaderId, Vec3f lightDir, DrawList const& drawList,
+		std::vector<Vec3f> const& lightPositions, std::vector<Vec3f> const& lightColors, std::vector<Vec3f> const& vertPositions) {
+		glState.use_program(shaderId);
+
+		//the per object transforms and normal matrices come from the draw list
+		set_color_shader_uniforms(glState, lightDir, lightPositions, lightColors, vertPositions);
+
+		//one glMultiDrawElementsIndirect for all objects
+		drawList.draw();
+	}
+
+	void draw_landing_pads(GLStateCache& glState, GLuint shaderId, Vec3f lightDir,
+		MeshArena const& arena, MeshHandle const& mesh, InstanceBuffer const& instances,
+		std::vector<Vec3f> const& lightPositions, std::vector<Vec3f> const& lightColors, std::vector<Vec3f> const& vertPositions) {
+		glState.use_program(shaderId);
+
+		//the per pad transforms come from the instance buffer
+		set_color_shader_uniforms(glState, lightDir, lightPositions, lightColors, vertPositions);
+
+		//one instanced draw for all pads
+		instances.draw(arena, mesh);
+	}
+
+	void draw_landing_pads_loop(GLStateCache& glState, GLuint shaderId, Vec3f lightDir, Mat33f normalMatrix,
+		MeshArena const& arena, MeshHandle const& mesh, std::vector<Mat44f> const& translations,
+		std::vector<Vec3f> const& lightPositions, std::vector<Vec3f> const& lightColors, std::vector<Vec3f> const& vertPositions) {
+		glState.use_program(shaderId);
 
-		GLfloat* lightColorsArray = new GLfloat[lightColors.size() * 3];
-		for (size_t i = 0; i < lightColors.size(); ++i) {
-			lightColorsArray[i * 3] = lightColors[i].x;
-			lightColorsArray[i * 3 + 1] = lightColors[i].y;
-			lightColorsArray[i * 3 + 2] = lightColors[i].z;
+		set_color_shader_uniforms(glState, lightDir, lightPositions, lightColors, vertPositions);
+		glState.uniform_matrix3fv(6, 1, GL_TRUE, normalMatrix.v);
+
+		//one uniform update and draw call per pad, kept to measure against instancing
+		glState.bind_vertex_array(arena.vao());
+		for (auto const& translation : translations) {
+			glState.uniform_matrix4fv(5, 1, GL_TRUE, translation.v);
+			glDrawElementsBaseVertex(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT,
+				reinterpret_cast<void const*>(mesh.firstIndex * sizeof(GLuint)), mesh.baseVertex);
 		}
+	}
 
-		GLfloat* vertPositionsArray = new GLfloat[vertPositions.size() * 3];
-		for (size_t i = 0; i < vertPositions.size(); ++i) {
-			vertPositionsArray[i * 3] = vertPositions[i].x;
-			vertPositionsArray[i * 3 + 1] = vertPositions[i].y;
-			vertPositionsArray[i * 3 + 2] = vertPositions[i].z;
+	std::vector<LodMeshData> landing_pad_levels(SimpleMeshData const& landingPad) {
+		std::vector<LodMeshData> levels;
+		levels.push_back(LodMeshData{ landingPad, 0.f });
+
+		std::size_t const triangles = landingPad.positions.size() / 3;
+		float error = 0.f;
+		for (auto const reduction : kLandingPadLodReduction_) {
+			float levelError = 0.f;
+			auto simplified = simplify_mesh(landingPad, triangles / reduction, &levelError);
+			error = std::max(error, levelError);
+			levels.push_back(LodMeshData{ std::move(simplified), error });
 		}
+		return levels;
+	}
 
-		//vertex shader parameters
-		glUniformMatrix4fv(0, 1, GL_TRUE, projection.v);
-		glUniformMatrix4fv(1, 1, GL_TRUE, lookAt.v);
-		glUniformMatrix4fv(5, 1, GL_TRUE, translation.v);
-		glUniformMatrix3fv(6, 1, GL_TRUE, normalMatrix.v);
+	void add_spaceport_pads(std::vector<Mat44f>& pads) {
+		//64 x 64 grid of pads behind the two original ones
+		const int padsPerSide = 64;
+		const float spacing = 1.5f;
 
-		//fragment shader parameters
-		glUniform3fv(2, 1, &lightDir.x);
-		glUniform3f(3, 0.9f, 0.9f, 0.6f);
-		glUniform3f(4, 0.05f, 0.05f, 0.05f);
-		glUniform3f(7, 3.0f, 3.0f, 3.0f);
-		glUniform3fv(8, static_cast<GLsizei>(lightPositions.size()), lightPositionsArray);
-		glUniform3fv(11, static_cast<GLsizei>(lightColors.size()), lightColorsArray);
-		glUniform3fv(15, static_cast<GLsizei>(vertPositions.size()), vertPositionsArray);
-
-		glBindVertexArray(vao);
-		glDrawArrays(GL_TRIANGLES, 0, vertexCount);
-
-		delete[] lightColorsArray;
-		delete[] lightPositionsArray;
-		delete[] vertPositionsArray;
+		pads.reserve(pads.size() + padsPerSide * padsPerSide);
+		for (int i = 0; i < padsPerSide; ++i) {
+			for (int j = 0; j < padsPerSide; ++j) {
+				pads.push_back(make_translation(Vec3f{ -70.f + i * spacing, -0.95f, -35.f - j * spacing }));
+			}
+		}
 	}
-	
-	
-	
-	CameraValues get_camera_values(State_ &state, float movementSpeed, float dt, Vec3f cameraPos, Vec3f cameraFront, Vec3f cameraUp,
-		float xDiff, float yDiff, float yaw, float pitch, bool firstMouse) {
 
-		if (state.camControl.cameraActive) {
+	std::vector<PlacedMesh> spaceship_parts(MeshRegistry& registry, std::size_t subdivs) {
+		Vec3f const color{ 0.2f, 0.2f, 0.2f };
+		MeshHandle const& cylinder = registry.cylinder(subdivs, color);
+		MeshHandle const& cube = registry.cube(color);
+		MeshHandle const& pyramid = registry.pyramid(color);
+
+		//same order as the meshes used to be concatenated in
+		return std::vector<PlacedMesh>{
+			{ cylinder, make_translation({ 0.0f, 0.0f, 0.0f }) * make_rotation_z(3.141592f / 2.f) * make_scaling(0.25f, 0.25f, 0.25f) },
+			{ cylinder, make_translation({ 0.0f, 0.2f, 0.35f }) * make_rotation_z(3.141592f / 2.f) * make_scaling(0.5f, 0.12f, 0.12f) },
+			{ pyramid, make_translation({ 0.0f, 0.60f, 0.25f }) * make_rotation_x(0.0f) * make_scaling(0.5f, 1.0f, 0.5f) },
+			{ cylinder, make_translation({ 0.0f, 0.2f, -0.35f }) * make_rotation_z(3.141592f / 2.f) * make_scaling(0.5f, 0.12f, 0.12f) },
+			{ pyramid, make_translation({ 0.0f, 0.60f, -0.25f }) * make_rotation_x(0.0f) * make_scaling(0.5f, 1.0f, 0.5f) },
+			{ cylinder, make_translation({ 0.35f, 0.2f, 0.f }) * make_rotation_z(3.141592f / 2.f) * make_scaling(0.5f, 0.12f, 0.12f) },
+			{ pyramid, make_translation({ 0.25f, 0.60f, 0.f }) * make_rotation_x(0.0f) * make_scaling(0.5f, 1.0f, 0.5f) },
+			{ cylinder, make_translation({ -0.35f, 0.2f, 0.f }) * make_rotation_z(3.141592f / 2.f) * make_scaling(0.5f, 0.12f, 0.12f) },
+			{ pyramid, make_translation({ -0.25f, 0.60f, 0.f }) * make_rotation_x(0.0f) * make_scaling(0.5f, 1.0f, 0.5f) },
+			{ cube, make_translation({ 0.0f, 1.75f, 0.0f }) * make_scaling(0.5f, 3.0f, 0.5f) },
+			{ pyramid, make_translation({ 0.0f, 3.25, 0.0f }) * make_rotation_x(0.0f) * make_scaling(0.5f, 1.0f, 0.5f) }
+		};
+	}
 
-			if (firstMouse) {
-				state.camControl.lastX = state.camControl.currentX;
-				state.camControl.lastY = state.camControl.currentY;
-				firstMouse = false;
-			}
+	CameraLook get_camera_look(float xDiff, float yDiff, float yaw, float pitch) {
+		float sensitivity = 1.f;
 
-			float sensitivity = 1.f;
+		xDiff *= sensitivity;
+		yDiff *= sensitivity;
 
-			xDiff *= sensitivity;
-			yDiff *= sensitivity;
+		yaw += xDiff;
+		pitch += yDiff;
 
-			yaw += xDiff;
-			pitch += yDiff;
+		//make sure we dont need to flip the LookAt matrix if we go too far up or down
+		if (pitch > 89.f) pitch = 89.f;
+		if (pitch < -89.f) pitch = -89.f;
 
-			//make sure we dont need to flip the LookAt matrix if we go too far up or down
-			if (pitch > 89.f) pitch = 89.f;
-			if (pitch < -89.f) pitch = -89.f;
+		Vec3f direction{};
+		//for mouse movement (change where the camera is looking
+		direction.x = cos(radians(yaw)) * cos(radians(pitch));
+		direction.y = sin(radians(pitch));
+		direction.z = sin(radians(yaw)) * cos(radians(pitch));
 
-			Vec3f direction{};
-			//for mouse movement (change where the camera is looking
-			direction.x = cos(radians(yaw)) * cos(radians(pitch));
-			direction.y = sin(radians(pitch));
-			direction.z = sin(radians(yaw)) * cos(radians(pitch));
+		return CameraLook{ normalize(direction), yaw, pitch };
+	}
 
-			cameraFront = normalize(direction);
-		}
+	CameraValues get_camera_values(State_ &state, float movementSpeed, float dt, Vec3f cameraPos, Vec3f cameraFront, Vec3f cameraUp) {
 
 		Vec3f constantUp = { 0.f, 1.f, 0.f };
 
@@ -1362,26 +2124,28 @@ namespace
 			movementSpeed -= movementSpeed * dt;
 		}
 
+		//one fused multiply-add per move, instead of scaling the direction twice
+		float const step = movementSpeed * dt;
 		if (state.camControl.moveForward) {
-			cameraPos += (movementSpeed * cameraFront) * dt;
+			cameraPos = fma(cameraFront, step, cameraPos);
 		}
 		else if (state.camControl.moveBackward) {
-			cameraPos -= (movementSpeed * cameraFront) * dt;
+			cameraPos = fma(cameraFront, -step, cameraPos);
 		}
 		else if (state.camControl.moveLeft) {
-			cameraPos -= normalize(cross(cameraFront, cameraUp)) * movementSpeed * dt;
+			cameraPos = fma(normalize(cross(cameraFront, cameraUp)), -step, cameraPos);
 		}
 		else if (state.camControl.moveRight) {
-			cameraPos += normalize(cross(cameraFront, cameraUp)) * movementSpeed * dt;
+			cameraPos = fma(normalize(cross(cameraFront, cameraUp)), step, cameraPos);
 		}
 		else if (state.camControl.moveUp) {
-			cameraPos += (movementSpeed * constantUp) * dt;
+			cameraPos = fma(constantUp, step, cameraPos);
 		}
 		else if (state.camControl.moveDown) {
-			cameraPos -= (movementSpeed * constantUp) * dt;
+			cameraPos = fma(constantUp, -step, cameraPos);
 		}
 
-		return CameraValues{ cameraFront, cameraUp, cameraPos, movementSpeed, yaw, pitch, firstMouse };
+		return CameraValues{ cameraPos, movementSpeed };
 	}
 
 
@@ -1422,7 +2186,7 @@ namespace
 		return Vec2f{ translated_x, translated_y };
 	}
 
-	bool is_mouse_in_area(float mouse_x, float mouse_y, std::vector<Vec2f> boundingCoords) {
+	bool is_mouse_in_area(float mouse_x, float mouse_y, FrameVector<Vec2f> const& boundingCoords) {
 		Vec2f tl = boundingCoords[0];
 		Vec2f tr = boundingCoords[1];
 		Vec2f bl = boundingCoords[2];
@@ -1463,6 +2227,180 @@ namespace
 		return outlines;
 	}
 
+	void draw_fleet(GLStateCache& glState, GLuint shaderId, Vec3f lightDir,
+		MeshArena const& arena, MeshHandle const& mesh, InstanceBuffer const& instances,
+		std::vector<Vec3f> const& lightPositions, std::vector<Vec3f> const& lightColors, std::vector<Vec3f> const& vertPositions) {
+		//the rockets at one level of detail in one instanced draw, same as the landing pads
+		glState.use_program(shaderId);
+		set_color_shader_uniforms(glState, lightDir, lightPositions, lightColors, vertPositions);
+		instances.draw(arena, mesh);
+	}
+
+	void draw_fleet_exhaust(GLStateCache& glState, GLuint exhaustShaderId, GLuint exhaustVao,
+		InstanceBuffer const& instances, float time, float pointScale) {
+		//exhaust: kFleetExhaustParticles_ points per rocket, placed by the vertex shader
+		//from the rocket transforms. only drawn in the first view, like the particles
+		glState.use_program(exhaustShaderId);
+		glState.uniform1f(0, time);
+		glState.uniform1f(1, pointScale);
+		glState.uniform1ui(2, kFleetExhaustParticles_);
+
+		glState.enable(GL_PROGRAM_POINT_SIZE);
+		glState.enable(GL_BLEND);
+		glState.blend_func(GL_SRC_ALPHA, GL_ONE);
+		glState.depth_mask(GL_FALSE);
+
+		instances.bind();
+		glState.bind_vertex_array(exhaustVao);
+		glDrawArraysInstanced(GL_POINTS, 0, kFleetExhaustParticles_, GLsizei(instances.size()));
+
+		glState.depth_mask(GL_TRUE);
+		glState.disable(GL_BLEND);
+	}
+
+	bool has_gl_extension(char const* name) {
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (GLint i = 0; i < count; ++i) {
+			auto const extension = reinterpret_cast<char const*>(glGetStringi(GL_EXTENSIONS, GLuint(i)));
+			if (extension && 0 == std::strcmp(extension, name)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	Vec3f fleet_first_site() {
+		//same grid as the spaceport pads (P)
+		return Vec3f{ -70.f, -0.95f, -35.f };
+	}
+	float fleet_site_spacing() {
+		return 1.5f;
+	}
+
+	int simulate_headless(float seconds, std::size_t fleetSize) {
+		//same launch position as in the interactive version (second landing pad)
+		LaunchSimulation launch(Vec3f{ 15.f, -0.95f, -10.f });
+		auto const steps = static_cast<std::uint64_t>(std::llround(double(seconds) / double(LaunchSimulation::kTimeStep)));
+
+		auto const start = Clock::now();
+		for (std::uint64_t i = 0; i < steps; ++i) {
+			launch.step();
+		}
+		auto const wallTime = std::chrono::duration_cast<Secondsf>(Clock::now() - start).count();
+
+		//the hash only depends on the number of steps, so runs can be compared for
+		//bit-identical results
+		LaunchState const& flight = launch.current();
+		std::printf("Simulated %.3f s in %llu steps of %.4f s, %.3f ms wall time (%.0fx real time)\n",
+			double(flight.time), static_cast<unsigned long long>(launch.step_count()), double(LaunchSimulation::kTimeStep),
+			wallTime * 1000.0, wallTime > 0.f ? double(flight.time / wallTime) : 0.0);
+		std::printf("Position (%f, %f, %f), velocity (%f, %f, %f), angle %f\n",
+			double(flight.position.x), double(flight.position.y), double(flight.position.z),
+			double(flight.velocity.x), double(flight.velocity.y), double(flight.velocity.z), double(flight.angle));
+		std::printf("State hash %016llx\n", static_cast<unsigned long long>(launch.hash()));
+
+		//fleet: one update per step, same as the flight
+		if (fleetSize > 0) {
+			Trajectory trajectory(launch.launch_position());
+			RocketFleet fleet(trajectory, fleetSize, fleet_first_site(), fleet_site_spacing());
+
+			auto const fleetStart = Clock::now();
+			for (std::uint64_t i = 1; i <= steps; ++i) {
+				fleet.update(float(double(i) * double(LaunchSimulation::kTimeStep)));
+			}
+			auto const fleetTime = std::chrono::duration_cast<Secondsf>(Clock::now() - fleetStart).count();
+
+			double const updates = double(std::max<std::uint64_t>(steps, 1));
+			std::printf("Fleet of %zu rockets on %zu threads: %.3f ms per update, %.1f M rocket updates/s\n",
+				fleet.size(), fleet.thread_count(), fleetTime * 1000.0 / updates,
+				fleetTime > 0.f ? double(fleet.size()) * double(steps) / fleetTime * 1e-6 : 0.0);
+		}
+
+		return 0;
+	}
+
+	int bench_mesh(std::size_t iterations) {
+		//the full detail rocket. the arena is only filled, never uploaded, so no
+		//OpenGL context is needed
+		MeshArena arena;
+		MeshRegistry registry(arena);
+		auto const placed = spaceship_parts(registry, kSpaceshipLodSubdivs_[0]);
+
+		//the parts with their placement applied, as the generators used to return them
+		std::vector<SimpleMeshData> parts;
+		for (auto const& part : placed) {
+			MeshBuilder single;
+			single.add(registry.data(part.mesh), part.model2Object);
+			parts.emplace_back(single.build());
+		}
+
+		//the chain of concatenate() calls the rocket used to be built with
+		std::size_t chainVertices = 0;
+		auto const chainStart = Clock::now();
+		for (std::size_t i = 0; i < iterations; ++i) {
+			SimpleMeshData ship = parts[0];
+			for (std::size_t j = 1; j < parts.size(); ++j) {
+				ship = concatenate(std::move(ship), parts[j]);
+			}
+			chainVertices += ship.positions.size();
+		}
+		auto const chainTime = std::chrono::duration_cast<Secondsf>(Clock::now() - chainStart).count();
+
+		//the same with one reservation
+		MeshBuilder builder;
+		for (auto const& part : parts) {
+			builder.add(part);
+		}
+
+		std::size_t builderVertices = 0;
+		auto const builderStart = Clock::now();
+		for (std::size_t i = 0; i < iterations; ++i) {
+			builderVertices += builder.build().positions.size();
+		}
+		auto const builderTime = std::chrono::duration_cast<Secondsf>(Clock::now() - builderStart).count();
+
+		//both again, this time into a mesh arena, so both paths include merging the vertices:
+		//MeshArena::add() merges the concatenated soup, build_indexed() merges while building
+		std::size_t chainIndices = 0, chainUnique = 0;
+		auto const chainArenaStart = Clock::now();
+		for (std::size_t i = 0; i < iterations; ++i) {
+			SimpleMeshData ship = parts[0];
+			for (std::size_t j = 1; j < parts.size(); ++j) {
+				ship = concatenate(std::move(ship), parts[j]);
+			}
+			MeshArena target;
+			target.add(ship);
+			chainIndices += target.index_count();
+			chainUnique += target.vertex_count();
+		}
+		auto const chainArenaTime = std::chrono::duration_cast<Secondsf>(Clock::now() - chainArenaStart).count();
+
+		std::size_t indexedIndices = 0, indexedUnique = 0;
+		auto const indexedStart = Clock::now();
+		for (std::size_t i = 0; i < iterations; ++i) {
+			MeshArena target;
+			target.add(builder.build_indexed());
+			indexedIndices += target.index_count();
+			indexedUnique += target.vertex_count();
+		}
+		auto const indexedTime = std::chrono::duration_cast<Secondsf>(Clock::now() - indexedStart).count();
+
+		if (chainVertices != builderVertices || chainIndices != indexedIndices || chainVertices != chainIndices ||
+			chainUnique != indexedUnique)
+			throw Error("--bench-mesh: the meshes differ (%zu, %zu, %zu and %zu vertices)", chainVertices, builderVertices, chainIndices, indexedIndices);
+
+		double const perBuild = 1e6 / double(iterations);
+		std::printf("Rocket mesh: %zu parts, %zu vertices, %zu builds\n", parts.size(), chainVertices / iterations, iterations);
+		std::printf("Merged mesh:\n");
+		std::printf("  concatenate() chain\t\t%.1f us per build\n", chainTime * perBuild);
+		std::printf("  MeshBuilder::build()\t\t%.1f us per build\n", builderTime * perBuild);
+		std::printf("Into a MeshArena (indexed):\n");
+		std::printf("  concatenate() + add()\t\t%.1f us per build\n", chainArenaTime * perBuild);
+		std::printf("  build_indexed() + add()\t%.1f us per build\n", indexedTime * perBuild);
+		return 0;
+	}
+
 }
 
 namespace
@@ -0,0 +1,282 @@
+#include "mesh_arena.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include <cmath>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+	// hash the raw bytes of a vertex (FNV-1a). Vertices are only merged if
+	// they are bit-identical, so this matches the memcmp() equality below.
+	template< typename tVertex >
+	struct VertexHash_
+	{
+		std::size_t operator() (tVertex const& aVertex) const noexcept
+		{
+			auto const* bytes = reinterpret_cast<unsigned char const*>(&aVertex);
+
+			std::uint64_t hash = 14695981039346656037ull;
+			for( std::size_t i = 0; i < sizeof(tVertex); ++i )
+			{
+				hash ^= bytes[i];
+				hash *= 1099511628211ull;
+			}
+			return std::size_t(hash);
+		}
+	};
+	template< typename tVertex >
+	struct VertexEqual_
+	{
+		bool operator() (tVertex const& aLeft, tVertex const& aRight) const noexcept
+		{
+			return 0 == std::memcmp( &aLeft, &aRight, sizeof(tVertex) );
+		}
+	};
+}
+
+MeshArena::MeshArena()
+	: mVertexCount( 0 )
+	, mIndexCount( 0 )
+	, mVertexCapacity( 0 )
+	, mIndexCapacity( 0 )
+	, mVao( 0 )
+	, mVertexBuffer( 0 )
+	, mIndexBuffer( 0 )
+	, mBufferRevision( 0 )
+{}
+
+MeshArena::~MeshArena()
+{
+	if( 0 != mVao )
+		glDeleteVertexArrays( 1, &mVao );
+	if( 0 != mVertexBuffer )
+		glDeleteBuffers( 1, &mVertexBuffer );
+	if( 0 != mIndexBuffer )
+		glDeleteBuffers( 1, &mIndexBuffer );
+}
+
+MeshHandle MeshArena::add( SimpleMeshData const& aMesh )
+{
+	assert( 0 == mVao ); // can't add meshes after upload(), see replace()
+
+	return append_( aMesh, mVertices, mIndices, mVertices.size(), mIndices.size() );
+}
+
+MeshHandle MeshArena::add( IndexedMeshData const& aMesh )
+{
+	assert( 0 == mVao ); // can't add meshes after upload(), see replace()
+
+	auto const& src = aMesh.vertices;
+
+	MeshHandle ret{};
+	ret.firstIndex = GLuint(mIndices.size());
+	ret.baseVertex = GLint(mVertices.size());
+	ret.indexCount = GLuint(aMesh.indices.size());
+
+	mVertices.reserve( mVertices.size() + src.positions.size() );
+	for( std::size_t i = 0; i < src.positions.size(); ++i )
+	{
+		// missing attributes are zero, same as above
+		Vertex_ vert{};
+		vert.position = src.positions[i];
+		if( i < src.colors.size() )
+			vert.color = src.colors[i];
+		if( i < src.normals.size() )
+			vert.normal = src.normals[i];
+		if( i < src.texcoords.size() )
+			vert.texcoord = src.texcoords[i];
+		mVertices.emplace_back( vert );
+	}
+	mIndices.insert( mIndices.end(), aMesh.indices.begin(), aMesh.indices.end() );
+
+	compute_bounds_( ret, src.positions );
+	return ret;
+}
+
+MeshHandle MeshArena::replace( MeshHandle const& aOld, SimpleMeshData const& aMesh )
+{
+	assert( 0 != mVao );
+	(void)aOld; // the old range is simply no longer referenced
+
+	std::vector<Vertex_> vertices;
+	std::vector<GLuint> indices;
+	auto const ret = append_( aMesh, vertices, indices, mVertexCount, mIndexCount );
+
+	grow_( mVertexBuffer, mVertexCapacity, mVertexCount * sizeof(Vertex_), vertices.size() * sizeof(Vertex_) );
+	grow_( mIndexBuffer, mIndexCapacity, mIndexCount * sizeof(GLuint), indices.size() * sizeof(GLuint) );
+
+	glBindBuffer( GL_COPY_WRITE_BUFFER, mVertexBuffer );
+	glBufferSubData( GL_COPY_WRITE_BUFFER, mVertexCount * sizeof(Vertex_), vertices.size() * sizeof(Vertex_), vertices.data() );
+	glBindBuffer( GL_COPY_WRITE_BUFFER, mIndexBuffer );
+	glBufferSubData( GL_COPY_WRITE_BUFFER, mIndexCount * sizeof(GLuint), indices.size() * sizeof(GLuint), indices.data() );
+	glBindBuffer( GL_COPY_WRITE_BUFFER, 0 );
+
+	// the buffers may have been reallocated
+	setup_vao_();
+
+	mVertexCount += vertices.size();
+	mIndexCount += indices.size();
+
+	return ret;
+}
+
+MeshHandle MeshArena::append_( SimpleMeshData const& aMesh, std::vector<Vertex_>& aVertices, std::vector<GLuint>& aIndices, std::size_t aBaseVertex, std::size_t aFirstIndex )
+{
+	MeshHandle ret{};
+	ret.firstIndex = GLuint(aFirstIndex);
+	ret.baseVertex = GLint(aBaseVertex);
+
+	// Indices are relative to baseVertex, so the dedup map is per mesh
+	std::unordered_map<Vertex_, GLuint, VertexHash_<Vertex_>, VertexEqual_<Vertex_>> unique;
+	unique.reserve( aMesh.positions.size() );
+
+	std::size_t const vertexStart = aVertices.size();
+	std::size_t const indexStart = aIndices.size();
+
+	for( std::size_t i = 0; i < aMesh.positions.size(); ++i )
+	{
+		// Not all generators fill every attribute (e.g. the procedural
+		// shapes have no texture coordinates). Missing ones are zero.
+		Vertex_ vert{};
+		vert.position = aMesh.positions[i];
+		if( i < aMesh.colors.size() )
+			vert.color = aMesh.colors[i];
+		if( i < aMesh.normals.size() )
+			vert.normal = aMesh.normals[i];
+		if( i < aMesh.texcoords.size() )
+			vert.texcoord = aMesh.texcoords[i];
+
+		auto const [it, inserted] = unique.emplace( vert, GLuint(aVertices.size() - vertexStart) );
+		if( inserted )
+			aVertices.emplace_back( vert );
+
+		aIndices.emplace_back( it->second );
+	}
+
+	ret.indexCount = GLuint(aIndices.size() - indexStart);
+
+	compute_bounds_( ret, aMesh.positions );
+	return ret;
+}
+
+void MeshArena::compute_bounds_( MeshHandle& aHandle, std::vector<Vec3f> const& aPositions )
+{
+	Vec3f bmin = aPositions.empty() ? Vec3f{} : aPositions[0];
+	Vec3f bmax = bmin;
+
+	for( auto const& p : aPositions )
+	{
+		bmin = Vec3f{ std::fmin( bmin.x, p.x ), std::fmin( bmin.y, p.y ), std::fmin( bmin.z, p.z ) };
+		bmax = Vec3f{ std::fmax( bmax.x, p.x ), std::fmax( bmax.y, p.y ), std::fmax( bmax.z, p.z ) };
+	}
+
+	aHandle.boundsCenter = 0.5f * (bmin + bmax);
+	aHandle.boundsRadius = 0.f;
+	for( auto const& p : aPositions )
+		aHandle.boundsRadius = std::fmax( aHandle.boundsRadius, length( p - aHandle.boundsCenter ) );
+}
+
+void MeshArena::upload()
+{
+	assert( 0 == mVao );
+
+	glGenBuffers( 1, &mVertexBuffer );
+	glBindBuffer( GL_ARRAY_BUFFER, mVertexBuffer );
+	glBufferData( GL_ARRAY_BUFFER, mVertices.size() * sizeof(Vertex_), mVertices.data(), GL_STATIC_DRAW );
+
+	glGenBuffers( 1, &mIndexBuffer );
+	glBindBuffer( GL_ARRAY_BUFFER, mIndexBuffer );
+	glBufferData( GL_ARRAY_BUFFER, mIndices.size() * sizeof(GLuint), mIndices.data(), GL_STATIC_DRAW );
+
+	glGenVertexArrays( 1, &mVao );
+	setup_vao_();
+
+	// The data now lives on the GPU; drop the CPU copies.
+	mVertexCount = mVertices.size();
+	mIndexCount = mIndices.size();
+	mVertexCapacity = mVertexCount * sizeof(Vertex_);
+	mIndexCapacity = mIndexCount * sizeof(GLuint);
+
+	mVertices = std::vector<Vertex_>();
+	mIndices = std::vector<GLuint>();
+}
+
+void MeshArena::setup_vao_()
+{
+	glBindVertexArray( mVao );
+	setup_attributes();
+	++mBufferRevision;
+
+	//reset state
+	glBindVertexArray( 0 );
+	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+}
+
+void MeshArena::setup_attributes() const
+{
+	// the element buffer binding is part of the VAO state
+	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer );
+	glBindBuffer( GL_ARRAY_BUFFER, mVertexBuffer );
+
+	GLsizei const stride = sizeof(Vertex_);
+
+	glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void const*>(offsetof(Vertex_, position)) );
+	glEnableVertexAttribArray( 0 );
+
+	glVertexAttribPointer( 1, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void const*>(offsetof(Vertex_, color)) );
+	glEnableVertexAttribArray( 1 );
+
+	glVertexAttribPointer( 2, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void const*>(offsetof(Vertex_, normal)) );
+	glEnableVertexAttribArray( 2 );
+
+	glVertexAttribPointer( 3, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void const*>(offsetof(Vertex_, texcoord)) );
+	glEnableVertexAttribArray( 3 );
+}
+
+void MeshArena::grow_( GLuint& aBuffer, std::size_t& aCapacity, std::size_t aUsed, std::size_t aExtra )
+{
+	if( aUsed + aExtra <= aCapacity )
+		return;
+
+	// grow geometrically, in case several meshes are replaced in a row
+	std::size_t const capacity = std::max( aUsed + aExtra, 2*aCapacity );
+
+	GLuint buffer = 0;
+	glGenBuffers( 1, &buffer );
+	glBindBuffer( GL_COPY_WRITE_BUFFER, buffer );
+	glBufferData( GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STATIC_DRAW );
+
+	glBindBuffer( GL_COPY_READ_BUFFER, aBuffer );
+	glCopyBufferSubData( GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, aUsed );
+
+	glBindBuffer( GL_COPY_READ_BUFFER, 0 );
+	glBindBuffer( GL_COPY_WRITE_BUFFER, 0 );
+
+	glDeleteBuffers( 1, &aBuffer );
+	aBuffer = buffer;
+	aCapacity = capacity;
+}
+
+GLuint MeshArena::vao() const noexcept
+{
+	return mVao;
+}
+std::size_t MeshArena::buffer_revision() const noexcept
+{
+	return mBufferRevision;
+}
+
+std::size_t MeshArena::vertex_count() const noexcept
+{
+	return 0 != mVao ? mVertexCount : mVertices.size();
+}
+std::size_t MeshArena::index_count() const noexcept
+{
+	return 0 != mVao ? mIndexCount : mIndices.size();
+}
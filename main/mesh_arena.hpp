@@ -0,0 +1,106 @@
+#ifndef MESH_ARENA_HPP_34EB9EAE_CDE3_4305_A061_6512A176696E
+#define MESH_ARENA_HPP_34EB9EAE_CDE3_4305_A061_6512A176696E
+
+#include <glad.h>
+
+#include <vector>
+
+#include "simple_mesh.hpp"
+
+#include "../vmlib/vec2.hpp"
+#include "../vmlib/vec3.hpp"
+
+// Location of a mesh inside a MeshArena. The first three members map directly
+// onto the fields of a DrawElementsIndirectCommand.
+struct MeshHandle
+{
+	GLuint indexCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+
+	// bounding sphere in model space, used for culling
+	Vec3f boundsCenter;
+	float boundsRadius;
+};
+
+/* MeshArena: one shared vertex/index buffer for all static meshes
+ *
+ * Meshes are added as SimpleMeshData (unindexed triangle soup), whose
+ * duplicate vertices are merged, or as IndexedMeshData. Either way, the mesh
+ * is appended to a single interleaved vertex buffer and a single index
+ * buffer. After upload(), all meshes can be drawn from the same buffers,
+ * which is what allows the DrawList to submit them with one
+ * glMultiDrawElementsIndirect().
+ *
+ * After upload(), meshes can only be swapped with replace() (used for hot
+ * reloading assets).
+ *
+ * The VAO uses the same attribute locations as create_vao():
+ *   0 = position, 1 = color, 2 = normal, 3 = texcoord
+ * VAOs that need further attributes (see DrawList) are separate VAOs over the
+ * same buffers, set up with setup_attributes().
+ */
+class MeshArena final
+{
+	public:
+		MeshArena();
+		~MeshArena();
+
+		MeshArena( MeshArena const& ) = delete;
+		MeshArena& operator= (MeshArena const&) = delete;
+
+	public:
+		MeshHandle add( SimpleMeshData const& );
+
+		// Add a mesh that is already indexed (see MeshBuilder). Its
+		// vertices are used as they are, without merging duplicates.
+		MeshHandle add( IndexedMeshData const& );
+
+		// Create the GL buffers. No more meshes can be added afterwards.
+		void upload();
+
+		// After upload(): store aMesh in place of aOld and return its new
+		// handle. The new data is appended (growing the buffers as needed);
+		// aOld's range is left unused, which is fine for the occasional
+		// reload during development. Leaves the VAO unbound.
+		MeshHandle replace( MeshHandle const& aOld, SimpleMeshData const& aMesh );
+
+		GLuint vao() const noexcept;
+
+		// Bind the index buffer to the currently bound VAO and set up its
+		// attributes 0-3 as in vao(). Leaves the vertex buffer bound to
+		// GL_ARRAY_BUFFER. Has to be repeated whenever buffer_revision()
+		// changes, as replace() may reallocate the buffers.
+		void setup_attributes() const;
+		std::size_t buffer_revision() const noexcept;
+
+		std::size_t vertex_count() const noexcept;
+		std::size_t index_count() const noexcept;
+
+	private:
+		struct Vertex_
+		{
+			Vec3f position;
+			Vec3f color;
+			Vec3f normal;
+			Vec2f texcoord;
+		};
+
+		static MeshHandle append_( SimpleMeshData const&, std::vector<Vertex_>&, std::vector<GLuint>&, std::size_t aBaseVertex, std::size_t aFirstIndex );
+		static void compute_bounds_( MeshHandle&, std::vector<Vec3f> const& aPositions );
+		void setup_vao_();
+		static void grow_( GLuint& aBuffer, std::size_t& aCapacity, std::size_t aUsed, std::size_t aExtra );
+
+		std::vector<Vertex_> mVertices;
+		std::vector<GLuint> mIndices;
+
+		std::size_t mVertexCount, mIndexCount;
+		std::size_t mVertexCapacity, mIndexCapacity; // in bytes
+
+		GLuint mVao;
+		GLuint mVertexBuffer;
+		GLuint mIndexBuffer;
+		std::size_t mBufferRevision;
+};
+
+#endif // MESH_ARENA_HPP_34EB9EAE_CDE3_4305_A061_6512A176696E
@@ -0,0 +1,219 @@
+#include "mesh_builder.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#include "../vmlib/vec4.hpp"
+#include "../vmlib/mat33.hpp"
+
+namespace
+{
+	struct Vertex_
+	{
+		Vec3f position;
+		Vec3f color;
+		Vec3f normal;
+		Vec2f texcoord;
+	};
+
+	static_assert( sizeof(Vertex_) == 11*sizeof(float), "Vertex_ has no padding" );
+
+	constexpr GLuint kEmptySlot_ = ~GLuint(0);
+
+	// Vertices are only merged if they are bit-identical, same as in
+	// MeshArena::add(). FNV-1a over 32-bit words rather than bytes, folded
+	// so that the low bits (the slot) depend on all of them.
+	std::size_t hash_( Vertex_ const& aVertex ) noexcept
+	{
+		std::uint32_t words[sizeof(Vertex_) / sizeof(std::uint32_t)];
+		std::memcpy( words, &aVertex, sizeof(Vertex_) );
+
+		std::uint64_t hash = 14695981039346656037ull;
+		for( auto const word : words )
+		{
+			hash ^= word;
+			hash *= 1099511628211ull;
+		}
+		return std::size_t(hash ^ (hash >> 32));
+	}
+	bool same_( Vertex_ const& aLeft, Vertex_ const& aRight ) noexcept
+	{
+		return 0 == std::memcmp( &aLeft, &aRight, sizeof(Vertex_) );
+	}
+
+	template< typename tValue >
+	void reserve_if_( bool aUsed, std::vector<tValue>& aValues, std::size_t aCount )
+	{
+		if( aUsed )
+			aValues.reserve( aCount );
+	}
+}
+
+MeshBuilder::MeshBuilder()
+	: mVertexCount( 0 )
+	, mHasColors( false )
+	, mHasNormals( false )
+	, mHasTexcoords( false )
+{}
+
+void MeshBuilder::add( SimpleMeshData const& aMesh )
+{
+	mParts.emplace_back( Part_{ &aMesh, kIdentity44f, false } );
+	mVertexCount += aMesh.positions.size();
+
+	mHasColors = mHasColors || !aMesh.colors.empty();
+	mHasNormals = mHasNormals || !aMesh.normals.empty();
+	mHasTexcoords = mHasTexcoords || !aMesh.texcoords.empty();
+}
+
+void MeshBuilder::add( SimpleMeshData const& aMesh, Mat44f const& aTransform )
+{
+	add( aMesh );
+
+	mParts.back().transform = aTransform;
+	mParts.back().transformed = true;
+}
+
+void MeshBuilder::clear() noexcept
+{
+	mParts.clear();
+	mVertexCount = 0;
+	mHasColors = mHasNormals = mHasTexcoords = false;
+}
+
+std::size_t MeshBuilder::part_count() const noexcept
+{
+	return mParts.size();
+}
+std::size_t MeshBuilder::vertex_count() const noexcept
+{
+	return mVertexCount;
+}
+
+SimpleMeshData MeshBuilder::build() const
+{
+	SimpleMeshData ret;
+	ret.positions.reserve( mVertexCount );
+	reserve_if_( mHasColors, ret.colors, mVertexCount );
+	reserve_if_( mHasNormals, ret.normals, mVertexCount );
+	reserve_if_( mHasTexcoords, ret.texcoords, mVertexCount );
+
+	for( auto const& part : mParts )
+	{
+		auto const& mesh = *part.mesh;
+		std::size_t const count = mesh.positions.size();
+
+		if( part.transformed )
+		{
+			Mat33f const N = mat44_to_mat33( normal_matrix( part.transform ) );
+
+			for( auto const& p : mesh.positions )
+			{
+				Vec4f const t = part.transform * Vec4f{ p.x, p.y, p.z, 1.f };
+				ret.positions.emplace_back( Vec3f{ t.x, t.y, t.z } );
+			}
+			if( mHasNormals )
+			{
+				for( std::size_t i = 0; i < count; ++i )
+					ret.normals.emplace_back( i < mesh.normals.size() ? N * mesh.normals[i] : Vec3f{} );
+			}
+		}
+		else
+		{
+			ret.positions.insert( ret.positions.end(), mesh.positions.begin(), mesh.positions.end() );
+			if( mHasNormals )
+			{
+				ret.normals.insert( ret.normals.end(), mesh.normals.begin(), mesh.normals.end() );
+				ret.normals.resize( ret.positions.size() );
+			}
+		}
+
+		if( mHasColors )
+		{
+			ret.colors.insert( ret.colors.end(), mesh.colors.begin(), mesh.colors.end() );
+			ret.colors.resize( ret.positions.size() );
+		}
+		if( mHasTexcoords )
+		{
+			ret.texcoords.insert( ret.texcoords.end(), mesh.texcoords.begin(), mesh.texcoords.end() );
+			ret.texcoords.resize( ret.positions.size() );
+		}
+	}
+
+	return ret;
+}
+
+IndexedMeshData MeshBuilder::build_indexed() const
+{
+	IndexedMeshData ret;
+	ret.indices.reserve( mVertexCount );
+
+	// Open addressing: each slot holds an index into unique, or kEmptySlot_.
+	// The table is at most half full, so the linear probes stay short, and
+	// unlike a node-based map nothing is allocated per vertex.
+	std::size_t slotCount = 16;
+	while( slotCount < 2*mVertexCount )
+		slotCount *= 2;
+	std::size_t const slotMask = slotCount - 1;
+	std::vector<GLuint> slots( slotCount, kEmptySlot_ );
+
+	std::vector<Vertex_> unique;
+	unique.reserve( mVertexCount );
+
+	for( auto const& part : mParts )
+	{
+		auto const& mesh = *part.mesh;
+		Mat33f const N = mat44_to_mat33( normal_matrix( part.transform ) );
+
+		for( std::size_t i = 0; i < mesh.positions.size(); ++i )
+		{
+			Vertex_ vert{};
+			vert.position = mesh.positions[i];
+			if( i < mesh.colors.size() )
+				vert.color = mesh.colors[i];
+			if( i < mesh.normals.size() )
+				vert.normal = mesh.normals[i];
+			if( i < mesh.texcoords.size() )
+				vert.texcoord = mesh.texcoords[i];
+
+			if( part.transformed )
+			{
+				Vec4f const t = part.transform * Vec4f{ vert.position.x, vert.position.y, vert.position.z, 1.f };
+				vert.position = Vec3f{ t.x, t.y, t.z };
+				vert.normal = N * vert.normal;
+			}
+
+			std::size_t slot = hash_( vert ) & slotMask;
+			while( kEmptySlot_ != slots[slot] && !same_( unique[slots[slot]], vert ) )
+				slot = (slot + 1) & slotMask;
+
+			if( kEmptySlot_ == slots[slot] )
+			{
+				slots[slot] = GLuint(unique.size());
+				unique.emplace_back( vert );
+			}
+
+			ret.indices.emplace_back( slots[slot] );
+		}
+	}
+
+	// The unique vertices in order of first use, same as MeshArena::add()
+	auto& out = ret.vertices;
+	out.positions.reserve( unique.size() );
+	reserve_if_( mHasColors, out.colors, unique.size() );
+	reserve_if_( mHasNormals, out.normals, unique.size() );
+	reserve_if_( mHasTexcoords, out.texcoords, unique.size() );
+
+	for( auto const& vert : unique )
+	{
+		out.positions.emplace_back( vert.position );
+		if( mHasColors )
+			out.colors.emplace_back( vert.color );
+		if( mHasNormals )
+			out.normals.emplace_back( vert.normal );
+		if( mHasTexcoords )
+			out.texcoords.emplace_back( vert.texcoord );
+	}
+
+	return ret;
+}
@@ -0,0 +1,60 @@
+#ifndef MESH_BUILDER_HPP_CBD13EDF_DF68_4902_8DAF_7BFC3DEBF300
+#define MESH_BUILDER_HPP_CBD13EDF_DF68_4902_8DAF_7BFC3DEBF300
+
+#include <vector>
+
+#include <cstddef>
+
+#include "simple_mesh.hpp"
+
+#include "../vmlib/mat44.hpp"
+
+/* MeshBuilder: merge several meshes into one
+ *
+ * Replaces chains of concatenate(), which copy the mesh built so far once
+ * per part and grow its vectors step by step. The builder only records the
+ * parts (by reference, optionally with a transform to apply to them). build()
+ * then knows the final size, reserves it once, and writes every vertex
+ * exactly once. build_indexed() does the same, but merges identical vertices
+ * and produces indices, ready for MeshArena::add().
+ *
+ * An attribute (colors, normals, texcoords) is output if any part has it;
+ * parts without it get zeros, as in concatenate().
+ *
+ * The added meshes must stay alive until the last build.
+ */
+class MeshBuilder final
+{
+	public:
+		MeshBuilder();
+
+	public:
+		void add( SimpleMeshData const& );
+
+		// Add a part placed with aTransform. Normals are transformed with
+		// its inverse transpose, the same as the shapes' pre-transforms.
+		void add( SimpleMeshData const&, Mat44f const& aTransform );
+
+		void clear() noexcept;
+
+		std::size_t part_count() const noexcept;
+		std::size_t vertex_count() const noexcept;
+
+		SimpleMeshData build() const;
+		IndexedMeshData build_indexed() const;
+
+	private:
+		struct Part_
+		{
+			SimpleMeshData const* mesh;
+			Mat44f transform;
+			bool transformed;
+		};
+
+		std::vector<Part_> mParts;
+		std::size_t mVertexCount;
+
+		bool mHasColors, mHasNormals, mHasTexcoords;
+};
+
+#endif // MESH_BUILDER_HPP_CBD13EDF_DF68_4902_8DAF_7BFC3DEBF300
@@ -0,0 +1,104 @@
+#include "mesh_registry.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#include "primitives.hpp"
+#include "mesh_builder.hpp"
+
+#include "../support/error.hpp"
+
+MeshRegistry::MeshRegistry( MeshArena& aArena )
+	: mArena( &aArena )
+	, mRequests( 0 )
+{}
+
+MeshHandle const& MeshRegistry::cylinder( std::size_t aSubdivs, Vec3f aColor )
+{
+	return get_( Key_{ Generator_::cylinder, aSubdivs, aColor } );
+}
+MeshHandle const& MeshRegistry::cube( Vec3f aColor )
+{
+	return get_( Key_{ Generator_::cube, 0, aColor } );
+}
+MeshHandle const& MeshRegistry::pyramid( Vec3f aColor )
+{
+	return get_( Key_{ Generator_::pyramid, 0, aColor } );
+}
+
+IndexedMeshData MeshRegistry::bake( std::vector<PlacedMesh> const& aParts ) const
+{
+	MeshBuilder builder;
+	for( auto const& part : aParts )
+		builder.add( data( part.mesh ), part.model2Object );
+
+	return builder.build_indexed();
+}
+
+SimpleMeshData const& MeshRegistry::data( MeshHandle const& aMesh ) const
+{
+	auto const it = mByFirstIndex.find( aMesh.firstIndex );
+	if( mByFirstIndex.end() == it )
+		throw Error( "MeshRegistry: mesh at index %u is not from this registry", aMesh.firstIndex );
+
+	return it->second->data;
+}
+
+std::size_t MeshRegistry::shape_count() const noexcept
+{
+	return mEntries.size();
+}
+std::size_t MeshRegistry::request_count() const noexcept
+{
+	return mRequests;
+}
+
+MeshHandle const& MeshRegistry::get_( Key_ const& aKey )
+{
+	++mRequests;
+
+	auto const it = mEntries.find( aKey );
+	if( mEntries.end() != it )
+		return it->second.handle;
+
+	Entry_ entry;
+	switch( aKey.generator )
+	{
+		case Generator_::cylinder:
+			entry.data = make_primitive_cylinder( aKey.subdivs, aKey.color );
+			break;
+		case Generator_::cube:
+			entry.data = to_mesh_data( kCubePrimitive, aKey.color );
+			break;
+		case Generator_::pyramid:
+			entry.data = to_mesh_data( kPyramidPrimitive, aKey.color );
+			break;
+	}
+	entry.handle = mArena->add( entry.data );
+
+	// references to unordered_map elements stay valid as it grows
+	auto const& stored = mEntries.emplace( aKey, std::move(entry) ).first->second;
+	mByFirstIndex.emplace( stored.handle.firstIndex, &stored );
+	return stored.handle;
+}
+
+bool MeshRegistry::Key_::operator== ( Key_ const& aOther ) const noexcept
+{
+	return generator == aOther.generator
+		&& subdivs == aOther.subdivs
+		&& 0 == std::memcmp( &color, &aOther.color, sizeof(Vec3f) );
+}
+
+std::size_t MeshRegistry::KeyHash_::operator() ( Key_ const& aKey ) const noexcept
+{
+	static_assert( sizeof(Vec3f) == 3*sizeof(std::uint32_t), "Vec3f is three floats" );
+
+	std::uint32_t bits[3];
+	std::memcpy( bits, &aKey.color, sizeof(bits) );
+
+	// FNV-1a over the parameters
+	std::uint64_t h = 0xcbf29ce484222325ull;
+	for( std::uint64_t const v : { std::uint64_t(aKey.generator), std::uint64_t(aKey.subdivs), std::uint64_t(bits[0]), std::uint64_t(bits[1]), std::uint64_t(bits[2]) } )
+		h = (h ^ v) * 0x100000001b3ull;
+	return std::size_t(h);
+}
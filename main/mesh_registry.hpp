@@ -0,0 +1,105 @@
+#ifndef MESH_REGISTRY_HPP_4EBB56E3_5C60_41DD_8842_1E42ADB81A6E
+#define MESH_REGISTRY_HPP_4EBB56E3_5C60_41DD_8842_1E42ADB81A6E
+
+#include <glad.h>
+
+#include <vector>
+#include <unordered_map>
+
+#include <cstddef>
+
+#include "mesh_arena.hpp"
+#include "simple_mesh.hpp"
+
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/mat44.hpp"
+
+// A mesh and where it goes, relative to the object it is part of
+struct PlacedMesh
+{
+	MeshHandle mesh;
+	Mat44f model2Object;
+};
+
+/* MeshRegistry: procedural meshes, generated once per distinct shape
+ *
+ * The generators in shapes.hpp bake their pre-transform into the vertices,
+ * so each placement of a shape is a separate copy of it. The registry instead
+ * generates each shape once, in its canonical (unit) form, keyed by the
+ * generator and its parameters, and adds it to a MeshArena. Repeated requests
+ * return the same handle. Placements become per-object transforms instead
+ * (DrawList, InstanceBuffer or a model-to-world uniform). The canonical forms
+ * are copied from the compile-time primitives in primitives.hpp, where one
+ * exists, rather than generated.
+ *
+ * The vertex data of each shape is kept, so that bake() can still merge a set
+ * of placements into a single mesh (with a MeshBuilder) where one draw per
+ * object matters more than memory (e.g. instanced drawing).
+ *
+ * Shapes can only be requested before MeshArena::upload().
+ */
+class MeshRegistry final
+{
+	public:
+		explicit MeshRegistry( MeshArena& );
+
+		MeshRegistry( MeshRegistry const& ) = delete;
+		MeshRegistry& operator= (MeshRegistry const&) = delete;
+
+	public:
+		// Same as make_cylinder(), make_cube() and make_pyramid() without
+		// a pre-transform
+		MeshHandle const& cylinder( std::size_t aSubdivs, Vec3f aColor = { 1.f, 1.f, 1.f } );
+		MeshHandle const& cube( Vec3f aColor = { 1.f, 1.f, 1.f } );
+		MeshHandle const& pyramid( Vec3f aColor = { 1.f, 1.f, 1.f } );
+
+		// Merge the placed shapes (all from this registry) into one mesh,
+		// with the placements applied to the vertices. The result is not
+		// added to the arena.
+		IndexedMeshData bake( std::vector<PlacedMesh> const& ) const;
+
+		// Vertex data of a shape from this registry
+		SimpleMeshData const& data( MeshHandle const& ) const;
+
+		// Distinct shapes generated, and shapes requested in total
+		std::size_t shape_count() const noexcept;
+		std::size_t request_count() const noexcept;
+
+	private:
+		enum class Generator_
+		{
+			cylinder,
+			cube,
+			pyramid
+		};
+
+		struct Key_
+		{
+			Generator_ generator;
+			std::size_t subdivs;
+			Vec3f color;
+
+			bool operator== (Key_ const&) const noexcept;
+		};
+		struct KeyHash_
+		{
+			std::size_t operator() (Key_ const&) const noexcept;
+		};
+
+		struct Entry_
+		{
+			MeshHandle handle;
+			SimpleMeshData data;
+		};
+
+		MeshHandle const& get_( Key_ const& );
+
+		MeshArena* mArena;
+
+		std::unordered_map<Key_, Entry_, KeyHash_> mEntries;
+		std::unordered_map<GLuint, Entry_ const*> mByFirstIndex;
+
+		std::size_t mRequests;
+};
+
+#endif // MESH_REGISTRY_HPP_4EBB56E3_5C60_41DD_8842_1E42ADB81A6E
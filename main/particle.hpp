@@ -10,15 +10,15 @@
 
 struct Particle
 {
-	SimpleMeshData particledraw;
+	Mat44f placement; //of the shared particle cube, relative to the exhaust
 	Vec3f acceleration;
 	float lifespan;
 	
 };
 
 float random(float upper, float lower);
-Particle createParticles(Mat44f aPreTransform);
-void runParticles(std::vector<Particle>&particles, unsigned int lastUsedParticle);
+Particle createParticles(Mat44f aPlacement);
+void runParticles(std::vector<Particle>&particles, unsigned int lastUsedParticle, float dt);
 unsigned int FirstUnusedParticle(const std::vector<Particle>& particles, unsigned int lastUsedParticle);
 void RespawnParticle(std::vector<Particle>& particles, unsigned int unusedParticle, float offset);
 
@@ -0,0 +1,17 @@
+#include "primitives.hpp"
+
+#include "shapes.hpp"
+
+SimpleMeshData make_primitive_cylinder( std::size_t aSubdivs, Vec3f aColor )
+{
+	switch( aSubdivs )
+	{
+		case 3: return to_mesh_data( kCylinderPrimitive<3>, aColor );
+		case 6: return to_mesh_data( kCylinderPrimitive<6>, aColor );
+		case 12: return to_mesh_data( kCylinderPrimitive<12>, aColor );
+		case 32: return to_mesh_data( kCylinderPrimitive<32>, aColor );
+		case 128: return to_mesh_data( kCylinderPrimitive<128>, aColor );
+	}
+
+	return make_cylinder( aSubdivs, aColor );
+}
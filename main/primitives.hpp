@@ -0,0 +1,199 @@
+#ifndef PRIMITIVES_HPP_56F480C3_FB0F_4F25_82F6_1773D8B34A6D
+#define PRIMITIVES_HPP_56F480C3_FB0F_4F25_82F6_1773D8B34A6D
+
+#include <array>
+#include <vector>
+
+#include <cstddef>
+
+#include "simple_mesh.hpp"
+
+#include "../vmlib/vec3.hpp"
+
+/* Primitive: vertex data of a fixed shape, generated at compile time
+ *
+ * The same triangles as make_cube(), make_pyramid() and make_cylinder() (see
+ * shapes.hpp) without a pre-transform, but as constexpr std::arrays. The
+ * shapes are generated by the compiler and end up as read-only data in the
+ * executable, instead of being built vertex by vertex at startup. The color
+ * is not part of the data; to_mesh_data() adds it.
+ *
+ * The cylinder takes its subdivision count as a template argument. The
+ * sines and cosines are computed in double precision and rounded, so they
+ * match the runtime generator to within one ulp (see vmlib-test).
+ */
+template< std::size_t tCount >
+struct Primitive
+{
+	static constexpr std::size_t kVertexCount = tCount;
+
+	std::array<Vec3f, tCount> positions;
+	std::array<Vec3f, tCount> normals;
+};
+
+namespace detail
+{
+	constexpr double kPi = 3.14159265358979323846;
+
+	// Taylor series; arguments are reduced to [-pi,pi] first, where 16 terms
+	// are enough for double precision
+	constexpr double reduce( double aX ) noexcept
+	{
+		while( aX > kPi )
+			aX -= 2.*kPi;
+		while( aX < -kPi )
+			aX += 2.*kPi;
+		return aX;
+	}
+	constexpr float cos( float aX ) noexcept
+	{
+		double const x = reduce( aX ), x2 = x*x;
+		double term = 1., sum = 1.;
+		for( int i = 1; i < 16; ++i )
+		{
+			term *= -x2 / double((2*i-1) * (2*i));
+			sum += term;
+		}
+		return float(sum);
+	}
+	constexpr float sin( float aX ) noexcept
+	{
+		double const x = reduce( aX ), x2 = x*x;
+		double term = x, sum = x;
+		for( int i = 1; i < 16; ++i )
+		{
+			term *= -x2 / double((2*i) * (2*i+1));
+			sum += term;
+		}
+		return float(sum);
+	}
+
+	// All three generators use the position as the normal
+	template< std::size_t tCount >
+	constexpr void emit( Primitive<tCount>& aPrim, std::size_t& aIndex, Vec3f aPosition ) noexcept
+	{
+		aPrim.positions[aIndex] = aPosition;
+		aPrim.normals[aIndex] = aPosition;
+		++aIndex;
+	}
+}
+
+// Same as make_cube(): a unit cube centered on the origin
+constexpr Primitive<36> make_cube_primitive() noexcept
+{
+	constexpr float h = 0.5f;
+	constexpr Vec3f corners[] = {
+		{ -h, -h, +h }, { +h, -h, +h }, { +h, +h, +h }, { +h, +h, +h }, { -h, +h, +h }, { -h, -h, +h }, // front (z+)
+		{ -h, -h, -h }, { +h, +h, -h }, { +h, -h, -h }, { +h, +h, -h }, { -h, -h, -h }, { -h, +h, -h }, // back (z-)
+		{ -h, -h, -h }, { -h, -h, +h }, { -h, +h, +h }, { -h, +h, +h }, { -h, +h, -h }, { -h, -h, -h }, // left (x-)
+		{ +h, -h, -h }, { +h, +h, +h }, { +h, -h, +h }, { +h, +h, +h }, { +h, -h, -h }, { +h, +h, -h }, // right (x+)
+		{ -h, +h, -h }, { +h, +h, +h }, { +h, +h, -h }, { +h, +h, +h }, { -h, +h, -h }, { -h, +h, +h }, // top (y+)
+		{ -h, -h, -h }, { +h, -h, +h }, { +h, -h, -h }, { +h, -h, +h }, { -h, -h, -h }, { -h, -h, +h }  // bottom (y-)
+	};
+
+	Primitive<36> ret{};
+	std::size_t k = 0;
+	for( auto const& corner : corners )
+		detail::emit( ret, k, corner );
+	return ret;
+}
+
+// Same as make_pyramid(): four sides, base at y = 0, apex at y = 1
+constexpr Primitive<12> make_pyramid_primitive() noexcept
+{
+	constexpr Vec3f corners[] = {
+		{ -0.5f, 0.f, -0.5f }, { 0.5f, 0.f, -0.5f }, { 0.f, 1.f, 0.f }, // front
+		{ -0.5f, 0.f, 0.5f }, { 0.5f, 0.f, 0.5f }, { 0.f, 1.f, 0.f },   // back
+		{ -0.5f, 0.f, -0.5f }, { -0.5f, 0.f, 0.5f }, { 0.f, 1.f, 0.f }, // left
+		{ 0.5f, 0.f, -0.5f }, { 0.5f, 0.f, 0.5f }, { 0.f, 1.f, 0.f }    // right
+	};
+
+	Primitive<12> ret{};
+	std::size_t k = 0;
+	for( auto const& corner : corners )
+		detail::emit( ret, k, corner );
+	return ret;
+}
+
+// Same as make_cylinder( tSubdivs ): unit radius around the x axis, from x = 0
+// to x = 1, with caps. The angles are computed exactly as there.
+template< std::size_t tSubdivs >
+constexpr Primitive<12*tSubdivs> make_cylinder_primitive() noexcept
+{
+	static_assert( tSubdivs >= 3, "a cylinder needs at least three sides" );
+	constexpr float kPiF = 3.1415926f;
+
+	Primitive<12*tSubdivs> ret{};
+	std::size_t k = 0;
+
+	float prevY = detail::cos( 0.f );
+	float prevZ = detail::sin( 0.f );
+	for( std::size_t i = 0; i < tSubdivs; ++i )
+	{
+		float const angle = float(i + 1) / float(tSubdivs) * 2.f * kPiF;
+		float const y = detail::cos( angle );
+		float const z = detail::sin( angle );
+
+		detail::emit( ret, k, { 0.f, prevY, prevZ } );
+		detail::emit( ret, k, { 0.f, y, z } );
+		detail::emit( ret, k, { 1.f, prevY, prevZ } );
+
+		detail::emit( ret, k, { 0.f, y, z } );
+		detail::emit( ret, k, { 1.f, y, z } );
+		detail::emit( ret, k, { 1.f, prevY, prevZ } );
+
+		prevY = y;
+		prevZ = z;
+	}
+
+	// make_cylinder() computes the angles of the caps with a different
+	// expression, so the values from the sides are not reused here
+	float y = detail::cos( 0.f );
+	float z = detail::sin( 0.f );
+	for( std::size_t i = 0; i < tSubdivs; ++i )
+	{
+		float const nextAngle = float(i + 1) * 2.f * kPiF / float(tSubdivs);
+		float const nextY = detail::cos( nextAngle ), nextZ = detail::sin( nextAngle );
+
+		detail::emit( ret, k, { 0.f, 0.f, 0.f } );
+		detail::emit( ret, k, { 0.f, y, z } );
+		detail::emit( ret, k, { 0.f, nextY, nextZ } );
+
+		detail::emit( ret, k, { 1.f, 0.f, 0.f } );
+		detail::emit( ret, k, { 1.f, nextY, nextZ } );
+		detail::emit( ret, k, { 1.f, y, z } );
+
+		y = nextY;
+		z = nextZ;
+	}
+
+	return ret;
+}
+
+constexpr Primitive<36> kCubePrimitive = make_cube_primitive();
+constexpr Primitive<12> kPyramidPrimitive = make_pyramid_primitive();
+
+template< std::size_t tSubdivs >
+constexpr Primitive<12*tSubdivs> kCylinderPrimitive = make_cylinder_primitive<tSubdivs>();
+
+
+// Copy a primitive into a SimpleMeshData, with every vertex in aColor
+template< std::size_t tCount >
+SimpleMeshData to_mesh_data( Primitive<tCount> const& aPrim, Vec3f aColor )
+{
+	return SimpleMeshData{
+		std::vector<Vec3f>( aPrim.positions.begin(), aPrim.positions.end() ),
+		std::vector<Vec3f>( tCount, aColor ),
+		std::vector<Vec3f>( aPrim.normals.begin(), aPrim.normals.end() )
+	};
+}
+
+// Cylinder from a precompiled primitive if one exists for aSubdivs (see
+// kPrimitiveCylinderSubdivs), otherwise from make_cylinder()
+SimpleMeshData make_primitive_cylinder( std::size_t aSubdivs, Vec3f aColor );
+
+// Subdivision counts with a precompiled cylinder; the rocket's levels of
+// detail use these
+constexpr std::size_t kPrimitiveCylinderSubdivs[] = { 3, 6, 12, 32, 128 };
+
+#endif // PRIMITIVES_HPP_56F480C3_FB0F_4F25_82F6_1773D8B34A6D
@@ -0,0 +1,93 @@
+#include "render_origin.hpp"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#	include <emmintrin.h>
+#	define RENDER_ORIGIN_SSE2_ 1
+#endif
+
+static_assert( sizeof(Vec3d) == 3*sizeof(double), "Vec3d is three packed doubles" );
+
+namespace
+{
+	double snap_( double aX ) noexcept
+	{
+		return std::floor( aX / RenderOrigin::kCellSize + 0.5 ) * RenderOrigin::kCellSize;
+	}
+}
+
+RenderOrigin::RenderOrigin() noexcept
+	: mOrigin{ 0., 0., 0. }
+{}
+
+bool RenderOrigin::update( Vec3d aEye ) noexcept
+{
+	// Stay put until the eye is a full cell away on some axis. Snapping to
+	// the nearest cell center every frame would flip back and forth when the
+	// eye moves along a cell boundary.
+	Vec3d const offset = aEye - mOrigin;
+	if( std::abs( offset.x ) <= kCellSize && std::abs( offset.y ) <= kCellSize && std::abs( offset.z ) <= kCellSize )
+		return false;
+
+	mOrigin = Vec3d{ snap_( aEye.x ), snap_( aEye.y ), snap_( aEye.z ) };
+	return true;
+}
+
+Vec3d RenderOrigin::origin() const noexcept
+{
+	return mOrigin;
+}
+
+Vec3f RenderOrigin::to_local( Vec3d aWorld ) const noexcept
+{
+	return to_vec3f( aWorld - mOrigin );
+}
+Vec3f RenderOrigin::to_local( Vec3f aWorld ) const noexcept
+{
+	return to_vec3f( to_vec3d( aWorld ) - mOrigin );
+}
+
+Mat44f RenderOrigin::to_local( Mat44f const& aModel2World ) const noexcept
+{
+	Mat44f ret = aModel2World;
+	ret(0,3) = float( double(aModel2World(0,3)) - mOrigin.x );
+	ret(1,3) = float( double(aModel2World(1,3)) - mOrigin.y );
+	ret(2,3) = float( double(aModel2World(2,3)) - mOrigin.z );
+	return ret;
+}
+
+void RenderOrigin::to_local( Vec3d const* aWorld, std::size_t aCount, Vec3f* aOut ) const noexcept
+{
+	std::size_t i = 0;
+
+#	if defined(RENDER_ORIGIN_SSE2_)
+	// Two Vec3ds are six doubles, i.e. three registers; the origin repeats
+	// with the same period.
+	__m128d const oxy = _mm_setr_pd( mOrigin.x, mOrigin.y );
+	__m128d const ozx = _mm_setr_pd( mOrigin.z, mOrigin.x );
+	__m128d const oyz = _mm_setr_pd( mOrigin.y, mOrigin.z );
+
+	double const* in = &aWorld->x;
+	float* out = &aOut->x;
+	for( ; i+2 <= aCount; i += 2, in += 6, out += 6 )
+	{
+		__m128 const a = _mm_cvtpd_ps( _mm_sub_pd( _mm_loadu_pd( in+0 ), oxy ) );
+		__m128 const b = _mm_cvtpd_ps( _mm_sub_pd( _mm_loadu_pd( in+2 ), ozx ) );
+		__m128 const c = _mm_cvtpd_ps( _mm_sub_pd( _mm_loadu_pd( in+4 ), oyz ) );
+
+		// _mm_cvtpd_ps() puts its two results into the low half
+		_mm_storeu_ps( out, _mm_movelh_ps( a, b ) );
+		_mm_storel_pi( reinterpret_cast<__m64*>(out+4), c );
+	}
+#	endif // ~ RENDER_ORIGIN_SSE2_
+
+	for( ; i < aCount; ++i )
+		aOut[i] = to_local( aWorld[i] );
+}
+
+void RenderOrigin::to_local( Mat44f const* aWorld, std::size_t aCount, Mat44f* aOut ) const noexcept
+{
+	for( std::size_t i = 0; i < aCount; ++i )
+		aOut[i] = to_local( aWorld[i] );
+}
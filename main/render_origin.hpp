@@ -0,0 +1,59 @@
+#ifndef RENDER_ORIGIN_HPP_97534A69_C859_43E9_8DD5_0E5650ACBABF
+#define RENDER_ORIGIN_HPP_97534A69_C859_43E9_8DD5_0E5650ACBABF
+
+#include <cstddef>
+
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/vec3d.hpp"
+#include "../vmlib/mat44.hpp"
+
+/* RenderOrigin: floating origin for camera-relative rendering
+ *
+ * World positions that can get large (the launch, see LaunchState) are kept
+ * in double precision. OpenGL only ever sees positions relative to the render
+ * origin, which follows the camera: update() moves it onto a grid of
+ * kCellSize units whenever the camera leaves the cell around it. Relative
+ * positions therefore stay within about one cell of zero, where a float is
+ * precise to well below a millimetre, and the view matrices only hold small
+ * translations. Rendering itself stays in float.
+ *
+ * Snapping to a grid (instead of putting the origin exactly at the camera)
+ * means that the origin rarely moves. Static data that was rebased once, such
+ * as the landing pad instances, only has to be rebased again when update()
+ * returns true.
+ *
+ * Near the world origin, the origin is exactly zero and to_local() returns
+ * its inputs unchanged.
+ */
+class RenderOrigin final
+{
+	public:
+		RenderOrigin() noexcept;
+
+	public:
+		// Move the origin onto the grid cell around aEye, if aEye has left
+		// the current one. Returns true if the origin moved.
+		bool update( Vec3d aEye ) noexcept;
+
+		Vec3d origin() const noexcept;
+
+		// World to render space. The differences are computed in double and
+		// rounded once.
+		Vec3f to_local( Vec3d aWorld ) const noexcept;
+		Vec3f to_local( Vec3f aWorld ) const noexcept;
+		Mat44f to_local( Mat44f const& aModel2World ) const noexcept;
+
+		// The same for arrays; aOut may be the same array as aWorld for the
+		// matrices. The positions are converted two at a time with SSE2,
+		// where available.
+		void to_local( Vec3d const* aWorld, std::size_t aCount, Vec3f* aOut ) const noexcept;
+		void to_local( Mat44f const* aWorld, std::size_t aCount, Mat44f* aOut ) const noexcept;
+
+	public:
+		static constexpr double kCellSize = 1024.;
+
+	private:
+		Vec3d mOrigin;
+};
+
+#endif // RENDER_ORIGIN_HPP_97534A69_C859_43E9_8DD5_0E5650ACBABF
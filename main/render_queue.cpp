@@ -0,0 +1,87 @@
+#include "render_queue.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	// Enough for the scene's draws without allocating in the first frames
+	constexpr std::size_t kInitialCapacity_ = 32;
+
+	bool before_( RenderItem const& aLeft, RenderItem const& aRight ) noexcept
+	{
+		if( aLeft.pass != aRight.pass )
+			return aLeft.pass < aRight.pass;
+
+		if( aLeft.depth != aRight.depth )
+		{
+			// opaque: front to back; transparent: back to front
+			return RenderPass::opaque == aLeft.pass
+				? aLeft.depth < aRight.depth
+				: aLeft.depth > aRight.depth;
+		}
+
+		if( aLeft.id != aRight.id )
+			return aLeft.id < aRight.id;
+		return aLeft.arg < aRight.arg;
+	}
+}
+
+RenderQueue::RenderQueue()
+{
+	mItems.reserve( kInitialCapacity_ );
+}
+
+void RenderQueue::clear() noexcept
+{
+	mItems.clear();
+}
+
+void RenderQueue::add( RenderPass aPass, float aDepth, std::uint32_t aId, std::uint32_t aArg )
+{
+	mItems.emplace_back( RenderItem{ aPass, aDepth, aId, aArg } );
+}
+
+void RenderQueue::sort() noexcept
+{
+	std::sort( mItems.begin(), mItems.end(), &before_ );
+}
+
+RenderItem const* RenderQueue::begin() const noexcept
+{
+	return mItems.data();
+}
+RenderItem const* RenderQueue::end() const noexcept
+{
+	return mItems.data() + mItems.size();
+}
+std::size_t RenderQueue::size() const noexcept
+{
+	return mItems.size();
+}
+
+float view_depth( Mat44f const& aWorld2Camera, Vec3f aPoint ) noexcept
+{
+	// only the third row is needed: -z in camera space
+	return -(aWorld2Camera(2,0) * aPoint.x + aWorld2Camera(2,1) * aPoint.y + aWorld2Camera(2,2) * aPoint.z + aWorld2Camera(2,3));
+}
+
+float nearest_view_depth( Mat44f const& aWorld2Camera, Mat44f const* aModel2World, std::size_t aCount ) noexcept
+{
+	float ret = RenderQueue::kBackground;
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		Mat44f const& m = aModel2World[i];
+		ret = std::min( ret, view_depth( aWorld2Camera, Vec3f{ m(0,3), m(1,3), m(2,3) } ) );
+	}
+	return ret;
+}
+
+void sort_front_to_back( std::vector<Mat44f>& aModel2World, Mat44f const& aWorld2Camera )
+{
+	auto const depth = [&aWorld2Camera] (Mat44f const& aM) {
+		return view_depth( aWorld2Camera, Vec3f{ aM(0,3), aM(1,3), aM(2,3) } );
+	};
+	std::sort( aModel2World.begin(), aModel2World.end(), [&depth] (Mat44f const& aLeft, Mat44f const& aRight) {
+		return depth( aLeft ) < depth( aRight );
+	} );
+}
@@ -0,0 +1,76 @@
+#ifndef RENDER_QUEUE_HPP_D2D901B8_3978_478B_A5B3_B02107D20E13
+#define RENDER_QUEUE_HPP_D2D901B8_3978_478B_A5B3_B02107D20E13
+
+#include <limits>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/mat44.hpp"
+
+enum class RenderPass : std::uint8_t
+{
+	opaque,
+	transparent
+};
+
+struct RenderItem
+{
+	RenderPass pass;
+	float depth;        // view depth, see view_depth()
+	std::uint32_t id;   // what to draw; up to the caller
+	std::uint32_t arg;  // e.g. a level of detail
+};
+
+/* RenderQueue: draw order of a frame
+ *
+ * The frame's draws are queued as items with a pass and a view depth, and
+ * sort() then puts the opaque pass first, front to back, so that the nearest
+ * surfaces fill the depth buffer first and the hidden fragments behind them
+ * fail the depth test before their fragment shader runs (early-Z). The
+ * transparent pass follows, back to front.
+ *
+ * Items that cover most of the view and are mostly hidden by the rest (the
+ * terrain) go in with kBackground and are drawn after all other opaque
+ * items. Items at the same depth keep a fixed order (by id and arg), so the
+ * result doesn't change between runs.
+ *
+ * The queue keeps its capacity, so it stops allocating after the first
+ * frames.
+ */
+class RenderQueue final
+{
+	public:
+		RenderQueue();
+
+	public:
+		void clear() noexcept;
+		void add( RenderPass, float aDepth, std::uint32_t aId, std::uint32_t aArg = 0 );
+
+		void sort() noexcept;
+
+		RenderItem const* begin() const noexcept;
+		RenderItem const* end() const noexcept;
+		std::size_t size() const noexcept;
+
+	public:
+		static constexpr float kBackground = std::numeric_limits<float>::infinity();
+
+	private:
+		std::vector<RenderItem> mItems;
+};
+
+// Distance of aPoint in front of the camera, along the view direction.
+// aWorld2Camera is a look-at matrix (the camera looks down -z).
+float view_depth( Mat44f const& aWorld2Camera, Vec3f aPoint ) noexcept;
+
+// Smallest view_depth() of the translations of aModel2World; kBackground for
+// an empty list
+float nearest_view_depth( Mat44f const& aWorld2Camera, Mat44f const* aModel2World, std::size_t aCount ) noexcept;
+
+// Reorder instance transforms front to back by the depth of their translation
+void sort_front_to_back( std::vector<Mat44f>&, Mat44f const& aWorld2Camera );
+
+#endif // RENDER_QUEUE_HPP_D2D901B8_3978_478B_A5B3_B02107D20E13
@@ -7,7 +7,7 @@ SimpleMeshData make_cylinder( std::size_t aSubdivs, Vec3f aColor, Mat44f aPreTra
 	std::vector<Vec3f> pos;
 	std::vector<Vec3f> normals;
     // Compute the normal matrix
-    Mat33f const N = mat44_to_mat33(transpose(invert(aPreTransform)));
+    Mat33f const N = mat44_to_mat33(normal_matrix(aPreTransform));
 
     float prevY = std::cos(0.f);
     float prevZ = std::sin(0.f);
@@ -205,7 +205,7 @@ SimpleMeshData make_cube( Vec3f aColor, Mat44f aPreTransform) {
 
     // Apply the pre-transform to all positions and transform normals
 
-    Mat33f N = mat44_to_mat33(transpose(invert(aPreTransform)));
+    Mat33f N = mat44_to_mat33(normal_matrix(aPreTransform));
     for (auto& p : pos) {
         Vec4f p4{ p.x, p.y, p.z, 1.f };
         Vec4f t = aPreTransform * p4;
@@ -256,7 +256,7 @@ SimpleMeshData make_pyramid( Vec3f aColor, Mat44f aPreTransform) {
 
     {
 
-        Mat33f const N = mat44_to_mat33(transpose(invert(aPreTransform)));
+        Mat33f const N = mat44_to_mat33(normal_matrix(aPreTransform));
         std::vector<Vec3f> pos;
         std::vector<Vec3f> normals;
 
@@ -8,11 +8,31 @@ SimpleMeshData concatenate(SimpleMeshData aM, SimpleMeshData const& aN)
 }
 */
 
+namespace
+{
+	//append aN's values of one attribute. if only one of the meshes has the attribute,
+	//the other one's part is zero, so the attribute stays one value per position
+	template< typename tValue >
+	void append_attribute(std::vector<tValue>& aM, std::size_t aMCount, std::vector<tValue> const& aN, std::size_t aNCount)
+	{
+		if (aM.empty() && aN.empty())
+			return;
+
+		aM.resize(aMCount, tValue{});
+		aM.insert(aM.end(), aN.begin(), aN.end());
+		aM.resize(aMCount + aNCount, tValue{});
+	}
+}
+
 SimpleMeshData concatenate(SimpleMeshData aM, SimpleMeshData const& aN)
 {
+	std::size_t const mCount = aM.positions.size();
+	std::size_t const nCount = aN.positions.size();
+
 	aM.positions.insert(aM.positions.end(), aN.positions.begin(), aN.positions.end());
-	aM.colors.insert(aM.colors.end(), aN.colors.begin(), aN.colors.end());
-	aM.normals.insert(aM.normals.end(), aN.normals.begin(), aN.normals.end());
+	append_attribute(aM.colors, mCount, aN.colors, nCount);
+	append_attribute(aM.normals, mCount, aN.normals, nCount);
+	append_attribute(aM.texcoords, mCount, aN.texcoords, nCount);
 	return aM;
 }
 
@@ -16,6 +16,15 @@ struct SimpleMeshData
 	std::vector<Vec2f> texcoords;
 };
 
+// Indexed version of SimpleMeshData: one entry per distinct vertex in
+// vertices, and three indices per triangle
+struct IndexedMeshData
+{
+	SimpleMeshData vertices;
+	std::vector<GLuint> indices;
+};
+
+//attributes that only one of the meshes has are filled with zeros for the other
 SimpleMeshData concatenate(SimpleMeshData, SimpleMeshData const&);
 
 //SimpleMeshData concatenate(SimpleMeshData, SimpleMeshData const&);
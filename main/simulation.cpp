@@ -0,0 +1,158 @@
+#include "simulation.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+
+namespace
+{
+	constexpr float kPi_ = 3.1415926f;
+
+	// The flight was originally tuned as a displacement per frame, at 60 Hz.
+	constexpr float kTuningRate_ = 60.f;
+
+	// The rocket model points along +y; this turns it into the direction of
+	// flight (together with the angle of the velocity).
+	constexpr float kAngleOffset_ = 271.7f * kPi_ / 180.f;
+
+	// The speed follows an eased (t^4) curve, which starts over every
+	// kLoopDuration seconds.
+	Vec3f flight_velocity_( float aTime ) noexcept
+	{
+		constexpr float kLoopDuration = LaunchSimulation::kLoopDuration;
+
+		float const normalized = std::fmod( aTime, kLoopDuration ) / kLoopDuration;
+		float const eased = normalized * normalized * normalized * normalized * kLoopDuration;
+
+		return Vec3f{ eased, std::atan( eased * 500.f ) / 15.f, 0.f } * kTuningRate_;
+	}
+
+	template< typename tValue >
+	std::uint64_t fnv1a_( std::uint64_t aHash, tValue aValue ) noexcept
+	{
+		unsigned char bytes[sizeof(tValue)];
+		std::memcpy( bytes, &aValue, sizeof(tValue) );
+
+		for( auto const byte : bytes )
+		{
+			aHash ^= byte;
+			aHash *= 0x100000001b3ull;
+		}
+		return aHash;
+	}
+}
+
+LaunchSimulation::LaunchSimulation( Vec3f aLaunchPosition )
+	: mLaunchPosition( aLaunchPosition )
+{
+	reset();
+}
+
+void LaunchSimulation::reset()
+{
+	// At rest, the velocity points straight up (the limit of the flight
+	// direction as the time goes to zero).
+	mCurrent.position = to_vec3d( mLaunchPosition );
+	mCurrent.velocity = Vec3f{ 0.f, 0.f, 0.f };
+	mCurrent.angle = kAngleOffset_ + 0.5f * kPi_;
+	mCurrent.time = 0.f;
+
+	mPrevious = mCurrent;
+	mAccumulator = 0.f;
+	mSteps = 0;
+}
+
+std::size_t LaunchSimulation::advance( float aDt )
+{
+	mAccumulator += aDt;
+
+	std::size_t steps = 0;
+	while( mAccumulator >= kTimeStep && steps < kMaxStepsPerAdvance )
+	{
+		step();
+		mAccumulator -= kTimeStep;
+		++steps;
+	}
+
+	if( mAccumulator >= kTimeStep )
+		mAccumulator = std::fmod( mAccumulator, kTimeStep );
+
+	return steps;
+}
+
+void LaunchSimulation::step()
+{
+	mPrevious = mCurrent;
+	++mSteps;
+
+	// Derive the time from the step count, so that it doesn't drift from
+	// summing up kTimeStep.
+	mCurrent.time = float(double(mSteps) * double(kTimeStep));
+	mCurrent.velocity = flight_velocity_( mCurrent.time );
+	mCurrent.position = mCurrent.position + to_vec3d( mCurrent.velocity * kTimeStep );
+
+	// The speed drops to zero when the flight loops; keep the direction.
+	if( 0.f != mCurrent.velocity.x || 0.f != mCurrent.velocity.y )
+		mCurrent.angle = std::atan2( mCurrent.velocity.y, mCurrent.velocity.x ) + kAngleOffset_;
+}
+
+LaunchState const& LaunchSimulation::current() const noexcept
+{
+	return mCurrent;
+}
+
+LaunchState LaunchSimulation::interpolated() const
+{
+	return interpolate( mPrevious, mCurrent, mAccumulator / kTimeStep );
+}
+
+LaunchState const& LaunchSimulation::previous() const noexcept
+{
+	return mPrevious;
+}
+
+Vec3f LaunchSimulation::launch_position() const noexcept
+{
+	return mLaunchPosition;
+}
+
+std::uint64_t LaunchSimulation::step_count() const noexcept
+{
+	return mSteps;
+}
+
+std::uint64_t LaunchSimulation::hash() const noexcept
+{
+	std::uint64_t hash = 0xcbf29ce484222325ull;
+	for( double const value : { mCurrent.position.x, mCurrent.position.y, mCurrent.position.z } )
+	{
+		hash = fnv1a_( hash, value );
+	}
+	for( float const value : {
+		mCurrent.velocity.x, mCurrent.velocity.y, mCurrent.velocity.z,
+		mCurrent.angle, mCurrent.time
+	} )
+	{
+		hash = fnv1a_( hash, value );
+	}
+	return hash;
+}
+
+LaunchState interpolate( LaunchState const& aFrom, LaunchState const& aTo, float aAlpha ) noexcept
+{
+	LaunchState ret;
+	ret.position = aFrom.position + (aTo.position - aFrom.position) * double(aAlpha);
+	ret.velocity = fma( aTo.velocity - aFrom.velocity, aAlpha, aFrom.velocity );
+	ret.angle = aFrom.angle + (aTo.angle - aFrom.angle) * aAlpha;
+	ret.time = aFrom.time + (aTo.time - aFrom.time) * aAlpha;
+	return ret;
+}
+
+Transform launch_transform( LaunchState const& aState, Vec3d aOrigin )
+{
+	return Transform{ make_quat_rotation_z( aState.angle ), to_vec3f( aState.position - aOrigin ), 1.f };
+}
+Mat44f launch_model_to_world( LaunchState const& aState, Vec3d aOrigin )
+{
+	return to_mat44( launch_transform( aState, aOrigin ) );
+}
@@ -0,0 +1,89 @@
+#ifndef SIMULATION_HPP_FC5A63AB_17BA_42B9_9712_6F9879232D1A
+#define SIMULATION_HPP_FC5A63AB_17BA_42B9_9712_6F9879232D1A
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/vec3d.hpp"
+#include "../vmlib/mat44.hpp"
+#include "../vmlib/transform.hpp"
+
+/* LaunchSimulation: rocket flight integrated with a fixed time step
+ *
+ * The flight is advanced in steps of exactly kTimeStep seconds, independent
+ * of the frame rate. advance() takes the real time that passed and runs as
+ * many whole steps as fit; the remainder is carried over to the next call.
+ * Rendering uses interpolated(), which blends the last two steps by that
+ * remainder, so motion stays smooth when frames and steps don't line up.
+ *
+ * Since the steps never depend on the frame time, the same number of steps
+ * always gives bit-identical results, and the flight can be run without a
+ * window, faster than real time (see --simulate in main.cpp).
+ *
+ * The position is in double precision, since the flight keeps going for as
+ * long as it runs; see vec3d.hpp. Everything else stays in float.
+ */
+struct LaunchState
+{
+	Vec3d position;
+	Vec3f velocity; // units per second
+	float angle;    // rotation about z, radians
+	float time;     // seconds since launch
+};
+
+class LaunchSimulation final
+{
+	public:
+		explicit LaunchSimulation( Vec3f aLaunchPosition );
+
+	public:
+		// Back to the launch position, with no time accumulated
+		void reset();
+
+		// Run the steps that fit into aDt seconds (plus the remainder of
+		// earlier calls). Returns the number of steps taken. At most
+		// kMaxStepsPerAdvance steps are taken; time beyond that is dropped,
+		// so a long stall doesn't have to be caught up with.
+		std::size_t advance( float aDt );
+
+		// Single step of kTimeStep seconds
+		void step();
+
+		LaunchState const& current() const noexcept;
+		LaunchState const& previous() const noexcept;
+		LaunchState interpolated() const;
+
+		Vec3f launch_position() const noexcept;
+		std::uint64_t step_count() const noexcept;
+
+		// FNV-1a hash of the bits of current(), for comparing runs
+		std::uint64_t hash() const noexcept;
+
+	public:
+		static constexpr float kTimeStep = 1.f / 60.f;
+
+		// The flight speeds up along the same curve every kLoopDuration
+		// seconds, see simulation.cpp.
+		static constexpr float kLoopDuration = 10.f;
+
+		static constexpr std::size_t kMaxStepsPerAdvance = 15;
+
+	private:
+		Vec3f mLaunchPosition;
+
+		LaunchState mPrevious, mCurrent;
+		float mAccumulator;
+
+		std::uint64_t mSteps;
+};
+
+// Blend between two states; aAlpha = 0 gives aFrom, 1 gives aTo
+LaunchState interpolate( LaunchState const& aFrom, LaunchState const& aTo, float aAlpha ) noexcept;
+
+// Model-to-world transform of the rocket in the given state, with the world
+// origin moved to aOrigin (see RenderOrigin in render_origin.hpp)
+Transform launch_transform( LaunchState const&, Vec3d aOrigin = Vec3d{ 0., 0., 0. } );
+Mat44f launch_model_to_world( LaunchState const&, Vec3d aOrigin = Vec3d{ 0., 0., 0. } );
+
+#endif // SIMULATION_HPP_FC5A63AB_17BA_42B9_9712_6F9879232D1A
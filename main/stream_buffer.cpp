@@ -0,0 +1,222 @@
+#include "stream_buffer.hpp"
+
+#include <algorithm>
+
+#include <cstring>
+
+#include "../support/error.hpp"
+
+namespace
+{
+	// Regions start at multiples of this (or of a larger required offset
+	// alignment), so that offsets aligned within a region are aligned in the
+	// buffer as well
+	constexpr std::size_t kRegionAlign_ = 256;
+
+	constexpr GLuint64 kWaitTimeout_ = 1000000; // ns
+
+	std::size_t align_up_( std::size_t aValue, std::size_t aAlign ) noexcept
+	{
+		return (aValue + aAlign - 1) / aAlign * aAlign;
+	}
+
+	std::size_t get_alignment_( GLenum aName )
+	{
+		GLint align = 0;
+		glGetIntegerv( aName, &align );
+		return std::size_t(std::max( align, 1 ));
+	}
+}
+
+StreamBuffer::StreamBuffer( std::size_t aRegionSize )
+	: mBuffer( 0 )
+	, mMapped( nullptr )
+	, mRegionSize( 0 )
+	, mRegion( 0 )
+	, mHead( 0 )
+	, mFences{}
+	, mUniformAlignment( get_alignment_( GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT ) )
+	, mStorageAlignment( get_alignment_( GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT ) )
+	, mFrameBytes( 0 )
+	, mStalls( 0 )
+{
+	create_( aRegionSize );
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	for( auto const fence : mFences )
+	{
+		if( fence )
+			glDeleteSync( fence );
+	}
+
+	for( auto const& retired : mRetired )
+	{
+		if( retired.fence )
+			glDeleteSync( retired.fence );
+		glDeleteBuffers( 1, &retired.buffer );
+	}
+
+	// Deleting the buffer also unmaps it
+	if( 0 != mBuffer )
+		glDeleteBuffers( 1, &mBuffer );
+}
+
+void StreamBuffer::begin_frame()
+{
+	mRegion = (mRegion + 1) % kRegions;
+	mHead = 0;
+	mFrameBytes = 0;
+
+	// Wait for the GPU to finish the frame that last used this region
+	if( GLsync const fence = mFences[mRegion] )
+	{
+		GLenum res = glClientWaitSync( fence, 0, 0 );
+		if( GL_TIMEOUT_EXPIRED == res )
+		{
+			++mStalls;
+			do
+			{
+				res = glClientWaitSync( fence, GL_SYNC_FLUSH_COMMANDS_BIT, kWaitTimeout_ );
+			} while( GL_TIMEOUT_EXPIRED == res );
+		}
+
+		if( GL_WAIT_FAILED == res )
+			throw Error( "StreamBuffer: glClientWaitSync() failed" );
+
+		glDeleteSync( fence );
+		mFences[mRegion] = nullptr;
+	}
+
+	// Delete replaced buffers that are no longer in use
+	auto const done = [] (Retired_ const& aRetired) {
+		if( !aRetired.fence || GL_TIMEOUT_EXPIRED == glClientWaitSync( aRetired.fence, 0, 0 ) )
+			return false;
+
+		glDeleteSync( aRetired.fence );
+		glDeleteBuffers( 1, &aRetired.buffer );
+		return true;
+	};
+	mRetired.erase( std::remove_if( mRetired.begin(), mRetired.end(), done ), mRetired.end() );
+}
+
+void StreamBuffer::end_frame()
+{
+	if( mFences[mRegion] )
+		glDeleteSync( mFences[mRegion] );
+	mFences[mRegion] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+
+	for( auto& retired : mRetired )
+	{
+		if( !retired.fence )
+			retired.fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+	}
+}
+
+StreamBuffer::Allocation StreamBuffer::write( void const* aData, std::size_t aBytes, std::size_t aAlign )
+{
+	std::size_t offset = align_up_( mHead, aAlign );
+	if( offset + aBytes > mRegionSize )
+	{
+		// Too much data for this frame. Switch to a larger buffer; the data
+		// written so far stays in the old one.
+		std::size_t const needed = mFrameBytes + aBytes + aAlign;
+		retire_();
+		create_( std::max( 2*mRegionSize, needed ) );
+		offset = 0;
+	}
+
+	std::size_t const start = mRegion * mRegionSize + offset;
+	if( mMapped )
+	{
+		std::memcpy( mMapped + start, aData, aBytes );
+	}
+	else
+	{
+		glBindBuffer( GL_COPY_WRITE_BUFFER, mBuffer );
+		glBufferSubData( GL_COPY_WRITE_BUFFER, GLintptr(start), GLsizeiptr(aBytes), aData );
+		glBindBuffer( GL_COPY_WRITE_BUFFER, 0 );
+	}
+
+	mHead = offset + aBytes;
+	mFrameBytes += aBytes;
+
+	return Allocation{ mBuffer, GLintptr(start), GLsizeiptr(aBytes) };
+}
+
+std::size_t StreamBuffer::uniform_alignment() const noexcept
+{
+	return mUniformAlignment;
+}
+std::size_t StreamBuffer::storage_alignment() const noexcept
+{
+	return mStorageAlignment;
+}
+
+bool StreamBuffer::persistent() const noexcept
+{
+	return nullptr != mMapped;
+}
+std::size_t StreamBuffer::region_size() const noexcept
+{
+	return mRegionSize;
+}
+
+std::size_t StreamBuffer::frame_bytes() const noexcept
+{
+	return mFrameBytes;
+}
+std::size_t StreamBuffer::stall_count() const noexcept
+{
+	return mStalls;
+}
+
+void StreamBuffer::create_( std::size_t aRegionSize )
+{
+	std::size_t const align = std::max( { kRegionAlign_, mUniformAlignment, mStorageAlignment } );
+	mRegionSize = align_up_( std::max<std::size_t>( aRegionSize, 1 ), align );
+	GLsizeiptr const size = GLsizeiptr(kRegions * mRegionSize);
+
+	glGenBuffers( 1, &mBuffer );
+	glBindBuffer( GL_COPY_WRITE_BUFFER, mBuffer );
+
+	if( GLAD_GL_VERSION_4_4 )
+	{
+		GLbitfield const flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage( GL_COPY_WRITE_BUFFER, size, nullptr, flags );
+
+		mMapped = static_cast<unsigned char*>(glMapBufferRange( GL_COPY_WRITE_BUFFER, 0, size, flags ));
+		if( !mMapped )
+		{
+			glBindBuffer( GL_COPY_WRITE_BUFFER, 0 );
+			throw Error( "StreamBuffer: unable to map %zu bytes persistently", std::size_t(size) );
+		}
+	}
+	else
+	{
+		glBufferData( GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW );
+		mMapped = nullptr;
+	}
+
+	glBindBuffer( GL_COPY_WRITE_BUFFER, 0 );
+}
+
+void StreamBuffer::retire_()
+{
+	// The GPU may still read the old buffer for this and earlier frames. The
+	// fence placed by end_frame() covers all of them.
+	mRetired.emplace_back( Retired_{ mBuffer, nullptr } );
+
+	for( auto& fence : mFences )
+	{
+		if( fence )
+		{
+			glDeleteSync( fence );
+			fence = nullptr;
+		}
+	}
+
+	mBuffer = 0;
+	mMapped = nullptr;
+}
@@ -0,0 +1,95 @@
+#ifndef STREAM_BUFFER_HPP_42A65724_B300_449C_9E71_10CBA928EABA
+#define STREAM_BUFFER_HPP_42A65724_B300_449C_9E71_10CBA928EABA
+
+#include <glad.h>
+
+#include <vector>
+
+#include <cstddef>
+
+/* StreamBuffer: ring buffer for data that is written anew every frame
+ *
+ * One buffer object, split into kRegions regions. Each frame writes to the
+ * next region, and end_frame() puts a fence behind the frame's commands.
+ * begin_frame() waits for the fence of the region it is about to reuse,
+ * i.e. for the frame kRegions frames ago, so data the GPU may still read is
+ * never overwritten. The buffer is neither reallocated nor orphaned in the
+ * frame loop.
+ *
+ * With GL 4.4, the buffer is created with glBufferStorage() and stays mapped
+ * (persistent and coherent); write() is a plain memcpy. Otherwise, write()
+ * falls back to glBufferSubData() into the same regions.
+ *
+ * If a frame writes more than a region holds, the buffer is replaced by a
+ * larger one. The old buffer is deleted once the GPU is done with it.
+ * Allocations stay valid until the end of the frame, so users bind them
+ * (with their buffer and offset) right before drawing.
+ */
+class StreamBuffer final
+{
+	public:
+		struct Allocation
+		{
+			GLuint buffer;
+			GLintptr offset;
+			GLsizeiptr size;
+		};
+
+	public:
+		static constexpr std::size_t kRegions = 3;
+		static constexpr std::size_t kDefaultRegionSize = 1024*1024;
+
+	public:
+		explicit StreamBuffer( std::size_t aRegionSize = kDefaultRegionSize );
+		~StreamBuffer();
+
+		StreamBuffer( StreamBuffer const& ) = delete;
+		StreamBuffer& operator= (StreamBuffer const&) = delete;
+
+	public:
+		void begin_frame();
+		void end_frame();
+
+		// Copy aBytes to the current region, at an offset that is a multiple
+		// of aAlign (see uniform_alignment() and storage_alignment()).
+		Allocation write( void const* aData, std::size_t aBytes, std::size_t aAlign = 16 );
+
+		// Offset alignments required for glBindBufferRange() with
+		// GL_UNIFORM_BUFFER and GL_SHADER_STORAGE_BUFFER
+		std::size_t uniform_alignment() const noexcept;
+		std::size_t storage_alignment() const noexcept;
+
+		bool persistent() const noexcept;
+		std::size_t region_size() const noexcept;
+
+		// Bytes written by the last (or current) frame, and the number of
+		// times begin_frame() had to wait for the GPU
+		std::size_t frame_bytes() const noexcept;
+		std::size_t stall_count() const noexcept;
+
+	private:
+		struct Retired_
+		{
+			GLuint buffer;
+			GLsync fence;
+		};
+
+		void create_( std::size_t aRegionSize );
+		void retire_();
+
+		GLuint mBuffer;
+		unsigned char* mMapped;
+
+		std::size_t mRegionSize;
+		std::size_t mRegion;
+		std::size_t mHead;
+
+		GLsync mFences[kRegions];
+		std::vector<Retired_> mRetired;
+
+		std::size_t mUniformAlignment, mStorageAlignment;
+		std::size_t mFrameBytes;
+		std::size_t mStalls;
+};
+
+#endif // STREAM_BUFFER_HPP_42A65724_B300_449C_9E71_10CBA928EABA
@@ -6,30 +6,46 @@
 
 #include "../support/error.hpp"
 
-GLuint load_texture_2d(char const* aPath)
+ImageRGBA load_image_rgba(char const* aPath)
 {
 	assert(aPath);
 
-	// Load image first 
-	// This may fail (e.g., image does not exist), so there's no point in 
-	// allocating OpenGL resources ahead of time. 
-	stbi_set_flip_vertically_on_load(true);
+	// the per thread variant, so that images can be decoded off the render thread
+	stbi_set_flip_vertically_on_load_thread(true);
 
 	int w, h, channels;
 	stbi_uc* ptr = stbi_load(aPath, &w, &h, &channels, 4);
 	if (!ptr)
 		throw Error("Unable to load image %s\n", aPath);
 
+	ImageRGBA ret;
+	ret.width = w;
+	ret.height = h;
+	ret.pixels.assign(ptr, ptr + std::size_t(w) * std::size_t(h) * 4);
+
+	stbi_image_free(ptr);
+
+	return ret;
+}
+
+GLuint load_texture_2d(char const* aPath)
+{
+	// Load image first 
+	// This may fail (e.g., image does not exist), so there's no point in 
+	// allocating OpenGL resources ahead of time. 
+	return create_texture_2d(load_image_rgba(aPath));
+}
+
+GLuint create_texture_2d(ImageRGBA const& aImage)
+{
 	// Generate texture object and initialize texture with image 
 
 	GLuint tex = 0;
 	glGenTextures(1, &tex);
 	glBindTexture(GL_TEXTURE_2D, tex);
 
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8_ALPHA8, w, h, 0,
-		GL_RGBA, GL_UNSIGNED_BYTE, ptr);
-
-	stbi_image_free(ptr);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8_ALPHA8, aImage.width, aImage.height, 0,
+		GL_RGBA, GL_UNSIGNED_BYTE, aImage.pixels.data());
 
 	// Generate mipmap hierarchy 
 	glGenerateMipmap(GL_TEXTURE_2D);
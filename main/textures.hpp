@@ -3,6 +3,20 @@
 
 #include <glad.h>
 
+#include <vector>
+
+// 8-bit RGBA pixels, rows bottom to top (as OpenGL expects them)
+struct ImageRGBA
+{
+	int width, height;
+	std::vector<unsigned char> pixels;
+};
+
+// Decode an image file. Makes no OpenGL calls, so it can run on any thread.
+ImageRGBA load_image_rgba(char const* aPath);
+
+GLuint create_texture_2d(ImageRGBA const& aImage);
+
 GLuint load_texture_2d(char const* aPath);
 
 #endif // TEXTURES_HPP_D0746DED_C9C6_40CD_B6E0_C6FEF665DD31
\ No newline at end of file
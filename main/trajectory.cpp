@@ -0,0 +1,126 @@
+#include "trajectory.hpp"
+
+#include <algorithm>
+
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64)
+#	include <xmmintrin.h>
+#	define TRAJECTORY_SSE_ 1
+#endif
+#if defined(__FMA__) || defined(__AVX2__)
+#	include <immintrin.h>
+#	define TRAJECTORY_FMA_ 1
+#endif
+
+namespace
+{
+	template< class tSample >
+	tSample lerp_( tSample const& aA, tSample const& aB, float aT ) noexcept
+	{
+		static_assert( sizeof(tSample) == 8*sizeof(float), "two groups of four floats" );
+
+		tSample ret;
+		float const* a = reinterpret_cast<float const*>(&aA);
+		float const* b = reinterpret_cast<float const*>(&aB);
+		float* r = reinterpret_cast<float*>(&ret);
+
+#		if defined(TRAJECTORY_SSE_)
+		__m128 const t = _mm_set1_ps( aT );
+		for( std::size_t i = 0; i < 8; i += 4 )
+		{
+			__m128 const va = _mm_load_ps( a+i );
+			__m128 const vb = _mm_load_ps( b+i );
+#			if defined(TRAJECTORY_FMA_)
+			_mm_store_ps( r+i, _mm_fmadd_ps( _mm_sub_ps( vb, va ), t, va ) );
+#			else // !TRAJECTORY_FMA_
+			_mm_store_ps( r+i, _mm_add_ps( va, _mm_mul_ps( _mm_sub_ps( vb, va ), t ) ) );
+#			endif // ~ TRAJECTORY_FMA_
+		}
+#		else // !TRAJECTORY_SSE_
+		for( std::size_t i = 0; i < 8; ++i )
+			r[i] = a[i] + (b[i] - a[i]) * aT;
+#		endif // ~ TRAJECTORY_SSE_
+
+		return ret;
+	}
+}
+
+Trajectory::Trajectory( Vec3f aLaunchPosition )
+	: mLaunchPosition( to_vec3d( aLaunchPosition ) )
+{
+	auto const stepsPerLoop = static_cast<std::size_t>(std::lround(
+		LaunchSimulation::kLoopDuration / LaunchSimulation::kTimeStep
+	));
+
+	LaunchSimulation sim( aLaunchPosition );
+	mSamples.reserve( stepsPerLoop+1 );
+
+	for( std::size_t i = 0; i <= stepsPerLoop; ++i )
+	{
+		if( 0 != i )
+			sim.step();
+
+		auto const& state = sim.current();
+
+		// relative to the launch position, where a float is precise enough
+		// for one loop
+		Vec3f const position = to_vec3f( state.position - mLaunchPosition );
+
+		Sample_ sample;
+		sample.position[0] = position.x;
+		sample.position[1] = position.y;
+		sample.position[2] = position.z;
+		sample.angle = state.angle;
+		sample.velocity[0] = state.velocity.x;
+		sample.velocity[1] = state.velocity.y;
+		sample.velocity[2] = state.velocity.z;
+		sample.time = state.time;
+		mSamples.emplace_back( sample );
+	}
+
+	auto const& first = mSamples.front();
+	auto const& last = mSamples.back();
+	mLoopDisplacement = Vec3f{
+		last.position[0] - first.position[0],
+		last.position[1] - first.position[1],
+		last.position[2] - first.position[2]
+	};
+}
+
+LaunchState Trajectory::sample( float aTime ) const noexcept
+{
+	float const time = std::max( aTime, 0.f );
+
+	float const loops = std::floor( time / LaunchSimulation::kLoopDuration );
+	float const local = (time - loops * LaunchSimulation::kLoopDuration) / LaunchSimulation::kTimeStep;
+
+	std::size_t const index = std::min( static_cast<std::size_t>(local), mSamples.size()-2 );
+	float const frac = std::min( local - float(index), 1.f );
+
+	// Later loops start where the previous one ended, not in the launch
+	// state (which is at rest on the pad).
+	Sample_ from = mSamples[index];
+	if( 0 == index && loops > 0.f )
+	{
+		from = mSamples.back();
+		for( std::size_t i = 0; i < 3; ++i )
+			from.position[i] -= mLoopDisplacement[i];
+	}
+
+	Sample_ const s = lerp_( from, mSamples[index+1], frac );
+
+	LaunchState ret;
+	ret.position = mLaunchPosition
+		+ to_vec3d( mLoopDisplacement ) * double(loops)
+		+ to_vec3d( Vec3f{ s.position[0], s.position[1], s.position[2] } );
+	ret.velocity = Vec3f{ s.velocity[0], s.velocity[1], s.velocity[2] };
+	ret.angle = s.angle;
+	ret.time = aTime;
+	return ret;
+}
+
+std::size_t Trajectory::sample_count() const noexcept
+{
+	return mSamples.size();
+}
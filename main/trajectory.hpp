@@ -0,0 +1,53 @@
+#ifndef TRAJECTORY_HPP_3C66E2D0_341B_44A4_B666_B4E49DF9349A
+#define TRAJECTORY_HPP_3C66E2D0_341B_44A4_B666_B4E49DF9349A
+
+#include <vector>
+
+#include <cstddef>
+
+#include "simulation.hpp"
+
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/vec3d.hpp"
+
+/* Trajectory: precomputed launch flight, sampled at any time
+ *
+ * Runs a LaunchSimulation through one loop of the flight (see
+ * LaunchSimulation::kLoopDuration) and stores its state after every step.
+ * Since the speed curve repeats each loop, later loops are the same samples
+ * shifted by the distance covered per loop. sample() is therefore O(1) for
+ * any time: one table lookup and a linear blend of two samples (with SSE
+ * where available), instead of re-running the flight.
+ *
+ * At whole steps, sample() matches the simulation; in between it blends the
+ * same way as LaunchSimulation::interpolated(). This makes it cheap to place
+ * many rockets on the path, to replay a launch, or to look ahead along it.
+ */
+class Trajectory final
+{
+	public:
+		explicit Trajectory( Vec3f aLaunchPosition );
+
+	public:
+		// State at aTime seconds after launch. Times before the launch give
+		// the launch state.
+		LaunchState sample( float aTime ) const noexcept;
+
+		std::size_t sample_count() const noexcept;
+
+	private:
+		// position and angle, velocity and time: two SSE registers
+		struct alignas(16) Sample_
+		{
+			float position[3];
+			float angle;
+			float velocity[3];
+			float time;
+		};
+
+		Vec3d mLaunchPosition;
+		std::vector<Sample_> mSamples; // one loop, both ends included, relative to mLaunchPosition
+		Vec3f mLoopDisplacement;
+};
+
+#endif // TRAJECTORY_HPP_3C66E2D0_341B_44A4_B666_B4E49DF9349A
@@ -0,0 +1,22 @@
+#include "view_uniforms.hpp"
+
+#include <cassert>
+
+ViewUniformBuffer::ViewUniformBuffer( StreamBuffer& aStream )
+	: mStream( &aStream )
+{
+	for( auto& view : mViews )
+		view = kIdentity44f;
+}
+
+void ViewUniformBuffer::set( std::size_t aView, Mat44f const& aProjCameraWorld )
+{
+	assert( aView < kMaxViews );
+	mViews[aView] = aProjCameraWorld;
+}
+
+void ViewUniformBuffer::upload()
+{
+	auto const range = mStream->write( mViews, sizeof(mViews), mStream->uniform_alignment() );
+	glBindBufferRange( GL_UNIFORM_BUFFER, kBinding, range.buffer, range.offset, range.size );
+}
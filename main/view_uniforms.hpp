@@ -0,0 +1,47 @@
+#ifndef VIEW_UNIFORMS_HPP_43F1C1C0_5EC3_4C87_8389_93CFEC075FF6
+#define VIEW_UNIFORMS_HPP_43F1C1C0_5EC3_4C87_8389_93CFEC075FF6
+
+#include <glad.h>
+
+#include <cstddef>
+
+#include "stream_buffer.hpp"
+
+#include "../vmlib/mat44.hpp"
+
+/* ViewUniformBuffer: per-view projection-camera-world matrices
+ *
+ * Uniform buffer (binding 0) shared by all scene shaders, see ViewBlock in
+ * assets/colorShader.vert. Vertex shaders use the first matrix directly; the
+ * multiview geometry shaders (assets/multiview.geom) draw each triangle once
+ * per view, with gl_InvocationID selecting both the matrix and the viewport.
+ *
+ * This replaces the per-program projection uniforms, so the matrices are set
+ * once per frame instead of once per program and view. They are written to a
+ * StreamBuffer, i.e. the upload must be repeated every frame.
+ */
+class ViewUniformBuffer final
+{
+	public:
+		explicit ViewUniformBuffer( StreamBuffer& );
+
+		ViewUniformBuffer( ViewUniformBuffer const& ) = delete;
+		ViewUniformBuffer& operator= (ViewUniformBuffer const&) = delete;
+
+	public:
+		void set( std::size_t aView, Mat44f const& aProjCameraWorld );
+
+		// Upload the matrices and bind them to kBinding
+		void upload();
+
+	public:
+		static constexpr std::size_t kMaxViews = 2; // see ViewBlock
+		static constexpr GLuint kBinding = 0;
+
+	private:
+		// std140 layout, mat4 array: no padding
+		Mat44f mViews[kMaxViews];
+		StreamBuffer* mStream;
+};
+
+#endif // VIEW_UNIFORMS_HPP_43F1C1C0_5EC3_4C87_8389_93CFEC075FF6
@@ -152,4 +152,24 @@ project "vmlib-test"
 
 	files( sources )
 
+	-- the compile-time primitives are checked against the shape generators
+	files( "main/shapes.cpp" )
+	files( "main/primitives.cpp" )
+
+project "vmlib-bench"
+	local sources = { 
+		"vmlib-bench/**.cpp",
+		"vmlib-bench/**.hpp",
+		"vmlib-bench/**.hxx",
+		"vmlib-bench/**.inl"
+	}
+
+	kind "ConsoleApp"
+	location "vmlib-bench"
+
+	files( sources )
+
+	links "vmlib"
+	links "x-catch2"
+
 --EOF
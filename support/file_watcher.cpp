@@ -0,0 +1,206 @@
+#include "file_watcher.hpp"
+
+#include <algorithm>
+#include <system_error>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__linux__)
+#	include <poll.h>
+#	include <unistd.h>
+#	include <sys/inotify.h>
+#endif // ~ __linux__
+
+namespace
+{
+	// How often the thread wakes up when nothing happens, to check for
+	// pending changes and for shutdown.
+	constexpr std::chrono::milliseconds kTick_{ 50 };
+
+	// Polling fallback: interval between directory scans
+	constexpr std::chrono::milliseconds kScanInterval_{ 250 };
+}
+
+FileWatcher::FileWatcher( std::string aDirectory, Callback aOnChange, std::chrono::milliseconds aDebounce )
+	: mDirectory( std::move(aDirectory) )
+	, mOnChange( std::move(aOnChange) )
+	, mDebounce( aDebounce )
+	, mNotifyFd( -1 )
+	, mWatchFd( -1 )
+	, mStop( false )
+{
+#	if defined(__linux__)
+	mNotifyFd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+	if( mNotifyFd >= 0 )
+	{
+		// Editors either rewrite the file in place (close after write) or
+		// write a new file and rename it over the old one (moved to).
+		mWatchFd = inotify_add_watch( mNotifyFd, mDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO );
+		if( mWatchFd < 0 )
+		{
+			close( mNotifyFd );
+			mNotifyFd = -1;
+		}
+	}
+
+	if( mNotifyFd < 0 )
+		std::fprintf( stderr, "Note: inotify unavailable for '%s' (%s). Polling for changes instead.\n", mDirectory.c_str(), std::strerror( errno ) );
+#	endif // ~ __linux__
+
+	// Initial modification times, so that the first scan doesn't report
+	// every file
+	if( mNotifyFd < 0 )
+		scan_( false );
+
+	mThread = std::thread( [this] { run_(); } );
+}
+
+FileWatcher::~FileWatcher()
+{
+	mStop = true;
+	if( mThread.joinable() )
+		mThread.join();
+
+#	if defined(__linux__)
+	if( mNotifyFd >= 0 )
+		close( mNotifyFd ); // also removes the watch
+#	endif // ~ __linux__
+}
+
+void FileWatcher::touch( std::string const& aPath )
+{
+	mark_( aPath );
+}
+
+bool FileWatcher::native() const noexcept
+{
+	return mNotifyFd >= 0;
+}
+
+void FileWatcher::run_()
+{
+	auto nextScan = Clock_::now() + kScanInterval_;
+
+	while( !mStop )
+	{
+		if( mNotifyFd >= 0 )
+		{
+			wait_native_( kTick_ );
+		}
+		else
+		{
+			std::this_thread::sleep_for( kTick_ );
+			if( Clock_::now() >= nextScan )
+			{
+				scan_( true );
+				nextScan = Clock_::now() + kScanInterval_;
+			}
+		}
+
+		fire_due_();
+	}
+}
+
+void FileWatcher::wait_native_( std::chrono::milliseconds aTimeout )
+{
+#	if defined(__linux__)
+	pollfd pfd{};
+	pfd.fd = mNotifyFd;
+	pfd.events = POLLIN;
+	if( poll( &pfd, 1, int(aTimeout.count()) ) <= 0 )
+		return;
+
+	// Buffer aligned for inotify_event, large enough for several events
+	alignas(inotify_event) char buffer[4096];
+	for( ;; )
+	{
+		auto const len = read( mNotifyFd, buffer, sizeof(buffer) );
+		if( len <= 0 )
+			break;
+
+		for( char const* ptr = buffer; ptr < buffer + len; )
+		{
+			auto const* event = reinterpret_cast<inotify_event const*>(ptr);
+			if( event->len > 0 && !(event->mask & IN_ISDIR) )
+				mark_( mDirectory + "/" + event->name );
+
+			ptr += sizeof(inotify_event) + event->len;
+		}
+	}
+#	else // !__linux__
+	(void)aTimeout;
+#	endif // ~ __linux__
+}
+
+void FileWatcher::scan_( bool aReport )
+{
+	std::error_code ec;
+	for( auto const& entry : std::filesystem::directory_iterator( mDirectory, ec ) )
+	{
+		if( !entry.is_regular_file( ec ) )
+			continue;
+
+		auto const name = entry.path().filename().string();
+		auto const time = entry.last_write_time( ec );
+		if( ec )
+			continue;
+
+		auto it = std::find_if( mTimes.begin(), mTimes.end(), [&name] (auto const& aEntry) {
+			return aEntry.first == name;
+		} );
+
+		if( mTimes.end() == it )
+		{
+			mTimes.emplace_back( name, time );
+			if( aReport )
+				mark_( mDirectory + "/" + name );
+		}
+		else if( it->second != time )
+		{
+			it->second = time;
+			if( aReport )
+				mark_( mDirectory + "/" + name );
+		}
+	}
+}
+
+void FileWatcher::mark_( std::string const& aPath )
+{
+	auto const due = Clock_::now() + mDebounce;
+
+	std::lock_guard<std::mutex> lock( mPendingMutex );
+	auto it = std::find_if( mPending.begin(), mPending.end(), [&aPath] (Pending_ const& aPending) {
+		return aPending.path == aPath;
+	} );
+
+	if( mPending.end() == it )
+		mPending.emplace_back( Pending_{ aPath, due } );
+	else
+		it->due = due;
+}
+
+void FileWatcher::fire_due_()
+{
+	std::vector<std::string> due;
+	{
+		auto const now = Clock_::now();
+
+		std::lock_guard<std::mutex> lock( mPendingMutex );
+		for( auto it = mPending.begin(); it != mPending.end(); )
+		{
+			if( it->due <= now )
+			{
+				due.emplace_back( std::move(it->path) );
+				it = mPending.erase( it );
+			}
+			else
+				++it;
+		}
+	}
+
+	// outside of the lock, so that the callback may call touch()
+	for( auto const& path : due )
+		mOnChange( path );
+}
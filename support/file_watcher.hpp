@@ -0,0 +1,81 @@
+#ifndef FILE_WATCHER_HPP_A73581D9_7DA6_4358_AA50_519170DBF3BA
+#define FILE_WATCHER_HPP_A73581D9_7DA6_4358_AA50_519170DBF3BA
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <filesystem>
+#include <functional>
+
+/* FileWatcher: reports changed files in a directory from a background thread
+ *
+ * Uses inotify on Linux. Elsewhere (or if inotify is unavailable), the
+ * directory is polled for changed modification times.
+ *
+ * Editors tend to produce several events per save (truncate, write, rename).
+ * A file is therefore only reported once it has been quiet for the debounce
+ * interval. The callback runs on the watcher thread and receives the path as
+ * "<directory>/<name>"; it is the place for blocking work such as reading
+ * the file. It must not make any OpenGL calls.
+ *
+ * Only the directory itself is watched, not its subdirectories.
+ */
+class FileWatcher final
+{
+	public:
+		using Callback = std::function<void(std::string const& aPath)>;
+
+		FileWatcher(
+			std::string aDirectory,
+			Callback aOnChange,
+			std::chrono::milliseconds aDebounce = std::chrono::milliseconds(200)
+		);
+		~FileWatcher();
+
+		FileWatcher( FileWatcher const& ) = delete;
+		FileWatcher& operator= (FileWatcher const&) = delete;
+
+	public:
+		// Report aPath as if it changed (still debounced). Thread safe.
+		void touch( std::string const& aPath );
+
+		// True if changes are reported through inotify rather than polling
+		bool native() const noexcept;
+
+	private:
+		using Clock_ = std::chrono::steady_clock;
+
+		struct Pending_
+		{
+			std::string path;
+			Clock_::time_point due;
+		};
+
+		void run_();
+		void wait_native_( std::chrono::milliseconds );
+		void scan_( bool aReport );
+		void mark_( std::string const& aPath );
+		void fire_due_();
+
+		std::string mDirectory;
+		Callback mOnChange;
+		std::chrono::milliseconds mDebounce;
+
+		int mNotifyFd;  // -1 when polling
+		int mWatchFd;
+
+		// modification times for polling, by file name
+		std::vector<std::pair<std::string,std::filesystem::file_time_type>> mTimes;
+
+		std::mutex mPendingMutex;
+		std::vector<Pending_> mPending;
+
+		std::atomic<bool> mStop;
+		std::thread mThread;
+};
+
+#endif // FILE_WATCHER_HPP_A73581D9_7DA6_4358_AA50_519170DBF3BA
@@ -0,0 +1,72 @@
+#include "frame_arena.hpp"
+
+#include <algorithm>
+
+#include "error.hpp"
+
+namespace
+{
+	std::size_t words_( std::size_t aBytes ) noexcept
+	{
+		return (aBytes + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+	}
+}
+
+FrameArena::FrameArena( std::size_t aCapacity )
+	: mBlock( new std::max_align_t[words_(aCapacity)] )
+	, mCapacity( words_(aCapacity) * sizeof(std::max_align_t) )
+	, mOffset( 0 )
+	, mOverflowBytes( 0 )
+	, mHighWater( 0 )
+{}
+
+void* FrameArena::allocate( std::size_t aBytes, std::size_t aAlign )
+{
+	if( 0 == aAlign || 0 != (aAlign & (aAlign-1)) || aAlign > alignof(std::max_align_t) )
+		throw Error( "FrameArena: unsupported alignment %zu", aAlign );
+
+	std::size_t const offset = (mOffset + aAlign - 1) & ~(aAlign - 1);
+	if( offset <= mCapacity && aBytes <= mCapacity - offset )
+	{
+		mOffset = offset + aBytes;
+		return reinterpret_cast<unsigned char*>(mBlock.get()) + offset;
+	}
+
+	// Out of space for this frame. Overflow blocks are always aligned to
+	// std::max_align_t.
+	mOverflow.emplace_back( new std::max_align_t[words_(aBytes)] );
+	mOverflowBytes += aBytes;
+	return mOverflow.back().get();
+}
+
+void FrameArena::reset()
+{
+	mHighWater = std::max( mHighWater, mOffset + mOverflowBytes );
+
+	if( !mOverflow.empty() )
+	{
+		// Leave some room for alignment padding, which was not counted in
+		// the overflow
+		std::size_t const words = words_( mHighWater + mHighWater/4 );
+
+		mOverflow.clear();
+		mBlock.reset( new std::max_align_t[words] );
+		mCapacity = words * sizeof(std::max_align_t);
+		mOverflowBytes = 0;
+	}
+
+	mOffset = 0;
+}
+
+std::size_t FrameArena::used() const noexcept
+{
+	return mOffset + mOverflowBytes;
+}
+std::size_t FrameArena::capacity() const noexcept
+{
+	return mCapacity;
+}
+std::size_t FrameArena::high_water() const noexcept
+{
+	return std::max( mHighWater, mOffset + mOverflowBytes );
+}
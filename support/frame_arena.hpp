@@ -0,0 +1,110 @@
+#ifndef FRAME_ARENA_HPP_1313D9C5_AF85_4DE2_BED5_B37BADF3AE0C
+#define FRAME_ARENA_HPP_1313D9C5_AF85_4DE2_BED5_B37BADF3AE0C
+
+#include <memory>
+#include <vector>
+
+#include <cstddef>
+
+/* FrameArena: linear allocator for per-frame scratch memory
+ *
+ * Allocations bump a pointer in a single block; nothing is freed
+ * individually. reset() (at the start of each frame) releases everything at
+ * once, so memory from the arena must not be kept across a reset.
+ *
+ * If a frame needs more than the block holds, the excess is served from
+ * overflow blocks on the heap. The next reset() frees those and grows the
+ * block to fit the largest frame so far, i.e. the arena only reaches the
+ * heap until it has seen the largest frame. Alignments beyond that of
+ * std::max_align_t are not supported.
+ *
+ * Use ArenaAllocator (below) to put standard containers into the arena.
+ */
+class FrameArena final
+{
+	public:
+		static constexpr std::size_t kDefaultCapacity = 64*1024;
+
+	public:
+		explicit FrameArena( std::size_t aCapacity = kDefaultCapacity );
+
+		FrameArena( FrameArena const& ) = delete;
+		FrameArena& operator= (FrameArena const&) = delete;
+
+	public:
+		void* allocate( std::size_t aBytes, std::size_t aAlign = alignof(std::max_align_t) );
+
+		void reset();
+
+		// Bytes allocated since the last reset(), the size of the block and
+		// the most bytes used in a single frame so far
+		std::size_t used() const noexcept;
+		std::size_t capacity() const noexcept;
+		std::size_t high_water() const noexcept;
+
+	private:
+		std::unique_ptr<std::max_align_t[]> mBlock;
+		std::size_t mCapacity;
+		std::size_t mOffset;
+
+		std::vector<std::unique_ptr<std::max_align_t[]>> mOverflow;
+		std::size_t mOverflowBytes;
+
+		std::size_t mHighWater;
+};
+
+/* ArenaAllocator: standard allocator that allocates from a FrameArena
+ *
+ * deallocate() does nothing; the memory is reclaimed by FrameArena::reset().
+ * Containers using it must therefore not outlive the frame, e.g.
+ *
+ *   FrameVector<Vec4f> colors( count, color, ArenaAllocator<Vec4f>( arena ) );
+ */
+template< typename tType >
+class ArenaAllocator
+{
+	public:
+		using value_type = tType;
+
+	public:
+		explicit ArenaAllocator( FrameArena& aArena ) noexcept
+			: mArena( &aArena )
+		{}
+
+		template< typename tOther >
+		ArenaAllocator( ArenaAllocator<tOther> const& aOther ) noexcept
+			: mArena( aOther.arena() )
+		{}
+
+	public:
+		tType* allocate( std::size_t aCount )
+		{
+			return static_cast<tType*>(mArena->allocate( aCount * sizeof(tType), alignof(tType) ));
+		}
+		void deallocate( tType*, std::size_t ) noexcept
+		{}
+
+		FrameArena* arena() const noexcept
+		{
+			return mArena;
+		}
+
+	private:
+		FrameArena* mArena;
+};
+
+template< typename tLeft, typename tRight >
+bool operator== ( ArenaAllocator<tLeft> const& aLeft, ArenaAllocator<tRight> const& aRight ) noexcept
+{
+	return aLeft.arena() == aRight.arena();
+}
+template< typename tLeft, typename tRight >
+bool operator!= ( ArenaAllocator<tLeft> const& aLeft, ArenaAllocator<tRight> const& aRight ) noexcept
+{
+	return aLeft.arena() != aRight.arena();
+}
+
+template< typename tType >
+using FrameVector = std::vector<tType, ArenaAllocator<tType>>;
+
+#endif // FRAME_ARENA_HPP_1313D9C5_AF85_4DE2_BED5_B37BADF3AE0C
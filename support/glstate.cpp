@@ -0,0 +1,308 @@
+#include "glstate.hpp"
+
+#include <cstring>
+
+namespace
+{
+	// GL object names are never ~0, so this marks a binding as unknown
+	constexpr GLuint kUnknownName_ = ~GLuint(0);
+
+	std::uint64_t uniform_key_( GLuint aProgram, GLint aLocation ) noexcept
+	{
+		return (std::uint64_t(aProgram) << 32) | std::uint32_t(aLocation);
+	}
+}
+
+GLStateCache::GLStateCache()
+	: mFrame{ 0, 0 }
+	, mLastFrame{ 0, 0 }
+	, mTotal{ 0, 0 }
+	, mFrameCount( 0 )
+{
+	invalidate();
+}
+
+bool GLStateCache::issue_( bool aChanged ) noexcept
+{
+	if( aChanged )
+		++mFrame.issued;
+	else
+		++mFrame.elided;
+	return aChanged;
+}
+
+void GLStateCache::use_program( GLuint aProgram )
+{
+	if( issue_( aProgram != mProgram ) )
+	{
+		glUseProgram( aProgram );
+		mProgram = aProgram;
+	}
+}
+
+void GLStateCache::bind_vertex_array( GLuint aVao )
+{
+	if( issue_( aVao != mVao ) )
+	{
+		glBindVertexArray( aVao );
+		mVao = aVao;
+	}
+}
+
+void GLStateCache::bind_texture( GLuint aUnit, GLenum aTarget, GLuint aTexture )
+{
+	if( aUnit >= kTextureUnits_ )
+	{
+		// not tracked; forget the active unit, since we change it here
+		issue_( true );
+		glActiveTexture( GL_TEXTURE0 + aUnit );
+		glBindTexture( aTarget, aTexture );
+		mActiveUnit = kUnknownName_;
+		return;
+	}
+
+	auto& tex = mTextures[aUnit];
+	if( !issue_( aTarget != tex.target || aTexture != tex.name ) )
+		return;
+
+	if( aUnit != mActiveUnit )
+	{
+		glActiveTexture( GL_TEXTURE0 + aUnit );
+		mActiveUnit = aUnit;
+	}
+
+	glBindTexture( aTarget, aTexture );
+	tex.target = aTarget;
+	tex.name = aTexture;
+}
+
+void GLStateCache::enable( GLenum aCap )
+{
+	signed char* shadow = nullptr;
+	switch( aCap )
+	{
+		case GL_BLEND: shadow = &mBlend; break;
+		case GL_DEPTH_TEST: shadow = &mDepthTest; break;
+		case GL_CULL_FACE: shadow = &mCullFace; break;
+	}
+
+	if( issue_( !shadow || 1 != *shadow ) )
+	{
+		glEnable( aCap );
+		if( shadow )
+			*shadow = 1;
+	}
+}
+void GLStateCache::disable( GLenum aCap )
+{
+	signed char* shadow = nullptr;
+	switch( aCap )
+	{
+		case GL_BLEND: shadow = &mBlend; break;
+		case GL_DEPTH_TEST: shadow = &mDepthTest; break;
+		case GL_CULL_FACE: shadow = &mCullFace; break;
+	}
+
+	if( issue_( !shadow || 0 != *shadow ) )
+	{
+		glDisable( aCap );
+		if( shadow )
+			*shadow = 0;
+	}
+}
+
+void GLStateCache::blend_func( GLenum aSrc, GLenum aDst )
+{
+	if( issue_( !mBlendFuncKnown || aSrc != mBlendSrc || aDst != mBlendDst ) )
+	{
+		glBlendFunc( aSrc, aDst );
+		mBlendFuncKnown = true;
+		mBlendSrc = aSrc;
+		mBlendDst = aDst;
+	}
+}
+
+void GLStateCache::depth_mask( GLboolean aMask )
+{
+	signed char const value = GL_FALSE != aMask ? 1 : 0;
+	if( issue_( value != mDepthMask ) )
+	{
+		glDepthMask( aMask );
+		mDepthMask = value;
+	}
+}
+
+void GLStateCache::depth_func( GLenum aFunc )
+{
+	if( issue_( !mDepthFuncKnown || aFunc != mDepthFunc ) )
+	{
+		glDepthFunc( aFunc );
+		mDepthFuncKnown = true;
+		mDepthFunc = aFunc;
+	}
+}
+
+void GLStateCache::color_mask( GLboolean aMask )
+{
+	signed char const value = GL_FALSE != aMask ? 1 : 0;
+	if( issue_( value != mColorMask ) )
+	{
+		glColorMask( aMask, aMask, aMask, aMask );
+		mColorMask = value;
+	}
+}
+
+void GLStateCache::viewport( GLint aX, GLint aY, GLsizei aWidth, GLsizei aHeight )
+{
+	GLint const vp[4] = { aX, aY, aWidth, aHeight };
+	if( issue_( !mViewportKnown || 0 != std::memcmp( vp, mViewport, sizeof(vp) ) ) )
+	{
+		glViewport( aX, aY, aWidth, aHeight );
+		mViewportKnown = true;
+		std::memcpy( mViewport, vp, sizeof(vp) );
+
+		for( auto& known : mIndexedViewportKnown )
+			known = false;
+	}
+}
+void GLStateCache::viewport_indexed( GLuint aIndex, GLfloat aX, GLfloat aY, GLfloat aWidth, GLfloat aHeight )
+{
+	GLfloat const vp[4] = { aX, aY, aWidth, aHeight };
+	if( aIndex >= kViewports_ )
+	{
+		issue_( true );
+		glViewportIndexedf( aIndex, aX, aY, aWidth, aHeight );
+		return;
+	}
+
+	if( issue_( !mIndexedViewportKnown[aIndex] || 0 != std::memcmp( vp, mIndexedViewport[aIndex], sizeof(vp) ) ) )
+	{
+		glViewportIndexedf( aIndex, aX, aY, aWidth, aHeight );
+		mIndexedViewportKnown[aIndex] = true;
+		std::memcpy( mIndexedViewport[aIndex], vp, sizeof(vp) );
+
+		if( 0 == aIndex )
+			mViewportKnown = false;
+	}
+}
+
+// The shadow holds the raw bytes of the value followed by aTag. The tag is
+// used for the transpose flag of matrices, which changes how the same floats
+// are interpreted.
+bool GLStateCache::uniform_changed_( GLint aLocation, void const* aData, std::size_t aBytes, unsigned char aTag )
+{
+	// Without a known program, there is nothing to key the value on.
+	if( kUnknownName_ == mProgram || 0 == mProgram || aLocation < 0 )
+		return issue_( true );
+
+	auto& value = mUniforms[uniform_key_( mProgram, aLocation )];
+	if( value.size() == aBytes+1 && aTag == value[aBytes] && 0 == std::memcmp( value.data(), aData, aBytes ) )
+		return issue_( false );
+
+	value.resize( aBytes+1 );
+	std::memcpy( value.data(), aData, aBytes );
+	value[aBytes] = aTag;
+	return issue_( true );
+}
+
+void GLStateCache::uniform1i( GLint aLocation, GLint aValue )
+{
+	if( uniform_changed_( aLocation, &aValue, sizeof(aValue) ) )
+		glUniform1i( aLocation, aValue );
+}
+void GLStateCache::uniform1ui( GLint aLocation, GLuint aValue )
+{
+	if( uniform_changed_( aLocation, &aValue, sizeof(aValue) ) )
+		glUniform1ui( aLocation, aValue );
+}
+void GLStateCache::uniform1f( GLint aLocation, GLfloat aValue )
+{
+	if( uniform_changed_( aLocation, &aValue, sizeof(aValue) ) )
+		glUniform1f( aLocation, aValue );
+}
+void GLStateCache::uniform3f( GLint aLocation, GLfloat aX, GLfloat aY, GLfloat aZ )
+{
+	GLfloat const value[3] = { aX, aY, aZ };
+	if( uniform_changed_( aLocation, value, sizeof(value) ) )
+		glUniform3f( aLocation, aX, aY, aZ );
+}
+void GLStateCache::uniform3fv( GLint aLocation, GLsizei aCount, GLfloat const* aValues )
+{
+	if( uniform_changed_( aLocation, aValues, 3*aCount*sizeof(GLfloat) ) )
+		glUniform3fv( aLocation, aCount, aValues );
+}
+void GLStateCache::uniform4fv( GLint aLocation, GLsizei aCount, GLfloat const* aValues )
+{
+	if( uniform_changed_( aLocation, aValues, 4*aCount*sizeof(GLfloat) ) )
+		glUniform4fv( aLocation, aCount, aValues );
+}
+
+void GLStateCache::uniform_matrix3fv( GLint aLocation, GLsizei aCount, GLboolean aTranspose, GLfloat const* aValues )
+{
+	if( uniform_changed_( aLocation, aValues, 9*aCount*sizeof(GLfloat), aTranspose ) )
+		glUniformMatrix3fv( aLocation, aCount, aTranspose, aValues );
+}
+void GLStateCache::uniform_matrix4fv( GLint aLocation, GLsizei aCount, GLboolean aTranspose, GLfloat const* aValues )
+{
+	if( uniform_changed_( aLocation, aValues, 16*aCount*sizeof(GLfloat), aTranspose ) )
+		glUniformMatrix4fv( aLocation, aCount, aTranspose, aValues );
+}
+
+void GLStateCache::forget_program( GLuint aProgram )
+{
+	for( auto it = mUniforms.begin(); it != mUniforms.end(); )
+	{
+		if( GLuint(it->first >> 32) == aProgram )
+			it = mUniforms.erase( it );
+		else
+			++it;
+	}
+
+	if( aProgram == mProgram )
+		mProgram = kUnknownName_;
+}
+
+void GLStateCache::invalidate() noexcept
+{
+	mProgram = kUnknownName_;
+	mVao = kUnknownName_;
+
+	mActiveUnit = kUnknownName_;
+	for( auto& tex : mTextures )
+		tex = Texture_{ GL_NONE, kUnknownName_ };
+
+	mBlend = mDepthTest = mCullFace = -1;
+	mDepthMask = -1;
+	mColorMask = -1;
+
+	mBlendFuncKnown = false;
+	mDepthFuncKnown = false;
+	mViewportKnown = false;
+	for( auto& known : mIndexedViewportKnown )
+		known = false;
+
+	mUniforms.clear();
+}
+
+void GLStateCache::end_frame() noexcept
+{
+	mLastFrame = mFrame;
+	mTotal.issued += mFrame.issued;
+	mTotal.elided += mFrame.elided;
+	++mFrameCount;
+
+	mFrame = Counters{ 0, 0 };
+}
+
+GLStateCache::Counters const& GLStateCache::last_frame() const noexcept
+{
+	return mLastFrame;
+}
+GLStateCache::Counters const& GLStateCache::total() const noexcept
+{
+	return mTotal;
+}
+std::size_t GLStateCache::frame_count() const noexcept
+{
+	return mFrameCount;
+}
@@ -0,0 +1,127 @@
+#ifndef GLSTATE_HPP_5C4F06A1_2C71_417E_A9D8_1DFFB53FE066
+#define GLSTATE_HPP_5C4F06A1_2C71_417E_A9D8_1DFFB53FE066
+
+#include <glad.h>
+
+#include <vector>
+#include <unordered_map>
+
+#include <cstddef>
+#include <cstdint>
+
+/* GLStateCache: shadows a subset of the OpenGL state and drops redundant calls
+ *
+ * Tracks the bound program and VAO, texture bindings, the blend/depth/cull
+ * enables, blend function, depth function, depth and color masks and
+ * viewports. Uniform values are shadowed per program and location, so
+ * re-setting a constant uniform (e.g. a material color) every draw only
+ * reaches the driver when it changes.
+ *
+ * All state starts out as "unknown", i.e. the first call of each kind is
+ * always issued. Code that changes tracked state behind the cache's back
+ * must call invalidate() afterwards. When a program is deleted or relinked,
+ * call forget_program() so that its name can be safely reused.
+ *
+ * Counts of issued and elided calls are collected per frame, see
+ * end_frame().
+ */
+class GLStateCache final
+{
+	public:
+		struct Counters
+		{
+			std::size_t issued;
+			std::size_t elided;
+		};
+
+	public:
+		GLStateCache();
+
+		GLStateCache( GLStateCache const& ) = delete;
+		GLStateCache& operator= (GLStateCache const&) = delete;
+
+	public:
+		void use_program( GLuint );
+		void bind_vertex_array( GLuint );
+		void bind_texture( GLuint aUnit, GLenum aTarget, GLuint aTexture );
+
+		// Only GL_BLEND, GL_DEPTH_TEST and GL_CULL_FACE are shadowed. Other
+		// capabilities are forwarded as-is.
+		void enable( GLenum );
+		void disable( GLenum );
+
+		void blend_func( GLenum aSrc, GLenum aDst );
+		void depth_mask( GLboolean );
+		void depth_func( GLenum );
+		// All four channels at once
+		void color_mask( GLboolean );
+		void viewport( GLint aX, GLint aY, GLsizei aWidth, GLsizei aHeight );
+		void viewport_indexed( GLuint aIndex, GLfloat aX, GLfloat aY, GLfloat aWidth, GLfloat aHeight );
+
+		// Uniforms of the current program (see use_program())
+		void uniform1i( GLint aLocation, GLint );
+		void uniform1ui( GLint aLocation, GLuint );
+		void uniform1f( GLint aLocation, GLfloat );
+		void uniform3f( GLint aLocation, GLfloat, GLfloat, GLfloat );
+		void uniform3fv( GLint aLocation, GLsizei aCount, GLfloat const* );
+		void uniform4fv( GLint aLocation, GLsizei aCount, GLfloat const* );
+		void uniform_matrix3fv( GLint aLocation, GLsizei aCount, GLboolean aTranspose, GLfloat const* );
+		void uniform_matrix4fv( GLint aLocation, GLsizei aCount, GLboolean aTranspose, GLfloat const* );
+
+		void forget_program( GLuint );
+		void invalidate() noexcept;
+
+		// Finish the current frame: its counters become last_frame() and are
+		// added to total(). Counting restarts from zero.
+		void end_frame() noexcept;
+
+		Counters const& last_frame() const noexcept;
+		Counters const& total() const noexcept;
+		std::size_t frame_count() const noexcept;
+
+	private:
+		struct Texture_
+		{
+			GLenum target;
+			GLuint name;
+		};
+
+		static constexpr std::size_t kTextureUnits_ = 16;
+		static constexpr std::size_t kViewports_ = 4;
+
+		bool issue_( bool aChanged ) noexcept;
+		bool uniform_changed_( GLint aLocation, void const*, std::size_t aBytes, unsigned char aTag = 0 );
+
+		GLuint mProgram;
+		GLuint mVao;
+
+		GLuint mActiveUnit;
+		Texture_ mTextures[kTextureUnits_];
+
+		// -1 = unknown, 0 = disabled, 1 = enabled
+		signed char mBlend, mDepthTest, mCullFace;
+		signed char mDepthMask;
+		signed char mColorMask;
+
+		bool mDepthFuncKnown;
+		GLenum mDepthFunc;
+
+		bool mBlendFuncKnown;
+		GLenum mBlendSrc, mBlendDst;
+
+		bool mViewportKnown;
+		GLint mViewport[4];
+
+		// glViewport() sets all viewports, so it forgets these (and vice
+		// versa for index 0).
+		bool mIndexedViewportKnown[kViewports_];
+		GLfloat mIndexedViewport[kViewports_][4];
+
+		// keyed by (program << 32 | location)
+		std::unordered_map<std::uint64_t, std::vector<unsigned char>> mUniforms;
+
+		Counters mFrame, mLastFrame, mTotal;
+		std::size_t mFrameCount;
+};
+
+#endif // GLSTATE_HPP_5C4F06A1_2C71_417E_A9D8_1DFFB53FE066
@@ -0,0 +1,61 @@
+#include "heap_counter.hpp"
+
+#include <new>
+
+#include <cstdlib>
+
+#if !defined(NDEBUG)
+namespace
+{
+	// Per thread: the launch thread, the fleet workers and the file watcher
+	// allocate on their own schedule, which must not show up in the render
+	// thread's count. A trivial thread_local needs no dynamic initialization,
+	// so it is safe to touch from operator new.
+	thread_local std::size_t tHeapAllocations_ = 0;
+
+	void* counted_alloc_( std::size_t aBytes ) noexcept
+	{
+		++tHeapAllocations_;
+		return std::malloc( aBytes ? aBytes : 1 );
+	}
+}
+
+// The array and nothrow forms forward to these by default. Over-aligned
+// allocations (std::align_val_t) are not counted.
+void* operator new( std::size_t aBytes )
+{
+	if( void* ptr = counted_alloc_( aBytes ) )
+		return ptr;
+	throw std::bad_alloc();
+}
+void* operator new[]( std::size_t aBytes )
+{
+	return ::operator new( aBytes );
+}
+
+void operator delete( void* aPtr ) noexcept
+{
+	std::free( aPtr );
+}
+void operator delete[]( void* aPtr ) noexcept
+{
+	std::free( aPtr );
+}
+void operator delete( void* aPtr, std::size_t ) noexcept
+{
+	std::free( aPtr );
+}
+void operator delete[]( void* aPtr, std::size_t ) noexcept
+{
+	std::free( aPtr );
+}
+#endif // ~ !NDEBUG
+
+std::size_t heap_allocation_count() noexcept
+{
+#	if !defined(NDEBUG)
+	return tHeapAllocations_;
+#	else
+	return 0;
+#	endif
+}
@@ -0,0 +1,25 @@
+#ifndef HEAP_COUNTER_HPP_1CA180A2_5509_4106_A62F_33A30FD49B17
+#define HEAP_COUNTER_HPP_1CA180A2_5509_4106_A62F_33A30FD49B17
+
+#include <cstddef>
+
+/* Heap allocation counter (debug builds)
+ *
+ * Debug builds replace the global operator new (and delete) with versions
+ * that count the calls. heap_allocation_count() returns the number of calls
+ * so far on the calling thread; take the difference over a section of code
+ * to check that it does not allocate. Other threads' allocations are not
+ * included. Release builds (NDEBUG) do not count, and
+ * heap_allocation_count() always returns zero.
+ */
+constexpr bool kHeapAllocationsCounted =
+#	if defined(NDEBUG)
+	false
+#	else
+	true
+#	endif
+;
+
+std::size_t heap_allocation_count() noexcept;
+
+#endif // HEAP_COUNTER_HPP_1CA180A2_5509_4106_A62F_33A30FD49B17
@@ -10,13 +10,48 @@
 
 #include "error.hpp"
 #include "checkpoint.hpp"
+#include "program_cache.hpp"
 
 namespace
 {
-	GLuint load_shader_( 
+	std::string read_source_( 
+		char const* aSourcePath
+	);
+
+	GLuint submit_shader_( 
+		GLenum aShaderType, 
+		std::string const& aSource
+	);
+	void check_shader_(
+		GLuint aShader,
 		GLenum aShaderType, 
 		char const* aSourcePath
 	);
+	void check_program_(
+		GLuint aProgram
+	);
+
+	GLuint submit_cached_program_(
+		ProgramBinaryCache&,
+		std::uint64_t aKey,
+		GLenum& aError
+	);
+	bool check_cached_program_(
+		ProgramBinaryCache&,
+		std::uint64_t aKey,
+		GLuint aProgram,
+		GLenum aError
+	);
+
+	// KHR_parallel_shader_compile (or the ARB variant, same values) isn't
+	// part of the glad loader, so the bits used here are defined manually.
+	constexpr GLenum kMaxShaderCompilerThreads_ = 0x91B0; // GL_MAX_SHADER_COMPILER_THREADS_KHR
+	constexpr GLenum kCompletionStatus_ = 0x91B1; // GL_COMPLETION_STATUS_KHR
+
+	using MaxShaderCompilerThreadsFn_ = void (APIENTRY*)( GLuint );
+
+	// set by ShaderProgram::enable_parallel_compile()
+	bool parallel_compile_enabled_ = false;
 
 	// lightweight std::experimental::scope_exit alternative
 	// Not the most complete or convenient implementation...
@@ -37,15 +72,22 @@ namespace
 	}
 }
 
-ShaderProgram::ShaderProgram( std::vector<ShaderSource> aShaderSources )
+ShaderProgram::ShaderProgram( std::vector<ShaderSource> aShaderSources, ProgramBinaryCache* aCache, Build aBuild )
 	: mProgram( 0 )
 	, mSources( std::move(aShaderSources) )
+	, mCache( aCache )
+	, mPending{}
 {
-	reload();
+	if( Build::deferred == aBuild )
+		submit();
+	else
+		reload();
 }
 
 ShaderProgram::~ShaderProgram()
 {
+	discard_pending_();
+
 	if( 0 != mProgram )
 		glDeleteProgram( mProgram );
 }
@@ -53,11 +95,17 @@ ShaderProgram::~ShaderProgram()
 ShaderProgram::ShaderProgram( ShaderProgram&& aOther ) noexcept
 	: mProgram( std::exchange( aOther.mProgram, 0 ) )
 	, mSources( std::move(aOther.mSources) )
+	, mCache( std::exchange( aOther.mCache, nullptr ) )
+	, mSourceTexts( std::move(aOther.mSourceTexts) )
+	, mPending( std::exchange( aOther.mPending, Pending_{} ) )
 {}
 ShaderProgram& ShaderProgram::operator= (ShaderProgram&& aOther) noexcept
 {
 	std::swap( mProgram, aOther.mProgram );
 	std::swap( mSources, aOther.mSources );
+	std::swap( mCache, aOther.mCache );
+	std::swap( mSourceTexts, aOther.mSourceTexts );
+	std::swap( mPending, aOther.mPending );
 	return *this;
 }
 
@@ -68,82 +116,209 @@ GLuint ShaderProgram::programId() const noexcept
 
 void ShaderProgram::reload()
 {
-	// Space to hold the shaders when we load them
-	std::vector<GLuint> shaders;
-	shaders.reserve( mSources.size() );
+	submit();
+	finish();
+}
 
-	// Ensure that shaders are cleaned up properly, regardless of how we leave
-	// the function (e.g., either by returning or by exception)
-	auto const scopeShaders_ = scope_exit_( [&shaders] {
-		for( auto const shader : shaders )
-			glDeleteShader( shader );
-	} );
+void ShaderProgram::submit()
+{
+	// Read all sources up front; the cache key depends on them
+	std::vector<std::pair<GLenum,std::string>> sources;
+	sources.reserve( mSources.size() );
+	for( auto const& source : mSources )
+		sources.emplace_back( source.type, read_source_( source.sourcePath.c_str() ) );
 
-	// Load shaders
+	submit_( std::move(sources) );
+}
+
+std::vector<ShaderProgram::ShaderSource> const& ShaderProgram::sources() const noexcept
+{
+	return mSources;
+}
+
+bool ShaderProgram::uses( std::string const& aPath ) const noexcept
+{
 	for( auto const& source : mSources )
-		shaders.emplace_back( load_shader_( source.type, source.sourcePath.c_str() ) );
+	{
+		if( source.sourcePath == aPath )
+			return true;
+	}
+	return false;
+}
 
-	// Create program object
-	OGL_CHECKPOINT_ALWAYS();
+void ShaderProgram::reload_source( std::string const& aPath, std::string aText )
+{
+	// Not built successfully yet, so the other sources aren't known
+	if( mSourceTexts.size() != mSources.size() )
+	{
+		reload();
+		return;
+	}
 
-	GLuint prog = glCreateProgram();
+	auto sources = mSourceTexts;
+	for( std::size_t i = 0; i < mSources.size(); ++i )
+	{
+		if( mSources[i].sourcePath == aPath )
+			sources[i].second = aText;
+	}
 
-	// Ensure that the program is cleaned up. 
+	submit_( std::move(sources) );
+	finish();
+}
 
-	/* There is a small trick here. If we successfully compile and link the new
-	 * program, we will replace the value of the "prog" variable with the old
-	 * program's ID. In this case, the following will delete the old program
-	 * (if there was any). If we do not reach the end (e.g. exception thrown),
-	 * the new program ID will still be in the "prog" variable, and we will
-	 * delete it appropriately. (However, the old program in mProgram is left
-	 * intact).
-	 */
-	auto const scopeProgram_ = scope_exit_( [&prog] {
-		if( 0 != prog )
-			glDeleteProgram( prog );
-	} );
+bool ShaderProgram::pending() const noexcept
+{
+	return 0 != mPending.program;
+}
 
-	// Link individual shaders to create the final shader program
-	for( auto const shader : shaders )
-		glAttachShader( prog, shader );
+bool ShaderProgram::ready() const
+{
+	if( !pending() || !parallel_compile_enabled_ )
+		return true;
+
+	// Without the extension, these queries are not available and the
+	// driver compiles synchronously anyway.
+	GLint done = GL_FALSE;
+	glGetProgramiv( mPending.program, kCompletionStatus_, &done );
+	return GL_FALSE != done;
+}
 
-	glLinkProgram( prog );
+void ShaderProgram::finish()
+{
+	if( !pending() )
+		return;
 
-	{
-		// Get info log
-		GLint logLength = 0;
-		glGetProgramiv( prog, GL_INFO_LOG_LENGTH, &logLength );
+	// Ensure that the pending work is cleaned up properly, regardless of how
+	// we leave the function (e.g., either by returning or by exception)
+	auto const scopePending_ = scope_exit_( [this] {
+		discard_pending_();
+	} );
 
-		std::vector<GLchar> log;
-		if( logLength )
+	if( mPending.fromCache )
+	{
+		if( check_cached_program_( *mCache, mPending.cacheKey, mPending.program, mPending.binaryError ) )
 		{
-			log.resize( logLength );
-			glGetProgramInfoLog( prog, GLsizei(log.size()), nullptr, log.data() );
+			// Replace the old shader program (if any) with the cached one
+			std::swap( mProgram, mPending.program );
+			mSourceTexts = std::move(mPending.sources);
+			return;
 		}
 
-		// Check link status
-		GLint status = 0;
-		glGetProgramiv( prog, GL_LINK_STATUS, &status );
+		// Fall back to compiling. This happens once per changed driver, so
+		// it is not worth deferring again.
+		auto sources = std::move(mPending.sources);
+		auto const cacheKey = mPending.cacheKey;
+		discard_pending_();
+		mPending.sources = std::move(sources);
+		mPending.cacheKey = cacheKey;
+		submit_sources_();
+	}
 
-		if( GL_TRUE != status )
-			throw Error( "Shader program linking failed: \n%s\n", log.data() );
+	for( std::size_t i = 0; i < mPending.shaders.size(); ++i )
+		check_shader_( mPending.shaders[i], mSources[i].type, mSources[i].sourcePath.c_str() );
 
-		if( !log.empty() )
-			std::fprintf( stderr, "Note: shader program linking log:\n%s\n", log.data() );
+	check_program_( mPending.program );
+
+	if( mCache && mCache->enabled() )
+		mCache->store( mPending.cacheKey, mPending.program );
+	if( mCache )
+		mCache->count_miss();
+
+	OGL_CHECKPOINT_ALWAYS();
+
+	/* Replace the old shader program (if any) with the new one. The old
+	 * program ends up in mPending and is deleted with it. If we do not reach
+	 * this point (e.g. exception thrown), the new program is deleted instead,
+	 * and the old program in mProgram is left intact.
+	 */
+	std::swap( mProgram, mPending.program );
+	mSourceTexts = std::move(mPending.sources);
+}
+
+bool ShaderProgram::enable_parallel_compile()
+{
+	if( !glfwExtensionSupported( "GL_KHR_parallel_shader_compile" ) && !glfwExtensionSupported( "GL_ARB_parallel_shader_compile" ) )
+		return false;
+
+	auto maxThreads = reinterpret_cast<MaxShaderCompilerThreadsFn_>(glfwGetProcAddress( "glMaxShaderCompilerThreadsKHR" ));
+	if( !maxThreads )
+		maxThreads = reinterpret_cast<MaxShaderCompilerThreadsFn_>(glfwGetProcAddress( "glMaxShaderCompilerThreadsARB" ));
+
+	// 0xFFFFFFFF lets the driver pick the number of threads
+	if( maxThreads )
+		maxThreads( 0xFFFFFFFFu );
+
+	parallel_compile_enabled_ = true;
+	return true;
+}
+
+void ShaderProgram::submit_( std::vector<std::pair<GLenum,std::string>> aSources )
+{
+	// A previous submit() that was never finished is dropped
+	discard_pending_();
+
+	bool const useCache = mCache && mCache->enabled();
+	mPending.cacheKey = useCache ? mCache->key( aSources ) : 0;
+
+	// keep the sources, for reload_source() and in case the driver rejects
+	// a cached binary
+	mPending.sources = std::move(aSources);
+
+	if( useCache )
+	{
+		mPending.program = submit_cached_program_( *mCache, mPending.cacheKey, mPending.binaryError );
+		if( 0 != mPending.program )
+		{
+			mPending.fromCache = true;
+			return;
+		}
 	}
-	
+
+	submit_sources_();
+}
+
+void ShaderProgram::submit_sources_()
+{
+	// Shaders and program go into mPending right away, so that they are
+	// cleaned up by discard_pending_() if anything below throws.
+	mPending.shaders.reserve( mPending.sources.size() );
+	for( auto const& source : mPending.sources )
+		mPending.shaders.emplace_back( submit_shader_( source.first, source.second ) );
+
+	// Create program object
 	OGL_CHECKPOINT_ALWAYS();
 
-	// Replace the old shader program (if any) with the new one
-	std::swap( mProgram, prog );
+	mPending.program = glCreateProgram();
+
+	// Link individual shaders to create the final shader program
+	for( auto const shader : mPending.shaders )
+		glAttachShader( mPending.program, shader );
+
+	if( mCache && mCache->enabled() )
+		glProgramParameteri( mPending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE );
+
+	// Linking doesn't wait for the compiles either; the link status is
+	// only checked by finish().
+	glLinkProgram( mPending.program );
+}
+
+void ShaderProgram::discard_pending_() noexcept
+{
+	for( auto const shader : mPending.shaders )
+		glDeleteShader( shader );
+
+	if( 0 != mPending.program )
+		glDeleteProgram( mPending.program );
+
+	mPending = Pending_{};
 }
 
 namespace
 {
-	GLuint load_shader_( GLenum aShaderType, char const* aSourcePath )
+	std::string read_source_( char const* aSourcePath )
 	{
 		// Load the shader source code from file
-		std::vector<GLchar> source;
+		std::string source;
 
 		if( std::FILE* fin = std::fopen( aSourcePath, "rb" ) )
 		{
@@ -158,14 +333,14 @@ namespace
 			source.resize( length );
 			for( std::size_t read = 0; read != length; )
 			{
-				auto const ret = std::fread( source.data()+read, 1, length-read, fin );
+				auto const ret = std::fread( &source[read], 1, length-read, fin );
 
 				if( 0 == ret )
 				{
 					if( auto const err = std::ferror( fin ) )
-						throw Error( "load_shader_(): error while reading from '%s': %d (%zu bytes read, %zu total)", aSourcePath, err, read, length );
+						throw Error( "read_source_(): error while reading from '%s': %d (%zu bytes read, %zu total)", aSourcePath, err, read, length );
 					if( std::feof( fin ) )
-						throw Error( "load_shader_(): unexpected EOF in '%s' (%zu bytes read, %zu total)", aSourcePath, read, length );
+						throw Error( "read_source_(): unexpected EOF in '%s' (%zu bytes read, %zu total)", aSourcePath, read, length );
 				}
 			
 				read += ret;
@@ -173,9 +348,14 @@ namespace
 		}
 		else
 		{
-			throw Error( "load_shader_(): unable to open input file '%s'", aSourcePath );
+			throw Error( "read_source_(): unable to open input file '%s'", aSourcePath );
 		}
 
+		return source;
+	}
+
+	GLuint submit_shader_( GLenum aShaderType, std::string const& aSource )
+	{
 		// Create shader object
 		OGL_CHECKPOINT_ALWAYS();
 
@@ -183,31 +363,38 @@ namespace
 
 		// Compile shader
 		GLchar const* sources[] = {
-			source.data()
+			aSource.data()
 		};
 		GLsizei lengths[] = {
-			GLsizei(source.size())
+			GLsizei(aSource.size())
 		};
 
 		glShaderSource( shader, sizeof(sources)/sizeof(sources[0]), sources, lengths );
 
+		// Querying anything about the shader here would wait for the compile
+		// to complete. This is left to check_shader_().
 		glCompileShader( shader );
 
 		OGL_CHECKPOINT_ALWAYS();
 
+		return shader;
+	}
+
+	void check_shader_( GLuint aShader, GLenum aShaderType, char const* aSourcePath )
+	{
 		// Get compile info log
 		/* The compile log is mainly relevant if there is an error. However, on some
 		 * systems, it can include additional information even if compilation was
 		 * successful. This might include warnings and/or usage hints.
 		 */
 		GLint logLength = 0;
-		glGetShaderiv( shader, GL_INFO_LOG_LENGTH, &logLength );
+		glGetShaderiv( aShader, GL_INFO_LOG_LENGTH, &logLength );
 
 		std::vector<GLchar> log;
 		if( logLength )
 		{
 			log.resize( logLength );
-			glGetShaderInfoLog( shader, GLsizei(log.size()), nullptr, log.data() );
+			glGetShaderInfoLog( aShader, GLsizei(log.size()), nullptr, log.data() );
 		}
 
 		char const* shaderTypeName = "unknown shader";
@@ -223,19 +410,77 @@ namespace
 
 		// Check compile status
 		GLint status = 0;
-		glGetShaderiv( shader, GL_COMPILE_STATUS, &status );
+		glGetShaderiv( aShader, GL_COMPILE_STATUS, &status );
 
 		if( GL_TRUE != status )
-		{
-			glDeleteShader( shader );
 			throw Error( "%s \"%s\" compilation failed:\n%s\n", shaderTypeName, aSourcePath, log.data() );
-		}
 
 		if( !log.empty() )
 			std::fprintf( stderr, "Note: %s \"%s\" log:\n%s\n", shaderTypeName, aSourcePath, log.data() );
 
 		OGL_CHECKPOINT_ALWAYS();
+	}
 
-		return shader;
+	void check_program_( GLuint aProgram )
+	{
+		// Get info log
+		GLint logLength = 0;
+		glGetProgramiv( aProgram, GL_INFO_LOG_LENGTH, &logLength );
+
+		std::vector<GLchar> log;
+		if( logLength )
+		{
+			log.resize( logLength );
+			glGetProgramInfoLog( aProgram, GLsizei(log.size()), nullptr, log.data() );
+		}
+
+		// Check link status
+		GLint status = 0;
+		glGetProgramiv( aProgram, GL_LINK_STATUS, &status );
+
+		if( GL_TRUE != status )
+			throw Error( "Shader program linking failed: \n%s\n", log.data() );
+
+		if( !log.empty() )
+			std::fprintf( stderr, "Note: shader program linking log:\n%s\n", log.data() );
+	}
+
+	GLuint submit_cached_program_( ProgramBinaryCache& aCache, std::uint64_t aKey, GLenum& aError )
+	{
+		GLenum format = 0;
+		std::vector<unsigned char> binary;
+		if( !aCache.load( aKey, format, binary ) )
+			return 0;
+
+		OGL_CHECKPOINT_ALWAYS();
+
+		GLuint prog = glCreateProgram();
+		glProgramBinary( prog, format, binary.data(), GLsizei(binary.size()) );
+
+		// An unknown format raises an error right away. Errors are global
+		// state, so this has to be checked now rather than in finish().
+		aError = glGetError();
+		return prog;
+	}
+
+	bool check_cached_program_( ProgramBinaryCache& aCache, std::uint64_t aKey, GLuint aProgram, GLenum aError )
+	{
+		// Drivers reject binaries e.g. after an update that didn't change the
+		// version string. Either by raising an error (unknown format) or by
+		// failing the link.
+		GLint status = 0;
+		glGetProgramiv( aProgram, GL_LINK_STATUS, &status );
+
+		if( GL_NO_ERROR != aError || GL_TRUE != status )
+		{
+			std::fprintf( stderr, "Note: cached shader program %016llx rejected by the driver. Recompiling.\n", static_cast<unsigned long long>(aKey) );
+
+			aCache.remove( aKey );
+			aCache.count_rejected();
+			return false;
+		}
+
+		aCache.count_hit();
+		return true;
 	}
 }
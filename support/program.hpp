@@ -5,10 +5,13 @@
 
 #include <string>
 #include <vector>
+#include <utility>
 
 #include <cstdint>
 #include <cstdlib>
 
+class ProgramBinaryCache;
+
 class ShaderProgram final
 {
 	public:
@@ -18,9 +21,21 @@ class ShaderProgram final
 			std::string sourcePath;
 		};
 
+		// Build::immediate returns with a linked program (or throws).
+		// Build::deferred only submits the shaders, see submit().
+		enum class Build
+		{
+			immediate,
+			deferred
+		};
+
 	public:
+		// With a cache, linked programs are loaded from and stored to the
+		// cache (see program_cache.hpp). The cache must outlive the program.
 		explicit ShaderProgram( 
-			std::vector<ShaderSource> = {}
+			std::vector<ShaderSource> = {},
+			ProgramBinaryCache* = nullptr,
+			Build = Build::immediate
 		);
 
 		~ShaderProgram();
@@ -32,13 +47,68 @@ class ShaderProgram final
 		ShaderProgram& operator= (ShaderProgram&&) noexcept;
 
 	public:
+		// Zero for a deferred program until finish() succeeds
 		GLuint programId() const noexcept;
 
+		// Same as submit() followed by finish()
 		void reload();
 
+		// Hand the shaders to the driver without checking compile or link
+		// status, which would wait for them. Submitting all programs before
+		// finishing any lets the driver compile them in parallel (with
+		// enable_parallel_compile()) while the caller does other work.
+		void submit();
+
+		// Non-blocking; true once the submitted program is compiled and
+		// linked. Always true without parallel compilation.
+		bool ready() const;
+		bool pending() const noexcept;
+
+		// Wait for the submitted program and check it. On success, it
+		// replaces the current program. Throws like reload(), in which case
+		// the current program is kept.
+		void finish();
+
+		std::vector<ShaderSource> const& sources() const noexcept;
+
+		// True if aPath is one of the program's sources
+		bool uses( std::string const& aPath ) const noexcept;
+
+		// Rebuild with the contents of source aPath replaced by aText. The
+		// other sources are taken from the last successful build, so no
+		// files are read (e.g. aText comes from a FileWatcher). Throws like
+		// reload(), in which case the current program is kept.
+		void reload_source( std::string const& aPath, std::string aText );
+
+		// Enable KHR_parallel_shader_compile (or ARB_parallel_shader_compile)
+		// if supported. Requires a current context. Returns false if neither
+		// is available; submit()/finish() still work, only without overlap.
+		static bool enable_parallel_compile();
+
 	private:
+		struct Pending_
+		{
+			GLuint program;
+			std::vector<GLuint> shaders;
+
+			std::uint64_t cacheKey;
+			bool fromCache;
+			GLenum binaryError;
+			std::vector<std::pair<GLenum,std::string>> sources;
+		};
+
+		void submit_( std::vector<std::pair<GLenum,std::string>> );
+		void submit_sources_();
+		void discard_pending_() noexcept;
+
 		GLuint mProgram;
 		std::vector<ShaderSource> mSources;
+		ProgramBinaryCache* mCache;
+
+		// (type, text) of each source of the current program
+		std::vector<std::pair<GLenum,std::string>> mSourceTexts;
+
+		Pending_ mPending;
 };
 
 #endif // PROGRAM_HPP_39793FD2_7845_47A7_9E21_6DDAD42C9A09
@@ -0,0 +1,190 @@
+#include "program_cache.hpp"
+
+#include <filesystem>
+#include <system_error>
+
+#include <cstdio>
+#include <cstring>
+#include <cinttypes>
+
+namespace
+{
+	constexpr char kMagic_[4] = { 'V', 'M', 'P', 'B' };
+
+	struct FileHeader_
+	{
+		char magic[4];
+		std::uint32_t format;
+		std::uint64_t key;
+		std::uint64_t length;
+	};
+
+	// 64-bit FNV-1a
+	constexpr std::uint64_t kFnvOffset_ = 0xcbf29ce484222325ull;
+	constexpr std::uint64_t kFnvPrime_ = 0x100000001b3ull;
+
+	std::uint64_t fnv1a_( std::uint64_t aHash, void const* aData, std::size_t aBytes ) noexcept
+	{
+		auto const* bytes = static_cast<unsigned char const*>(aData);
+		for( std::size_t i = 0; i < aBytes; ++i )
+		{
+			aHash ^= bytes[i];
+			aHash *= kFnvPrime_;
+		}
+		return aHash;
+	}
+
+	std::uint64_t fnv1a_( std::uint64_t aHash, char const* aString ) noexcept
+	{
+		// include the terminator, so that ("ab","c") and ("a","bc") differ
+		return fnv1a_( aHash, aString, std::strlen( aString ) + 1 );
+	}
+}
+
+ProgramBinaryCache::ProgramBinaryCache( std::string aDirectory )
+	: mDirectory( std::move(aDirectory) )
+	, mDriverHash( kFnvOffset_ )
+	, mEnabled( false )
+	, mStats{ 0, 0, 0 }
+{
+	GLint formats = 0;
+	glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &formats );
+	if( formats <= 0 )
+	{
+		std::fprintf( stderr, "Note: driver supports no program binary formats. Shader cache disabled.\n" );
+		return;
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories( mDirectory, ec );
+	if( ec )
+	{
+		std::fprintf( stderr, "Note: unable to create shader cache directory '%s': %s. Shader cache disabled.\n", mDirectory.c_str(), ec.message().c_str() );
+		return;
+	}
+
+	auto const* renderer = reinterpret_cast<char const*>(glGetString( GL_RENDERER ));
+	auto const* version = reinterpret_cast<char const*>(glGetString( GL_VERSION ));
+	mDriverHash = fnv1a_( mDriverHash, renderer ? renderer : "" );
+	mDriverHash = fnv1a_( mDriverHash, version ? version : "" );
+
+	mEnabled = true;
+}
+
+bool ProgramBinaryCache::enabled() const noexcept
+{
+	return mEnabled;
+}
+
+std::uint64_t ProgramBinaryCache::key( std::vector<std::pair<GLenum,std::string>> const& aSources ) const noexcept
+{
+	std::uint64_t hash = mDriverHash;
+	for( auto const& source : aSources )
+	{
+		auto const type = std::uint32_t(source.first);
+		auto const length = std::uint64_t(source.second.size());
+		hash = fnv1a_( hash, &type, sizeof(type) );
+		hash = fnv1a_( hash, &length, sizeof(length) );
+		hash = fnv1a_( hash, source.second.data(), source.second.size() );
+	}
+	return hash;
+}
+
+bool ProgramBinaryCache::load( std::uint64_t aKey, GLenum& aFormat, std::vector<unsigned char>& aBinary ) const
+{
+	if( !mEnabled )
+		return false;
+
+	std::FILE* fin = std::fopen( path_( aKey ).c_str(), "rb" );
+	if( !fin )
+		return false;
+
+	FileHeader_ header;
+	bool ok = 1 == std::fread( &header, sizeof(header), 1, fin )
+		&& 0 == std::memcmp( header.magic, kMagic_, sizeof(kMagic_) )
+		&& aKey == header.key
+		&& header.length > 0;
+
+	if( ok )
+	{
+		aBinary.resize( std::size_t(header.length) );
+		ok = aBinary.size() == std::fread( aBinary.data(), 1, aBinary.size(), fin );
+		aFormat = GLenum(header.format);
+	}
+
+	std::fclose( fin );
+	return ok;
+}
+
+void ProgramBinaryCache::store( std::uint64_t aKey, GLuint aProgram )
+{
+	if( !mEnabled )
+		return;
+
+	GLint length = 0;
+	glGetProgramiv( aProgram, GL_PROGRAM_BINARY_LENGTH, &length );
+	if( length <= 0 )
+		return;
+
+	std::vector<unsigned char> binary( static_cast<std::size_t>(length) );
+	GLenum format = 0;
+	GLsizei written = 0;
+	glGetProgramBinary( aProgram, length, &written, &format, binary.data() );
+	if( written <= 0 )
+		return;
+
+	FileHeader_ header;
+	std::memcpy( header.magic, kMagic_, sizeof(kMagic_) );
+	header.format = std::uint32_t(format);
+	header.key = aKey;
+	header.length = std::uint64_t(written);
+
+	auto const path = path_( aKey );
+	std::FILE* fout = std::fopen( path.c_str(), "wb" );
+	if( !fout )
+	{
+		std::fprintf( stderr, "Note: unable to write shader cache entry '%s'\n", path.c_str() );
+		return;
+	}
+
+	bool const ok = 1 == std::fwrite( &header, sizeof(header), 1, fout )
+		&& std::size_t(written) == std::fwrite( binary.data(), 1, std::size_t(written), fout );
+	std::fclose( fout );
+
+	// don't leave a truncated entry behind
+	if( !ok )
+	{
+		std::fprintf( stderr, "Note: unable to write shader cache entry '%s'\n", path.c_str() );
+		std::remove( path.c_str() );
+	}
+}
+
+void ProgramBinaryCache::remove( std::uint64_t aKey )
+{
+	std::remove( path_( aKey ).c_str() );
+}
+
+void ProgramBinaryCache::count_hit() noexcept
+{
+	++mStats.hits;
+}
+void ProgramBinaryCache::count_miss() noexcept
+{
+	++mStats.misses;
+}
+void ProgramBinaryCache::count_rejected() noexcept
+{
+	++mStats.rejected;
+}
+
+ProgramBinaryCache::Stats const& ProgramBinaryCache::stats() const noexcept
+{
+	return mStats;
+}
+
+std::string ProgramBinaryCache::path_( std::uint64_t aKey ) const
+{
+	char name[32];
+	std::snprintf( name, sizeof(name), "%016" PRIx64 ".bin", aKey );
+	return mDirectory + "/" + name;
+}
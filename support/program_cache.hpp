@@ -0,0 +1,76 @@
+#ifndef PROGRAM_CACHE_HPP_87335830_0BBF_46BB_ACC6_36275C1366C6
+#define PROGRAM_CACHE_HPP_87335830_0BBF_46BB_ACC6_36275C1366C6
+
+#include <glad.h>
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include <cstddef>
+#include <cstdint>
+
+/* ProgramBinaryCache: on-disk cache of linked shader program binaries
+ *
+ * Used by ShaderProgram (see program.hpp) to skip compiling and linking when
+ * a program was built before. Each binary is stored in its own file in the
+ * cache directory, named after a 64-bit key. The key is a hash of the shader
+ * sources and the GL_RENDERER/GL_VERSION strings, so that changed shaders
+ * and driver updates simply miss the cache.
+ *
+ * Drivers may still reject a binary (glProgramBinary() fails to link); in
+ * that case, ShaderProgram compiles from source and replaces the entry.
+ *
+ * The cache disables itself if the driver supports no binary formats. It
+ * must be created after the GL context.
+ */
+class ProgramBinaryCache final
+{
+	public:
+		struct Stats
+		{
+			std::size_t hits;     // programs loaded from a binary
+			std::size_t misses;   // programs compiled from source
+			std::size_t rejected; // binaries found, but rejected by the driver
+		};
+
+	public:
+		explicit ProgramBinaryCache( std::string aDirectory );
+
+		ProgramBinaryCache( ProgramBinaryCache const& ) = delete;
+		ProgramBinaryCache& operator= (ProgramBinaryCache const&) = delete;
+
+	public:
+		bool enabled() const noexcept;
+
+		// Key for a program built from the given (shader type, source text)
+		// pairs, combined with the current GL_RENDERER and GL_VERSION.
+		std::uint64_t key( std::vector<std::pair<GLenum,std::string>> const& aSources ) const noexcept;
+
+		// Returns false if there is no (readable) entry for aKey.
+		bool load( std::uint64_t aKey, GLenum& aFormat, std::vector<unsigned char>& aBinary ) const;
+
+		// Write the binary of the linked program aProgram. Failures are
+		// reported, but not fatal: the program was built successfully.
+		void store( std::uint64_t aKey, GLuint aProgram );
+
+		void remove( std::uint64_t aKey );
+
+		// Bookkeeping, called by ShaderProgram
+		void count_hit() noexcept;
+		void count_miss() noexcept;
+		void count_rejected() noexcept;
+
+		Stats const& stats() const noexcept;
+
+	private:
+		std::string path_( std::uint64_t aKey ) const;
+
+		std::string mDirectory;
+		std::uint64_t mDriverHash;
+		bool mEnabled;
+
+		Stats mStats;
+};
+
+#endif // PROGRAM_CACHE_HPP_87335830_0BBF_46BB_ACC6_36275C1366C6
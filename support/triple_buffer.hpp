@@ -0,0 +1,69 @@
+#ifndef TRIPLE_BUFFER_HPP_79586752_794C_49F7_AB0F_88ECB3626C3E
+#define TRIPLE_BUFFER_HPP_79586752_794C_49F7_AB0F_88ECB3626C3E
+
+#include <atomic>
+
+/* TripleBuffer: lock-free hand-over of the latest value between two threads
+ *
+ * One thread writes, one thread reads; neither ever waits for the other. The
+ * writer fills back() and publish()es it. The reader calls update() to pick
+ * up the most recently published value, which is then available as front()
+ * until the next update(). A value that was published but never picked up is
+ * overwritten by the next publish(), i.e. a slow reader skips values, and a
+ * fast reader keeps seeing the same one.
+ *
+ * The three slots are swapped by index, the values are never copied. Slots
+ * are reused, so e.g. a std::vector in tType keeps its capacity and stops
+ * allocating once it has seen its largest size. back() holds whatever was in
+ * the slot before; the writer has to overwrite all of it.
+ */
+template< typename tType >
+class TripleBuffer final
+{
+	public:
+		TripleBuffer() = default;
+
+		TripleBuffer( TripleBuffer const& ) = delete;
+		TripleBuffer& operator= (TripleBuffer const&) = delete;
+
+	public: // writer
+		tType& back() noexcept
+		{
+			return mSlots[mBack];
+		}
+
+		void publish() noexcept
+		{
+			// release: the contents of the slot are visible to the reader
+			// that acquires it
+			mBack = mMiddle.exchange( mBack | kFresh_, std::memory_order_acq_rel ) & kIndexMask_;
+		}
+
+	public: // reader
+		// Returns true if a new value was picked up
+		bool update() noexcept
+		{
+			if( !(mMiddle.load( std::memory_order_relaxed ) & kFresh_) )
+				return false;
+
+			mFront = mMiddle.exchange( mFront, std::memory_order_acq_rel ) & kIndexMask_;
+			return true;
+		}
+
+		tType const& front() const noexcept
+		{
+			return mSlots[mFront];
+		}
+
+	private:
+		static constexpr unsigned kIndexMask_ = 0x3;
+		static constexpr unsigned kFresh_ = 0x4; // set in mMiddle by publish(), cleared by update()
+
+		tType mSlots[3];
+
+		unsigned mBack = 0;                  // writer only
+		std::atomic<unsigned> mMiddle{ 1 };  // shared
+		unsigned mFront = 2;                 // reader only
+};
+
+#endif // TRIPLE_BUFFER_HPP_79586752_794C_49F7_AB0F_88ECB3626C3E
@@ -0,0 +1,230 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <vector>
+
+#include <cstddef>
+
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/vec4.hpp"
+#include "../vmlib/mat44.hpp"
+#include "../vmlib/quat.hpp"
+#include "../vmlib/transform.hpp"
+
+/* Micro-benchmarks for vmlib
+ *
+ * Build and run in release mode; debug timings say little. For numbers that
+ * can be compared between runs (e.g. before and after a change to the layout
+ * of Mat44f), write them with the XML reporter:
+ *
+ *   vmlib-bench -r xml::out=bench.xml
+ *
+ * Each <BenchmarkResults> element then holds the mean and standard deviation
+ * (in nanoseconds) of one benchmark.
+ *
+ * main() comes from Catch2 (x-catch2).
+ */
+
+namespace
+{
+	constexpr std::size_t kBatchSize_ = 4096;
+
+	// Deterministic, non-trivial inputs (so that nothing folds away and
+	// runs are comparable)
+	Mat44f make_model_( float aT )
+	{
+		return make_translation( { aT, 2.f*aT, -3.f } )
+			* make_rotation_y( 0.3f + aT )
+			* make_rotation_x( 0.7f - aT )
+			* make_scaling( 1.5f, 0.5f, 2.f );
+	}
+
+	std::vector<Vec4f> make_points_( std::size_t aCount )
+	{
+		std::vector<Vec4f> points( aCount );
+		for( std::size_t i = 0; i < aCount; ++i )
+		{
+			float const f = float(i);
+			points[i] = Vec4f{ 0.25f*f, 1.f - 0.5f*f, 3.f + 0.125f*f, 1.f };
+		}
+		return points;
+	}
+
+	std::vector<Vec3f> make_vectors_( std::size_t aCount )
+	{
+		std::vector<Vec3f> vectors( aCount );
+		for( std::size_t i = 0; i < aCount; ++i )
+		{
+			float const f = float(i);
+			vectors[i] = Vec3f{ 1.f + 0.5f*f, 2.f - 0.25f*f, 0.75f*f - 3.f };
+		}
+		return vectors;
+	}
+}
+
+TEST_CASE( "Mat44f", "[mat44][benchmark]" )
+{
+	Mat44f const a = make_model_( 0.1f );
+	Mat44f const b = make_model_( 0.2f );
+	Vec4f const p{ 1.f, 2.f, 3.f, 1.f };
+
+	BENCHMARK( "multiply" )
+	{
+		return a * b;
+	};
+
+	BENCHMARK( "invert" )
+	{
+		return invert( a );
+	};
+
+	BENCHMARK( "transpose" )
+	{
+		return transpose( a );
+	};
+
+	BENCHMARK( "multiply Vec4f" )
+	{
+		return a * p;
+	};
+
+	BENCHMARK( "perspective projection" )
+	{
+		return make_perspective_projection( 1.0471976f, 1280.f/720.f, 0.1f, 100.f );
+	};
+
+	BENCHMARK( "model-view-projection" )
+	{
+		Mat44f const proj = make_perspective_projection( 1.0471976f, 1280.f/720.f, 0.1f, 100.f );
+		return proj * b * a;
+	};
+}
+
+TEST_CASE( "Affine inverse", "[mat44][benchmark]" )
+{
+	Mat44f const rigid = make_translation( { 1.f, 2.f, -3.f } ) * make_rotation_y( 0.3f );
+	Mat44f const orthogonal = make_model_( 0.1f );
+
+	BENCHMARK( "invert rigid, general" )
+	{
+		return invert( rigid );
+	};
+	BENCHMARK( "invert rigid, invert_affine" )
+	{
+		return invert_affine( rigid );
+	};
+	BENCHMARK( "invert rigid, known class" )
+	{
+		return invert_affine( rigid, TransformClass::rigid );
+	};
+
+	BENCHMARK( "normal matrix, transpose(invert())" )
+	{
+		return transpose( invert( orthogonal ) );
+	};
+	BENCHMARK( "normal matrix, normal_matrix()" )
+	{
+		return normal_matrix( orthogonal );
+	};
+	BENCHMARK( "normal matrix, known class" )
+	{
+		return normal_matrix( orthogonal, TransformClass::orthogonal );
+	};
+}
+
+TEST_CASE( "Batch transforms", "[mat44][benchmark]" )
+{
+	Mat44f const model = make_model_( 0.1f );
+	std::vector<Vec4f> const points = make_points_( kBatchSize_ );
+	std::vector<Vec4f> out( kBatchSize_ );
+
+	BENCHMARK( "transform 4096 points" )
+	{
+		for( std::size_t i = 0; i < kBatchSize_; ++i )
+			out[i] = model * points[i];
+		return out.back();
+	};
+
+	std::vector<Mat44f> models( kBatchSize_ );
+	for( std::size_t i = 0; i < kBatchSize_; ++i )
+		models[i] = make_model_( 0.001f * float(i) );
+
+	Mat44f const viewProj = make_perspective_projection( 1.0471976f, 1280.f/720.f, 0.1f, 100.f )
+		* make_translation( { 0.f, -2.f, -10.f } );
+	std::vector<Mat44f> mvps( kBatchSize_ );
+
+	BENCHMARK( "concatenate 4096 matrices" )
+	{
+		for( std::size_t i = 0; i < kBatchSize_; ++i )
+			mvps[i] = viewProj * models[i];
+		return mvps.back();
+	};
+}
+
+TEST_CASE( "Vec3f", "[vec3][benchmark]" )
+{
+	std::vector<Vec3f> const vectors = make_vectors_( kBatchSize_ );
+	std::vector<Vec3f> out( kBatchSize_ );
+
+	BENCHMARK( "normalize 4096 vectors" )
+	{
+		for( std::size_t i = 0; i < kBatchSize_; ++i )
+			out[i] = normalize( vectors[i] );
+		return out.back();
+	};
+
+	BENCHMARK( "cross 4096 vectors" )
+	{
+		for( std::size_t i = 0; i+1 < kBatchSize_; ++i )
+			out[i] = cross( vectors[i], vectors[i+1] );
+		return out.front();
+	};
+}
+
+TEST_CASE( "Transform", "[transform][benchmark]" )
+{
+	Transform const a{ normalize( make_quat_rotation( normalize( Vec3f{ 1.f, 2.f, 3.f } ), 0.7f ) ), { 1.f, 2.f, -3.f }, 1.5f };
+	Transform const b{ make_quat_rotation_z( 0.3f ), { -4.f, 0.5f, 2.f }, 0.5f };
+
+	BENCHMARK( "compose" )
+	{
+		return a * b;
+	};
+
+	BENCHMARK( "invert" )
+	{
+		return invert( a );
+	};
+
+	BENCHMARK( "to Mat44f" )
+	{
+		return to_mat44( a );
+	};
+
+	BENCHMARK( "slerp" )
+	{
+		return slerp( a.rotation, b.rotation, 0.25f );
+	};
+}
+
+TEST_CASE( "Fused multiply-add", "[vec3][benchmark]" )
+{
+	std::vector<Vec3f> const vectors = make_vectors_( kBatchSize_ );
+	std::vector<Vec3f> out( kBatchSize_ );
+
+	// the same scalar in both, e.g. a velocity scale times the time step
+	float const s = 0.5f * 0.016f;
+
+	BENCHMARK( "4096 x operator +=(*)" )
+	{
+		for( std::size_t i = 0; i < kBatchSize_; ++i )
+			out[i] += vectors[i] * s;
+		return out.back();
+	};
+
+	BENCHMARK( "4096 x fma()" )
+	{
+		for( std::size_t i = 0; i < kBatchSize_; ++i )
+			out[i] = fma( vectors[i], s, out[i] );
+		return out.back();
+	};
+}
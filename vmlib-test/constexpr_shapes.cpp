@@ -0,0 +1,57 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "../main/shapes.hpp"
+#include "../main/primitives.hpp"
+
+
+static constexpr float kEps_ = 1e-6f;
+
+using namespace Catch::Matchers;
+
+// The primitives are generated by the compiler
+static_assert(kCubePrimitive.positions[0].x == -0.5f && kCubePrimitive.positions[0].z == 0.5f, "cube is compile-time data");
+static_assert(kPyramidPrimitive.positions[2].y == 1.f, "pyramid is compile-time data");
+static_assert(kCylinderPrimitive<3>.positions[0].y == 1.f, "cylinder is compile-time data");
+
+template <std::size_t tCount>
+void require_same(Primitive<tCount> const& prim, SimpleMeshData const& mesh) {
+    REQUIRE(mesh.positions.size() == tCount);
+    REQUIRE(mesh.normals.size() == tCount);
+
+    for (std::size_t i = 0; i < tCount; ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            REQUIRE_THAT(prim.positions[i][j], WithinAbs(mesh.positions[i][j], kEps_));
+            REQUIRE_THAT(prim.normals[i][j], WithinAbs(mesh.normals[i][j], kEps_));
+        }
+    }
+}
+
+TEST_CASE("Compile-time primitives", "[primitives]") {
+
+    SECTION("Cube and pyramid") {
+        require_same(kCubePrimitive, make_cube());
+        require_same(kPyramidPrimitive, make_pyramid());
+    }
+
+    SECTION("Cylinders") {
+        require_same(kCylinderPrimitive<3>, make_cylinder(3));
+        require_same(kCylinderPrimitive<6>, make_cylinder(6));
+        require_same(kCylinderPrimitive<12>, make_cylinder(12));
+        require_same(kCylinderPrimitive<32>, make_cylinder(32));
+        require_same(kCylinderPrimitive<128>, make_cylinder(128));
+    }
+
+    SECTION("Colors and fallback") {
+        Vec3f color{ 0.25f, 0.5f, 0.75f };
+        auto precompiled = make_primitive_cylinder(12, color);
+        auto generated = make_primitive_cylinder(7, color);
+
+        REQUIRE(precompiled.colors.size() == precompiled.positions.size());
+        REQUIRE(generated.positions.size() == make_cylinder(7).positions.size());
+        for (auto const& c : precompiled.colors) {
+            REQUIRE(c.x == color.x);
+            REQUIRE(c.y == color.y);
+            REQUIRE(c.z == color.z);
+        }
+    }
+}
@@ -1,6 +1,11 @@
 #include <catch2/catch_amalgamated.hpp>
 
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/vec4.hpp"
+#include "../vmlib/vec3d.hpp"
 #include "../vmlib/mat44.hpp"
+#include "../vmlib/quat.hpp"
+#include "../vmlib/transform.hpp"
 
 
 static constexpr float kEps_ = 1e-6f;
@@ -280,6 +285,147 @@ TEST_CASE("Perspective Projection", "[mat44]") {
     }
 }
 
+TEST_CASE("Quaternion rotation", "[quat]") {
+
+    SECTION("Same as the matrix rotations") {
+        float angle = 35.f * 3.1415926f / 180.f;
+        auto x = make_rotation(make_quat_rotation_x(angle));
+        auto y = make_rotation(make_quat_rotation_y(angle));
+        auto z = make_rotation(make_quat_rotation_z(angle));
+        auto ex = make_rotation_x(angle);
+        auto ey = make_rotation_y(angle);
+        auto ez = make_rotation_z(angle);
+
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                REQUIRE_THAT(x(i, j), WithinAbs(ex(i, j), kEps_));
+                REQUIRE_THAT(y(i, j), WithinAbs(ey(i, j), kEps_));
+                REQUIRE_THAT(z(i, j), WithinAbs(ez(i, j), kEps_));
+            }
+        }
+    }
+
+    SECTION("Composition and slerp") {
+        auto a = make_quat_rotation_z(0.5f);
+        auto b = make_quat_rotation_z(1.5f);
+        auto product = make_rotation(a * b);
+        auto expected = make_rotation_z(2.f);
+        auto half = make_rotation(slerp(a, b, 0.5f));
+        auto expectedHalf = make_rotation_z(1.f);
+
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                REQUIRE_THAT(product(i, j), WithinAbs(expected(i, j), kEps_));
+                REQUIRE_THAT(half(i, j), WithinAbs(expectedHalf(i, j), kEps_));
+            }
+        }
+    }
+}
+
+TEST_CASE("Transform", "[transform]") {
+
+    Transform t{ make_quat_rotation_y(0.8f), { 1.f, -2.f, 3.f }, 2.f };
+    Transform u{ make_quat_rotation_x(-0.3f), { 0.5f, 0.f, -1.f }, 0.5f };
+
+    SECTION("Composition matches the matrices") {
+        auto result = to_mat44(t * u);
+        auto expected = to_mat44(t) * to_mat44(u);
+
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                REQUIRE_THAT(result(i, j), WithinAbs(expected(i, j), 1e-5f));
+            }
+        }
+    }
+
+    SECTION("Inverse matches the general inverse") {
+        auto result = to_mat44(invert(t));
+        auto expected = invert(to_mat44(t));
+
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                REQUIRE_THAT(result(i, j), WithinAbs(expected(i, j), 1e-5f));
+            }
+        }
+    }
+}
+
+TEST_CASE("Affine inverse and normal matrix", "[mat44]") {
+
+    Mat44f translation = make_translation({ 1.f, -2.f, 3.f });
+    Mat44f rigid = translation * make_rotation_y(0.8f) * make_rotation_x(-0.3f);
+    Mat44f orthogonal = rigid * make_scaling(0.5f, 1.f, 2.f);
+    Mat44f shear = kIdentity44f;
+    shear(0, 1) = 0.5f;
+    Mat44f affine = orthogonal * shear;
+
+    SECTION("Classification") {
+        REQUIRE(classify(kIdentity44f) == TransformClass::identity);
+        REQUIRE(classify(translation) == TransformClass::translation);
+        REQUIRE(classify(rigid) == TransformClass::rigid);
+        REQUIRE(classify(orthogonal) == TransformClass::orthogonal);
+        REQUIRE(classify(affine) == TransformClass::affine);
+        REQUIRE(classify(make_perspective_projection(1.f, 1.f, 0.1f, 100.f)) == TransformClass::projective);
+    }
+
+    SECTION("Same as the general inverse") {
+        for (Mat44f const& m : { kIdentity44f, translation, rigid, orthogonal, affine }) {
+            auto result = invert_affine(m);
+            auto expected = invert(m);
+            auto normals = normal_matrix(m);
+            auto expectedNormals = transpose(invert(m));
+
+            for (int i = 0; i < 4; ++i) {
+                for (int j = 0; j < 4; ++j) {
+                    REQUIRE_THAT(result(i, j), WithinAbs(expected(i, j), 1e-5f));
+                }
+            }
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    REQUIRE_THAT(normals(i, j), WithinAbs(expectedNormals(i, j), 1e-5f));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Fused multiply-add", "[vec3][vec4]") {
+
+    SECTION("Same as the operators") {
+        Vec3f a{ 1.5f, -2.f, 0.25f };
+        Vec3f b{ -3.f, 4.f, 8.f };
+        Vec3f result = fma(a, 0.5f, b);
+        Vec3f expected = a * 0.5f + b;
+
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE_THAT(result[i], WithinAbs(expected[i], kEps_));
+        }
+
+        Vec4f c{ 1.f, 2.f, 3.f, 4.f };
+        Vec4f d{ -1.f, 0.5f, 0.f, 2.f };
+        Vec4f result4 = fma(c, -2.f, d);
+        Vec4f expected4 = c * -2.f + d;
+
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE_THAT(result4[i], WithinAbs(expected4[i], kEps_));
+        }
+    }
+}
+
+TEST_CASE("Double precision", "[vec3d]") {
+
+    SECTION("Small differences of large positions") {
+        // 1e5 + 0.001 is not representable as a float, its difference to
+        // 1e5 in double is
+        Vec3d a{ 100000.001, -250000.5, 3.0 };
+        Vec3d b{ 100000.0, -250000.0, 0.0 };
+        Vec3f result = to_vec3f(a - b);
+
+        REQUIRE_THAT(result.x, WithinAbs(0.001f, 1e-7f));
+        REQUIRE_THAT(result.y, WithinAbs(-0.5f, kEps_));
+        REQUIRE_THAT(result.z, WithinAbs(3.f, kEps_));
+    }
+}
 
 
 int main(int argc, char* argv[])
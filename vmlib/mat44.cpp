@@ -67,3 +67,162 @@ Mat44f invert( Mat44f const& aM ) noexcept
 	return ret;
 }
 
+
+namespace
+{
+	constexpr float kOrthoEps_ = 1e-5f;
+
+	float column_length2_( Mat44f const& aM, std::size_t aJ ) noexcept
+	{
+		return aM(0,aJ)*aM(0,aJ) + aM(1,aJ)*aM(1,aJ) + aM(2,aJ)*aM(2,aJ);
+	}
+
+	// [ A t ]^-1 = [ A^-1  -A^-1 t ]
+	// [ 0 1 ]      [ 0      1      ]
+	//
+	// For the orthogonal classes, row i of A^-1 is column i of A divided by
+	// its squared length (which is one for rotations). aS0..2 are the
+	// reciprocals of the squared lengths.
+	Mat44f invert_orthogonal_( Mat44f const& aM, float aS0, float aS1, float aS2 ) noexcept
+	{
+		float const t0 = aM(0,3), t1 = aM(1,3), t2 = aM(2,3);
+		return { {
+			aS0*aM(0,0), aS0*aM(1,0), aS0*aM(2,0), -aS0*(aM(0,0)*t0 + aM(1,0)*t1 + aM(2,0)*t2),
+			aS1*aM(0,1), aS1*aM(1,1), aS1*aM(2,1), -aS1*(aM(0,1)*t0 + aM(1,1)*t1 + aM(2,1)*t2),
+			aS2*aM(0,2), aS2*aM(1,2), aS2*aM(2,2), -aS2*(aM(0,2)*t0 + aM(1,2)*t1 + aM(2,2)*t2),
+			0.f, 0.f, 0.f, 1.f
+		} };
+	}
+
+	// Inverse transpose of the 3x3 part for the orthogonal classes: column j
+	// of A divided by its squared length
+	Mat44f normals_orthogonal_( Mat44f const& aM, float aS0, float aS1, float aS2 ) noexcept
+	{
+		return { {
+			aS0*aM(0,0), aS1*aM(0,1), aS2*aM(0,2), 0.f,
+			aS0*aM(1,0), aS1*aM(1,1), aS2*aM(1,2), 0.f,
+			aS0*aM(2,0), aS1*aM(2,1), aS2*aM(2,2), 0.f,
+			0.f, 0.f, 0.f, 1.f
+		} };
+	}
+
+	// Cofactors of the 3x3 part over its determinant, i.e. its inverse
+	// transpose, with the rest of the identity
+	Mat44f normals_affine_( Mat44f const& aM ) noexcept
+	{
+		float const c00 = aM(1,1)*aM(2,2) - aM(1,2)*aM(2,1);
+		float const c01 = aM(1,2)*aM(2,0) - aM(1,0)*aM(2,2);
+		float const c02 = aM(1,0)*aM(2,1) - aM(1,1)*aM(2,0);
+		float const d = 1.f / (aM(0,0)*c00 + aM(0,1)*c01 + aM(0,2)*c02);
+
+		return { {
+			d*c00, d*c01, d*c02, 0.f,
+			d*(aM(0,2)*aM(2,1) - aM(0,1)*aM(2,2)), d*(aM(0,0)*aM(2,2) - aM(0,2)*aM(2,0)), d*(aM(0,1)*aM(2,0) - aM(0,0)*aM(2,1)), 0.f,
+			d*(aM(0,1)*aM(1,2) - aM(0,2)*aM(1,1)), d*(aM(0,2)*aM(1,0) - aM(0,0)*aM(1,2)), d*(aM(0,0)*aM(1,1) - aM(0,1)*aM(1,0)), 0.f,
+			0.f, 0.f, 0.f, 1.f
+		} };
+	}
+}
+
+TransformClass classify( Mat44f const& aM ) noexcept
+{
+	if( 0.f != aM(3,0) || 0.f != aM(3,1) || 0.f != aM(3,2) || 1.f != aM(3,3) )
+		return TransformClass::projective;
+
+	// Exact checks first; translations are built without any rounding
+	if( 1.f == aM(0,0) && 0.f == aM(0,1) && 0.f == aM(0,2)
+	 && 0.f == aM(1,0) && 1.f == aM(1,1) && 0.f == aM(1,2)
+	 && 0.f == aM(2,0) && 0.f == aM(2,1) && 1.f == aM(2,2) )
+	{
+		if( 0.f == aM(0,3) && 0.f == aM(1,3) && 0.f == aM(2,3) )
+			return TransformClass::identity;
+
+		return TransformClass::translation;
+	}
+
+	// Orthogonal columns; compares squares to avoid the square roots
+	float const l0 = column_length2_( aM, 0 ), l1 = column_length2_( aM, 1 ), l2 = column_length2_( aM, 2 );
+	float const d01 = aM(0,0)*aM(0,1) + aM(1,0)*aM(1,1) + aM(2,0)*aM(2,1);
+	float const d02 = aM(0,0)*aM(0,2) + aM(1,0)*aM(1,2) + aM(2,0)*aM(2,2);
+	float const d12 = aM(0,1)*aM(0,2) + aM(1,1)*aM(1,2) + aM(2,1)*aM(2,2);
+
+	float const eps2 = kOrthoEps_ * kOrthoEps_;
+	if( d01*d01 > eps2 * l0*l1 || d02*d02 > eps2 * l0*l2 || d12*d12 > eps2 * l1*l2 )
+		return TransformClass::affine;
+
+	if( std::abs( l0 - 1.f ) > kOrthoEps_ || std::abs( l1 - 1.f ) > kOrthoEps_ || std::abs( l2 - 1.f ) > kOrthoEps_ )
+		return TransformClass::orthogonal;
+
+	return TransformClass::rigid;
+}
+
+Mat44f invert_affine( Mat44f const& aM ) noexcept
+{
+	return invert_affine( aM, classify( aM ) );
+}
+Mat44f invert_affine( Mat44f const& aM, TransformClass aClass ) noexcept
+{
+	switch( aClass )
+	{
+		case TransformClass::identity:
+			return kIdentity44f;
+
+		case TransformClass::translation:
+			return make_translation( { -aM(0,3), -aM(1,3), -aM(2,3) } );
+
+		case TransformClass::rigid:
+			return invert_orthogonal_( aM, 1.f, 1.f, 1.f );
+
+		case TransformClass::orthogonal:
+			return invert_orthogonal_( aM, 1.f / column_length2_( aM, 0 ), 1.f / column_length2_( aM, 1 ), 1.f / column_length2_( aM, 2 ) );
+
+		case TransformClass::affine:
+		{
+			// A^-1 is the transpose of its inverse transpose
+			Mat44f ret = transpose( normals_affine_( aM ) );
+			float const t0 = aM(0,3), t1 = aM(1,3), t2 = aM(2,3);
+			for( std::size_t i = 0; i < 3; ++i )
+				ret(i,3) = -(ret(i,0)*t0 + ret(i,1)*t1 + ret(i,2)*t2);
+			return ret;
+		}
+
+		case TransformClass::projective:
+			break;
+	}
+
+	return invert( aM );
+}
+
+Mat44f normal_matrix( Mat44f const& aM ) noexcept
+{
+	return normal_matrix( aM, classify( aM ) );
+}
+Mat44f normal_matrix( Mat44f const& aM, TransformClass aClass ) noexcept
+{
+	switch( aClass )
+	{
+		case TransformClass::identity:
+		case TransformClass::translation:
+			return kIdentity44f;
+
+		case TransformClass::rigid:
+			return normals_orthogonal_( aM, 1.f, 1.f, 1.f );
+
+		case TransformClass::orthogonal:
+			return normals_orthogonal_( aM, 1.f / column_length2_( aM, 0 ), 1.f / column_length2_( aM, 1 ), 1.f / column_length2_( aM, 2 ) );
+
+		case TransformClass::affine:
+			return normals_affine_( aM );
+
+		case TransformClass::projective:
+			break;
+	}
+
+	// The upper 3x3 part of transpose( invert( aM ) ) is not the inverse
+	// transpose of aM's 3x3 part for projective matrices; keep the former.
+	Mat44f ret = transpose( invert( aM ) );
+	for( std::size_t i = 0; i < 3; ++i )
+		ret(i,3) = ret(3,i) = 0.f;
+	ret(3,3) = 1.f;
+	return ret;
+}
@@ -101,6 +101,35 @@ Mat44f operator*( Mat44f const& aLeft, float aRight) noexcept
 
 Mat44f invert( Mat44f const& aM ) noexcept;
 
+// Kinds of transforms, from the most to the least specific. Everything built
+// from make_translation(), make_rotation_*() and make_scaling() is at most
+// orthogonal, i.e. translation times rotation times an axis-aligned scale.
+enum class TransformClass
+{
+	identity,
+	translation, // translation only
+	rigid,       // translation times rotation
+	orthogonal,  // translation times rotation times axis-aligned scale
+	affine,      // any other matrix with a last row of (0,0,0,1)
+	projective   // anything else
+};
+
+// Find the most specific class of aM. Rotations are recognized up to a small
+// tolerance (relative 1e-5), since their sines and cosines are rounded.
+TransformClass classify( Mat44f const& aM ) noexcept;
+
+// Inverse of an affine transform, using a closed form for its class instead
+// of the general invert(). Projective matrices fall back to invert(). Pass the
+// class if it is already known, to skip classify().
+Mat44f invert_affine( Mat44f const& aM ) noexcept;
+Mat44f invert_affine( Mat44f const& aM, TransformClass ) noexcept;
+
+// Matrix for transforming normals by aM: the inverse transpose of its upper
+// 3x3 part. The rest of the result is that of the identity. Same as the
+// upper 3x3 part of transpose( invert( aM ) ), again with closed forms.
+Mat44f normal_matrix( Mat44f const& aM ) noexcept;
+Mat44f normal_matrix( Mat44f const& aM, TransformClass ) noexcept;
+
 inline
 Mat44f transpose( Mat44f const& aM ) noexcept
 {
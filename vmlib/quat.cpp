@@ -0,0 +1,99 @@
+#include "quat.hpp"
+
+#if defined(__SSE__) || defined(_M_X64)
+#	include <xmmintrin.h>
+#	define QUAT_SSE_ 1
+#endif
+
+static_assert( sizeof(Quatf) == 4*sizeof(float), "Quatf is four packed floats" );
+
+namespace
+{
+#	if defined(QUAT_SSE_)
+	__m128 load_( Quatf const& aQ ) noexcept
+	{
+		return _mm_loadu_ps( &aQ.x );
+	}
+	Quatf store_( __m128 aQ ) noexcept
+	{
+		Quatf ret;
+		_mm_storeu_ps( &ret.x, aQ );
+		return ret;
+	}
+#	endif // ~ QUAT_SSE_
+}
+
+Quatf operator*( Quatf const& aLeft, Quatf const& aRight ) noexcept
+{
+#	if defined(QUAT_SSE_)
+	// aLeft.w * aRight, plus each of aLeft's imaginary components times a
+	// permutation of aRight with the signs of the Hamilton product
+	__m128 const b = load_( aRight );
+
+	__m128 const bx = _mm_shuffle_ps( b, b, _MM_SHUFFLE(0,1,2,3) ); // w z y x
+	__m128 const by = _mm_shuffle_ps( b, b, _MM_SHUFFLE(1,0,3,2) ); // z w x y
+	__m128 const bz = _mm_shuffle_ps( b, b, _MM_SHUFFLE(2,3,0,1) ); // y x w z
+
+	__m128 const sx = _mm_setr_ps( 0.f, -0.f, 0.f, -0.f );
+	__m128 const sy = _mm_setr_ps( 0.f, 0.f, -0.f, -0.f );
+	__m128 const sz = _mm_setr_ps( -0.f, 0.f, 0.f, -0.f );
+
+	__m128 ret = _mm_mul_ps( _mm_set1_ps( aLeft.w ), b );
+	ret = _mm_add_ps( ret, _mm_mul_ps( _mm_set1_ps( aLeft.x ), _mm_xor_ps( bx, sx ) ) );
+	ret = _mm_add_ps( ret, _mm_mul_ps( _mm_set1_ps( aLeft.y ), _mm_xor_ps( by, sy ) ) );
+	ret = _mm_add_ps( ret, _mm_mul_ps( _mm_set1_ps( aLeft.z ), _mm_xor_ps( bz, sz ) ) );
+	return store_( ret );
+#	else // !QUAT_SSE_
+	return Quatf{
+		aLeft.w*aRight.x + aLeft.x*aRight.w + aLeft.y*aRight.z - aLeft.z*aRight.y,
+		aLeft.w*aRight.y - aLeft.x*aRight.z + aLeft.y*aRight.w + aLeft.z*aRight.x,
+		aLeft.w*aRight.z + aLeft.x*aRight.y - aLeft.y*aRight.x + aLeft.z*aRight.w,
+		aLeft.w*aRight.w - aLeft.x*aRight.x - aLeft.y*aRight.y - aLeft.z*aRight.z
+	};
+#	endif // ~ QUAT_SSE_
+}
+
+Quatf slerp( Quatf const& aFrom, Quatf const& aTo, float aT ) noexcept
+{
+	// q and -q are the same rotation; pick the one closer to aFrom
+	float cosTheta = dot( aFrom, aTo );
+	float const sign = cosTheta < 0.f ? -1.f : 1.f;
+	cosTheta *= sign;
+
+	float wFrom, wTo;
+	if( cosTheta > 0.9995f )
+	{
+		// sin(theta) is close to zero; blend linearly and renormalize below
+		wFrom = 1.f - aT;
+		wTo = aT;
+	}
+	else
+	{
+		float const theta = std::acos( cosTheta );
+		float const invSin = 1.f / std::sin( theta );
+		wFrom = std::sin( (1.f - aT) * theta ) * invSin;
+		wTo = std::sin( aT * theta ) * invSin;
+	}
+	wTo *= sign;
+
+#	if defined(QUAT_SSE_)
+	__m128 ret = _mm_add_ps(
+		_mm_mul_ps( _mm_set1_ps( wFrom ), load_( aFrom ) ),
+		_mm_mul_ps( _mm_set1_ps( wTo ), load_( aTo ) )
+	);
+
+	// Renormalize; this is a no-op up to rounding for the exact slerp
+	__m128 sq = _mm_mul_ps( ret, ret );
+	sq = _mm_add_ps( sq, _mm_shuffle_ps( sq, sq, _MM_SHUFFLE(2,3,0,1) ) );
+	sq = _mm_add_ps( sq, _mm_shuffle_ps( sq, sq, _MM_SHUFFLE(1,0,3,2) ) );
+	ret = _mm_div_ps( ret, _mm_sqrt_ps( sq ) );
+	return store_( ret );
+#	else // !QUAT_SSE_
+	return normalize( Quatf{
+		wFrom*aFrom.x + wTo*aTo.x,
+		wFrom*aFrom.y + wTo*aTo.y,
+		wFrom*aFrom.z + wTo*aTo.z,
+		wFrom*aFrom.w + wTo*aTo.w
+	} );
+#	endif // ~ QUAT_SSE_
+}
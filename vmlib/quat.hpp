@@ -0,0 +1,120 @@
+#ifndef QUAT_HPP_BF536619_3796_49D2_A683_7EA8CE19C2E7
+#define QUAT_HPP_BF536619_3796_49D2_A683_7EA8CE19C2E7
+
+#include <cmath>
+#include <cassert>
+#include <cstdlib>
+
+#include "vec3.hpp"
+#include "mat44.hpp"
+
+/** Quatf: quaternion with floats
+ *
+ * Used for rotations only, so the quaternions are expected to be of unit
+ * length. Functions that rely on this (conjugate() as inverse, rotate(),
+ * make_rotation()) do not normalize themselves; call normalize() after long
+ * chains of products.
+ *
+ * The imaginary part is (x,y,z), the real part w. Same layout as Vec4f.
+ */
+struct Quatf
+{
+	float x, y, z, w;
+};
+
+// Identity (no rotation)
+constexpr Quatf kIdentityQuatf = { 0.f, 0.f, 0.f, 1.f };
+
+// Composition: rotates by aRight first and then by aLeft (same order as with
+// Mat44f). Implemented with SSE where available, see quat.cpp.
+Quatf operator*( Quatf const& aLeft, Quatf const& aRight ) noexcept;
+
+constexpr
+Quatf operator-( Quatf aQ ) noexcept
+{
+	return { -aQ.x, -aQ.y, -aQ.z, -aQ.w };
+}
+
+
+// Functions:
+
+constexpr
+float dot( Quatf aLeft, Quatf aRight ) noexcept
+{
+	return aLeft.x * aRight.x
+		+ aLeft.y * aRight.y
+		+ aLeft.z * aRight.z
+		+ aLeft.w * aRight.w
+	;
+}
+
+// Inverse rotation (for unit quaternions)
+constexpr
+Quatf conjugate( Quatf aQ ) noexcept
+{
+	return { -aQ.x, -aQ.y, -aQ.z, aQ.w };
+}
+
+inline
+Quatf normalize( Quatf aQ ) noexcept
+{
+	float const l = std::sqrt( dot( aQ, aQ ) );
+	return { aQ.x / l, aQ.y / l, aQ.z / l, aQ.w / l };
+}
+
+// Rotate a vector. Cheaper than converting to a matrix for a few vectors.
+constexpr
+Vec3f rotate( Quatf aQ, Vec3f aVec ) noexcept
+{
+	Vec3f const u{ aQ.x, aQ.y, aQ.z };
+	Vec3f const t = 2.f * cross( u, aVec );
+	return aVec + aQ.w * t + cross( u, t );
+}
+
+// Spherical linear interpolation, taking the shorter way around. Falls back
+// to a normalized linear blend for nearly identical rotations. See quat.cpp.
+Quatf slerp( Quatf const& aFrom, Quatf const& aTo, float aT ) noexcept;
+
+
+// Rotations around an axis. aAxis must be of unit length.
+inline
+Quatf make_quat_rotation( Vec3f aAxis, float aAngle ) noexcept
+{
+	float const s = std::sin( 0.5f * aAngle );
+	return { s * aAxis.x, s * aAxis.y, s * aAxis.z, std::cos( 0.5f * aAngle ) };
+}
+
+inline
+Quatf make_quat_rotation_x( float aAngle ) noexcept
+{
+	return { std::sin( 0.5f * aAngle ), 0.f, 0.f, std::cos( 0.5f * aAngle ) };
+}
+inline
+Quatf make_quat_rotation_y( float aAngle ) noexcept
+{
+	return { 0.f, std::sin( 0.5f * aAngle ), 0.f, std::cos( 0.5f * aAngle ) };
+}
+inline
+Quatf make_quat_rotation_z( float aAngle ) noexcept
+{
+	return { 0.f, 0.f, std::sin( 0.5f * aAngle ), std::cos( 0.5f * aAngle ) };
+}
+
+// Rotation matrix. make_rotation( make_quat_rotation_z( a ) ) equals
+// make_rotation_z( a ), and similarly for x and y.
+constexpr
+Mat44f make_rotation( Quatf aQ ) noexcept
+{
+	float const xx = aQ.x * aQ.x, yy = aQ.y * aQ.y, zz = aQ.z * aQ.z;
+	float const xy = aQ.x * aQ.y, xz = aQ.x * aQ.z, yz = aQ.y * aQ.z;
+	float const wx = aQ.w * aQ.x, wy = aQ.w * aQ.y, wz = aQ.w * aQ.z;
+
+	return { {
+		1.f - 2.f*(yy + zz), 2.f*(xy - wz), 2.f*(xz + wy), 0.f,
+		2.f*(xy + wz), 1.f - 2.f*(xx + zz), 2.f*(yz - wx), 0.f,
+		2.f*(xz - wy), 2.f*(yz + wx), 1.f - 2.f*(xx + yy), 0.f,
+		0.f, 0.f, 0.f, 1.f
+	} };
+}
+
+#endif // QUAT_HPP_BF536619_3796_49D2_A683_7EA8CE19C2E7
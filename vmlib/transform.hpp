@@ -0,0 +1,107 @@
+#ifndef TRANSFORM_HPP_E91E5936_612C_49FD_A3A8_44B0665C7A48
+#define TRANSFORM_HPP_E91E5936_612C_49FD_A3A8_44B0665C7A48
+
+#include "vec3.hpp"
+#include "quat.hpp"
+#include "mat44.hpp"
+
+/** Transform: rotation, translation and uniform scale
+ *
+ * Compact alternative to a Mat44f for object hierarchies: 8 floats instead
+ * of 16, composition without a full 4x4 product, and an exact inverse without
+ * the general invert(). Applying it scales first, then rotates, and then
+ * translates, i.e. it corresponds to the matrix
+ *
+ *   make_translation( translation ) * make_rotation( rotation ) * make_scaling( scale, scale, scale )
+ *
+ * which is what to_mat44() returns. Non-uniform scales cannot be represented;
+ * keep those in a Mat44f at the leaves of the hierarchy.
+ */
+struct Transform
+{
+	Quatf rotation;
+	Vec3f translation;
+	float scale;
+};
+
+constexpr Transform kIdentityTransform = { kIdentityQuatf, { 0.f, 0.f, 0.f }, 1.f };
+
+// Composition: aRight is applied first (same order as with Mat44f)
+inline
+Transform operator*( Transform const& aLeft, Transform const& aRight ) noexcept
+{
+	return Transform{
+		aLeft.rotation * aRight.rotation,
+		aLeft.translation + aLeft.scale * rotate( aLeft.rotation, aRight.translation ),
+		aLeft.scale * aRight.scale
+	};
+}
+
+
+// Functions:
+
+constexpr
+Vec3f transform_point( Transform const& aT, Vec3f aPoint ) noexcept
+{
+	return aT.translation + aT.scale * rotate( aT.rotation, aPoint );
+}
+constexpr
+Vec3f transform_vector( Transform const& aT, Vec3f aVec ) noexcept
+{
+	return aT.scale * rotate( aT.rotation, aVec );
+}
+
+// Exact inverse (analytic; no general matrix inverse needed)
+constexpr
+Transform invert( Transform const& aT ) noexcept
+{
+	Quatf const rotation = conjugate( aT.rotation );
+	float const scale = 1.f / aT.scale;
+	return Transform{ rotation, -(scale * rotate( rotation, aT.translation )), scale };
+}
+
+// Blend between two transforms: slerp() of the rotations and linear blends
+// of translation and scale
+inline
+Transform interpolate( Transform const& aFrom, Transform const& aTo, float aT ) noexcept
+{
+	return Transform{
+		slerp( aFrom.rotation, aTo.rotation, aT ),
+		fma( aTo.translation - aFrom.translation, aT, aFrom.translation ),
+		aFrom.scale + aT * (aTo.scale - aFrom.scale)
+	};
+}
+
+constexpr
+Mat44f to_mat44( Transform const& aT ) noexcept
+{
+	Mat44f ret = make_rotation( aT.rotation );
+	for( std::size_t i = 0; i < 3; ++i )
+	{
+		for( std::size_t j = 0; j < 3; ++j )
+			ret(i,j) *= aT.scale;
+	}
+
+	ret(0,3) = aT.translation.x;
+	ret(1,3) = aT.translation.y;
+	ret(2,3) = aT.translation.z;
+	return ret;
+}
+
+// Matrix for normals, i.e. the inverse transpose of the upper 3x3 part of
+// to_mat44(). For a rotation and a uniform scale this is just the rotation
+// divided by the scale. The translation column is left at zero.
+constexpr
+Mat44f normal_matrix( Transform const& aT ) noexcept
+{
+	Mat44f ret = make_rotation( aT.rotation );
+	float const invScale = 1.f / aT.scale;
+	for( std::size_t i = 0; i < 3; ++i )
+	{
+		for( std::size_t j = 0; j < 3; ++j )
+			ret(i,j) *= invScale;
+	}
+	return ret;
+}
+
+#endif // TRANSFORM_HPP_E91E5936_612C_49FD_A3A8_44B0665C7A48
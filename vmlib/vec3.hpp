@@ -161,4 +161,29 @@ Vec3f reflect(Vec3f incident, Vec3f normal) noexcept
 {
 	return incident - 2.0f * dot(incident, normal) * normal;
 }
+
+
+// Fused multiply-add:
+
+// aA * aScalar + aB, without the temporary of the operator chain. With FMA
+// hardware enabled (e.g. -march=native), <cmath> defines FP_FAST_FMAF and
+// each component is a single fused instruction, rounded once. Otherwise this
+// is the plain product and sum.
+inline
+Vec3f fma( Vec3f aA, float aScalar, Vec3f aB ) noexcept
+{
+#	if defined(FP_FAST_FMAF)
+	return Vec3f{
+		std::fma( aA.x, aScalar, aB.x ),
+		std::fma( aA.y, aScalar, aB.y ),
+		std::fma( aA.z, aScalar, aB.z )
+	};
+#	else // !FP_FAST_FMAF
+	return Vec3f{
+		aA.x * aScalar + aB.x,
+		aA.y * aScalar + aB.y,
+		aA.z * aScalar + aB.z
+	};
+#	endif // ~ FP_FAST_FMAF
+}
 #endif // VEC3_HPP_5710DADF_17EF_453C_A9C8_4A73DC66B1CD
@@ -0,0 +1,129 @@
+#ifndef VEC3D_HPP_6F5D4E97_6383_436E_AE2A_4C43CD5CF228
+#define VEC3D_HPP_6F5D4E97_6383_436E_AE2A_4C43CD5CF228
+
+#include <cmath>
+#include <cassert>
+#include <cstdlib>
+
+#include "vec3.hpp"
+
+/** Vec3d: 3D vector with doubles
+ *
+ * For world space positions that can be far away from the origin (e.g., a
+ * rocket hundreds of kilometres along its flight). A float has 24 bits of
+ * mantissa, so at 100 km its resolution is already below a centimetre, and
+ * objects start to jitter. A double keeps sub-micrometre resolution at
+ * astronomical distances.
+ *
+ * Rendering stays in float: positions are made relative to a nearby origin
+ * first (see RenderOrigin in main/), and the small differences are converted
+ * with to_vec3f(). Only the operations needed for that are provided.
+ */
+struct Vec3d
+{
+	double x, y, z;
+
+	constexpr 
+	double& operator[] (std::size_t aI) noexcept
+	{
+		assert( aI < 3 );
+		return aI[&x]; // This is a bit sketchy.
+	}
+	constexpr 
+	double operator[] (std::size_t aI) const noexcept
+	{
+		assert( aI < 3 );
+		return aI[&x]; // This is a bit sketchy.
+	}
+};
+
+
+constexpr
+Vec3d operator-( Vec3d aVec ) noexcept
+{
+	return { -aVec.x, -aVec.y, -aVec.z };
+}
+
+constexpr
+Vec3d operator+( Vec3d aLeft, Vec3d aRight ) noexcept
+{
+	return Vec3d{
+		aLeft.x + aRight.x,
+		aLeft.y + aRight.y,
+		aLeft.z + aRight.z
+	};
+}
+constexpr
+Vec3d operator-( Vec3d aLeft, Vec3d aRight ) noexcept
+{
+	return Vec3d{
+		aLeft.x - aRight.x,
+		aLeft.y - aRight.y,
+		aLeft.z - aRight.z
+	};
+}
+
+constexpr
+Vec3d operator*( double aScalar, Vec3d aVec ) noexcept
+{
+	return Vec3d{ 
+		aScalar * aVec.x, 
+		aScalar * aVec.y, 
+		aScalar * aVec.z
+	};
+}
+constexpr
+Vec3d operator*( Vec3d aVec, double aScalar ) noexcept
+{
+	return aScalar * aVec;
+}
+
+constexpr
+Vec3d& operator+=( Vec3d& aLeft, Vec3d aRight ) noexcept
+{
+	aLeft.x += aRight.x;
+	aLeft.y += aRight.y;
+	aLeft.z += aRight.z;
+	return aLeft;
+}
+constexpr
+Vec3d& operator-=( Vec3d& aLeft, Vec3d aRight ) noexcept
+{
+	aLeft.x -= aRight.x;
+	aLeft.y -= aRight.y;
+	aLeft.z -= aRight.z;
+	return aLeft;
+}
+
+
+// Functions:
+
+constexpr
+double dot( Vec3d aLeft, Vec3d aRight ) noexcept
+{
+	return aLeft.x * aRight.x 
+		+ aLeft.y * aRight.y
+		+ aLeft.z * aRight.z
+	;
+}
+
+inline
+double length( Vec3d aVec ) noexcept
+{
+	return std::sqrt( dot( aVec, aVec ) );
+}
+
+
+// Conversions. to_vec3d() is exact; to_vec3f() rounds to the nearest float.
+constexpr
+Vec3d to_vec3d( Vec3f aVec ) noexcept
+{
+	return Vec3d{ double(aVec.x), double(aVec.y), double(aVec.z) };
+}
+constexpr
+Vec3f to_vec3f( Vec3d aVec ) noexcept
+{
+	return Vec3f{ float(aVec.x), float(aVec.y), float(aVec.z) };
+}
+
+#endif // VEC3D_HPP_6F5D4E97_6383_436E_AE2A_4C43CD5CF228
@@ -146,5 +146,29 @@ float length( Vec4f aVec ) noexcept
 }
 
 
+// Fused multiply-add:
+
+// aA * aScalar + aB; see fma() in vec3.hpp
+inline
+Vec4f fma( Vec4f aA, float aScalar, Vec4f aB ) noexcept
+{
+#	if defined(FP_FAST_FMAF)
+	return Vec4f{
+		std::fma( aA.x, aScalar, aB.x ),
+		std::fma( aA.y, aScalar, aB.y ),
+		std::fma( aA.z, aScalar, aB.z ),
+		std::fma( aA.w, aScalar, aB.w )
+	};
+#	else // !FP_FAST_FMAF
+	return Vec4f{
+		aA.x * aScalar + aB.x,
+		aA.y * aScalar + aB.y,
+		aA.z * aScalar + aB.z,
+		aA.w * aScalar + aB.w
+	};
+#	endif // ~ FP_FAST_FMAF
+}
+
+
 #endif // VEC4_HPP_7524F057_7AA7_4C99_AA52_DB0B5A3F8CAA
 